@@ -0,0 +1,205 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef GM_SO_INCLUDE_WORKER_H_
+#define GM_SO_INCLUDE_WORKER_H_
+
+#include <string>
+#include <map>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+#include "include/rvsthreadbase.h"
+#include "include/rvs_sysfs.h"
+#include "include/rvs_stats.h"
+
+
+/**
+ * @class Worker
+ * @ingroup GM
+ *
+ * @brief Monitoring implementation class
+ *
+ * Derives from rvs::ThreadBase and implements actual monitoring functionality
+ * in its run() method.
+ *
+ */
+
+class Worker : public rvs::ThreadBase {
+ public:
+  //! monitored metric and its bound values
+  struct Metric_bound {
+    //! true if metric observed
+    bool mon_metric;
+    //! true if bounds checked
+    bool check_bounds;
+    //! bound max_val
+    uint32_t max_val;
+    //! bound min_val
+    uint32_t min_val;
+  };
+  //! metrics sampled by the worker (columns of the metric table)
+  enum metric_t {
+    GM_METRIC_TEMP = 0,
+    GM_METRIC_CLOCK,
+    GM_METRIC_MEM_CLOCK,
+    GM_METRIC_FAN,
+    GM_METRIC_POWER,
+    GM_NUM_METRICS
+  };
+  //! last sample of a device, written by its sampler and read without locks
+  //! (seqlock: seq is odd while the sampler is writing)
+  struct Metric_snapshot {
+    //! sequence number
+    std::atomic<uint64_t> seq;
+    //! raw metric values (temp in m°C, clocks in MHz, fan 0..255, power in uW)
+    std::atomic<int64_t> value[GM_NUM_METRICS];
+    //! TRUE if the metric could be read
+    std::atomic<bool> valid[GM_NUM_METRICS];
+  };
+  //! streaming statistics of a metric (in the logged units)
+  struct Metric_stats {
+    //! count, mean, standard deviation, min and max
+    rvs::running_stats moments;
+    //! exponentially weighted moving average
+    rvs::ewma smooth;
+    //! quantile sketch
+    rvs::tdigest quantiles;
+    //! time spent above the max bound (ns)
+    uint64_t above_ns;
+  };
+
+ public:
+  Worker();
+  virtual ~Worker();
+
+  void stop(void);
+  //! Sets initiating action name
+  void set_name(const std::string& name) { action_name = name; }
+  //! sets stopping action name
+  void set_stop_name(const std::string& name) { stop_action_name = name; }
+  //! Sets device indices for filtering
+  void set_dv_ind(const std::map<uint32_t, int32_t>& DvInd) {
+    dv_ind = DvInd;
+  }
+  //! Sets JSON flag
+  void json(const bool flag) { bjson = flag; }
+  //! Returns initiating action name
+//  const std::string& get_name(void) { return action_name; }
+  //! sets sample interval
+  void set_sample_int(int interval) { sample_interval = interval; }
+  //! sets log interval
+  void set_log_int(int interval) { log_interval = interval; }
+  //! sets terminate key
+  void set_terminate(bool term_true) { term = term_true; }
+  //! sets force key
+  void set_force(bool flag) { force = flag; }
+  //! reads the metrics from the amdgpu sysfs attributes (kept open) instead
+  //! of through ROCm SMI
+  void set_sysfs(bool flag) { bsysfs = flag; }
+  //! sets true/false for metric
+  void set_metr_mon(std::string metr_name, bool metr_true);
+  //! sets bound values for metric
+  void set_bound(const std::map<std::string, Metric_bound>& Bound) {
+    bounds = Bound;
+  }
+  //! gets irq of device
+  const std::string get_irq(const std::string path);
+  //! gets power of device
+  int get_power(const std::string path);
+  //! prints captured metric values
+  void do_metric_values(void);
+
+ protected:
+  virtual void run(void);
+  void open_sysfs(void);
+  bool use_sysfs(size_t slot, rvs::gpu_sysfs::metric_t metric);
+  bool read_clock(size_t slot, bool mem, uint32_t* mhz);
+  bool read_temp(size_t slot, int64_t* temperature);
+  bool read_fan(size_t slot, int64_t* speed);
+  bool read_power(size_t slot, uint64_t* power);
+  void sample_device(size_t slot);
+  void publish(size_t slot, const int64_t* value, const bool* valid);
+  uint64_t read_snapshot(size_t slot, int64_t* value, bool* valid);
+  void check_bounds(void);
+  bool in_bounds(int metric, int64_t value);
+  std::string format(int metric, double value);
+  double to_unit(int metric, int64_t value);
+  void add_stats(void* r, size_t slot, int metric);
+
+ protected:
+  //! Name of the action which initiated monitoring
+  std::string  action_name;
+  //! Name of the action which stops monitoring
+  std::string  stop_action_name;
+  //! sample interval
+  int sample_interval;
+  //! log interval;
+  int log_interval;
+  //! terminate key
+  bool term;
+  //! force key
+  bool force;
+  //! TRUE if JSON output is required
+  bool bjson;
+  //! TRUE if the metrics are read from sysfs
+  bool bsysfs;
+  //! sysfs attributes of the device in each slot (if bsysfs is set)
+  std::vector<std::unique_ptr<rvs::gpu_sysfs> > sysfs;
+  //! Loops while TRUE
+  std::atomic<bool> brun;
+  //! list of rocm_smi_lib device indices to monitor
+  std::map<uint32_t, int32_t> dv_ind;
+  //! number of checked samples
+  int count;
+  //! dv_ind and metric bounds
+  std::map<std::string, Metric_bound> bounds;
+  //! metric bounds indexed by metric_t
+  Metric_bound met_bound[GM_NUM_METRICS];
+  //! rocm_smi_lib device index of each slot
+  std::vector<uint32_t> slot_dv_ind;
+  //! gpu_id of each slot
+  std::vector<int32_t> slot_gpu_id;
+  //! per metric: last checked value of each slot
+  std::vector<int64_t> met_value[GM_NUM_METRICS];
+  //! per metric: statistics of the checked values of each slot
+  std::vector<Metric_stats> met_stats[GM_NUM_METRICS];
+  //! guards met_stats (updated by the checker, logged periodically)
+  std::mutex stats_mutex;
+  //! time of the last checked sample of each slot (ns)
+  std::vector<uint64_t> last_check_ns;
+  //! per metric: number of bounds violations of each slot
+  std::vector<int> met_violation[GM_NUM_METRICS];
+  //! sequence number of the last snapshot checked in each slot
+  std::vector<uint64_t> last_seq;
+  //! last sample of each slot
+  std::unique_ptr<Metric_snapshot[]> snapshots;
+  //! one sampler thread per slot
+  std::vector<std::thread> samplers;
+};
+
+#endif  // GM_SO_INCLUDE_WORKER_H_
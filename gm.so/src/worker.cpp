@@ -0,0 +1,701 @@
+/*******************************************************************************
+*
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to 
+do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ 
+*******************************************************************************/
+#include "include/worker.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+#include "include/rvs_module.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvs_timer_wheel.h"
+#include "include/rvs_pacer.h"
+#include "include/rsmi_util.h"
+
+#define MODULE_NAME_CAPS                "GM"
+
+#define PCI_ALLOC_ERROR               "pci_alloc() error"
+#define GM_RESULT_FAIL_MESSAGE        "FALSE"
+#define IRQ_PATH_MAX_LENGTH           256
+#define MODULE_NAME                   "gm"
+#define GM_TEMP                       "temp"
+#define GM_CLOCK                      "clock"
+#define GM_MEM_CLOCK                  "mem_clock"
+#define GM_FAN                        "fan"
+#define GM_POWER                      "power"
+//! time constant of the metric EWMA (msec)
+#define GM_EWMA_TAU_MS                10000
+//! compression of the metric quantile sketches
+#define GM_TDIGEST_COMPRESSION        100
+
+
+// collection of allowed metrics
+const char* metric_names[] =
+        { GM_TEMP, GM_CLOCK, GM_MEM_CLOCK, GM_FAN, GM_POWER
+        };
+
+
+Worker::Worker() {
+  force = false;
+  bsysfs = false;
+  brun = false;
+  count = 0;
+}
+Worker::~Worker() {}
+
+/**
+ * @brief opens the sysfs attributes of the monitored devices; the metrics
+ * whose attribute a device does not have are read through ROCm SMI
+ */
+void Worker::open_sysfs(void) {
+  static const char* const metric_names[rvs::gpu_sysfs::SYSFS_NUM_METRICS] =
+    {GM_TEMP, GM_CLOCK, GM_MEM_CLOCK, GM_FAN, GM_POWER};
+
+  sysfs.resize(slot_dv_ind.size());
+  for (size_t slot = 0; slot < slot_dv_ind.size(); slot++) {
+    std::string prefix = "[" + action_name + "] " + MODULE_NAME + " " +
+                         std::to_string(slot_gpu_id[slot]) + " ";
+    uint64_t bdfid;
+    if (rsmi_dev_pci_id_get(slot_dv_ind[slot], &bdfid) ==
+        RSMI_STATUS_SUCCESS) {
+      std::unique_ptr<rvs::gpu_sysfs> dev(
+        new rvs::gpu_sysfs(rvs::gpu_sysfs::pci_device_path(bdfid)));
+      if (dev->open()) {
+        std::string missing;
+        for (int i = 0; i < rvs::gpu_sysfs::SYSFS_NUM_METRICS; i++) {
+          if (!dev->has(static_cast<rvs::gpu_sysfs::metric_t>(i)))
+            missing += std::string(missing.empty() ? "" : ", ") +
+                       metric_names[i];
+        }
+        if (!missing.empty())
+          rvs::lp::Log(prefix + "sysfs " + missing +
+                       " not available, using ROCm SMI", rvs::loginfo);
+        sysfs[slot] = std::move(dev);
+        continue;
+      }
+    }
+    rvs::lp::Log(prefix + "sysfs not available, using ROCm SMI",
+                 rvs::loginfo);
+  }
+}
+
+/**
+ * @brief tells whether a metric of a device is read from sysfs
+ * @param slot device slot
+ * @param metric metric
+ * @return true if the metric's attribute is open, false if the metric is
+ * read through ROCm SMI
+ */
+bool Worker::use_sysfs(size_t slot, rvs::gpu_sysfs::metric_t metric) {
+  return slot < sysfs.size() && sysfs[slot] && sysfs[slot]->has(metric);
+}
+
+/**
+ * @brief reads the current GPU or memory clock of a device
+ * @param slot device slot
+ * @param mem true for the memory clock
+ * @param mhz stores the clock (MHz)
+ * @return true on success, false otherwise
+ */
+bool Worker::read_clock(size_t slot, bool mem, uint32_t* mhz) {
+  rvs::gpu_sysfs::metric_t metric = mem ? rvs::gpu_sysfs::SYSFS_MCLK :
+                                          rvs::gpu_sysfs::SYSFS_SCLK;
+  if (use_sysfs(slot, metric)) {
+    int64_t v;
+    if (!sysfs[slot]->read(metric, &v))
+      return false;
+    *mhz = v;
+    return true;
+  }
+
+  rsmi_frequencies f;
+  if (rsmi_dev_gpu_clk_freq_get(slot_dv_ind[slot],
+                                mem ? RSMI_CLK_TYPE_MEM : RSMI_CLK_TYPE_SYS,
+                                &f) != RSMI_STATUS_SUCCESS ||
+      f.current >= f.num_supported)
+    return false;
+  *mhz = f.frequency[f.current] / 1000000;
+  return true;
+}
+
+/**
+ * @brief reads the temperature of a device
+ * @param slot device slot
+ * @param temperature stores the temperature (millidegrees C)
+ * @return true on success, false otherwise
+ */
+bool Worker::read_temp(size_t slot, int64_t* temperature) {
+  if (use_sysfs(slot, rvs::gpu_sysfs::SYSFS_TEMP))
+    return sysfs[slot]->read(rvs::gpu_sysfs::SYSFS_TEMP, temperature);
+
+  return rsmi_dev_temp_metric_get(slot_dv_ind[slot], 0, RSMI_TEMP_CURRENT,
+                                  temperature) == RSMI_STATUS_SUCCESS;
+}
+
+/**
+ * @brief reads the fan speed of a device
+ * @param slot device slot
+ * @param speed stores the speed (0..255)
+ * @return true on success, false otherwise
+ */
+bool Worker::read_fan(size_t slot, int64_t* speed) {
+  if (use_sysfs(slot, rvs::gpu_sysfs::SYSFS_FAN))
+    return sysfs[slot]->read(rvs::gpu_sysfs::SYSFS_FAN, speed);
+
+  return rsmi_dev_fan_speed_get(slot_dv_ind[slot], 0, speed) ==
+         RSMI_STATUS_SUCCESS;
+}
+
+/**
+ * @brief reads the average power of a device
+ * @param slot device slot
+ * @param power stores the power (uW)
+ * @return true on success, false otherwise
+ */
+bool Worker::read_power(size_t slot, uint64_t* power) {
+  if (use_sysfs(slot, rvs::gpu_sysfs::SYSFS_POWER)) {
+    int64_t v;
+    if (!sysfs[slot]->read(rvs::gpu_sysfs::SYSFS_POWER, &v))
+      return false;
+    *power = v;
+    return true;
+  }
+
+  return rsmi_dev_power_ave_get(slot_dv_ind[slot], 0, power) ==
+         RSMI_STATUS_SUCCESS;
+}
+
+/**
+ * @brief publishes a sample of a device (called by its sampler only)
+ * @param slot device slot
+ * @param value raw metric values
+ * @param valid TRUE for each metric that could be read
+ */
+void Worker::publish(size_t slot, const int64_t* value, const bool* valid) {
+  Metric_snapshot& snap = snapshots[slot];
+  uint64_t seq = snap.seq.load(std::memory_order_relaxed);
+
+  snap.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (int m = 0; m < GM_NUM_METRICS; m++) {
+    snap.value[m].store(value[m], std::memory_order_relaxed);
+    snap.valid[m].store(valid[m], std::memory_order_relaxed);
+  }
+  snap.seq.store(seq + 2, std::memory_order_release);
+}
+
+/**
+ * @brief copies the last sample of a device without blocking its sampler
+ * @param slot device slot
+ * @param value stores the raw metric values
+ * @param valid stores TRUE for each metric that could be read
+ * @return sequence number of the sample (0 if nothing was published yet)
+ */
+uint64_t Worker::read_snapshot(size_t slot, int64_t* value, bool* valid) {
+  Metric_snapshot& snap = snapshots[slot];
+
+  for (;;) {
+    uint64_t seq = snap.seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (int m = 0; m < GM_NUM_METRICS; m++) {
+      value[m] = snap.value[m].load(std::memory_order_relaxed);
+      valid[m] = snap.valid[m].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (snap.seq.load(std::memory_order_relaxed) == seq)
+      return seq;
+  }
+}
+
+/**
+ * @brief checks a raw metric value against the configured bounds
+ * @param metric metric_t
+ * @param value raw value
+ * @return true if in bounds (or bounds are not checked)
+ */
+bool Worker::in_bounds(int metric, int64_t value) {
+  const Metric_bound& b = met_bound[metric];
+
+  if (!b.check_bounds)
+    return true;
+
+  switch (metric) {
+  case GM_METRIC_TEMP:
+    // bounds are given in degrees C
+    value /= 1000;
+    break;
+  case GM_METRIC_POWER:
+    // bounds are given in Watts
+    return value >= b.min_val * 1000000ll && value <= b.max_val * 1000000ll;
+  default:
+    break;
+  }
+  return value >= b.min_val && value <= b.max_val;
+}
+
+/**
+ * @brief formats a metric value with its unit
+ * @param metric metric_t
+ * @param value value in the logged unit (see to_unit())
+ * @return value as logged
+ */
+std::string Worker::format(int metric, double value) {
+  switch (metric) {
+  case GM_METRIC_TEMP:
+    return std::to_string(static_cast<int64_t>(value)) + "C";
+  case GM_METRIC_FAN:
+    return std::to_string(static_cast<int64_t>(value)) + "%";
+  case GM_METRIC_POWER:
+    return std::to_string(static_cast<float>(value)) + "Watts";
+  default:
+    return std::to_string(static_cast<int64_t>(value)) + "Mhz";
+  }
+}
+
+/**
+ * @brief converts a raw metric value to the logged unit
+ * @param metric metric_t
+ * @param value raw value
+ * @return value in C, Mhz, fan units or Watts
+ */
+double Worker::to_unit(int metric, int64_t value) {
+  switch (metric) {
+  case GM_METRIC_TEMP:
+    return value / 1e3;
+  case GM_METRIC_POWER:
+    return value / 1e6;
+  default:
+    return value;
+  }
+}
+
+/**
+ * @brief adds the statistics of a metric to a JSON record (the caller holds
+ * stats_mutex)
+ * @param r JSON record
+ * @param slot device slot
+ * @param metric metric_t
+ */
+void Worker::add_stats(void* r, size_t slot, int metric) {
+  Metric_stats& st = met_stats[metric][slot];
+  void* n = rvs::lp::CreateNode(r, "stats");
+
+  rvs::lp::AddInt(n, "gpu_id", slot_gpu_id[slot]);
+  rvs::lp::AddString(n, "metric", metric_names[metric]);
+  rvs::lp::AddInt(n, "samples", st.moments.count());
+  rvs::lp::AddDouble(n, "min", st.moments.min());
+  rvs::lp::AddDouble(n, "max", st.moments.max());
+  rvs::lp::AddDouble(n, "mean", st.moments.mean());
+  rvs::lp::AddDouble(n, "stddev", st.moments.stddev());
+  rvs::lp::AddDouble(n, "ewma", st.smooth.value());
+  rvs::lp::AddDouble(n, "p50", st.quantiles.quantile(0.5));
+  rvs::lp::AddDouble(n, "p90", st.quantiles.quantile(0.9));
+  rvs::lp::AddDouble(n, "p99", st.quantiles.quantile(0.99));
+  if (met_bound[metric].check_bounds)
+    rvs::lp::AddDouble(n, "time_above_max", st.above_ns / 1e9);
+  rvs::lp::AddNode(r, n);
+}
+
+/**
+ * @brief Prints current metric values at every log_interval msec.
+ */
+void Worker::do_metric_values() {
+  std::string msg;
+  unsigned int sec;
+  unsigned int usec;
+  void* r;
+  int64_t value[GM_NUM_METRICS];
+  bool valid[GM_NUM_METRICS];
+
+  // get timestamp
+  rvs::lp::get_ticks(&sec, &usec);
+  // add JSON output
+  r = rvs::lp::LogRecordCreate("gm", action_name.c_str(), rvs::loginfo,
+                               sec, usec);
+
+  for (size_t slot = 0; slot < slot_dv_ind.size(); slot++) {
+    read_snapshot(slot, value, valid);
+    for (int m = 0; m < GM_NUM_METRICS; m++) {
+      if (!met_bound[m].mon_metric)
+        continue;
+      msg = "[" + action_name + "] gm " +
+          std::to_string(slot_gpu_id[slot]) + " " + metric_names[m] + " " +
+          (valid[m] ? format(m, to_unit(m, value[m])) :
+                      std::string("Not available"));
+      rvs::lp::Log(msg, rvs::loginfo, sec, usec);
+      rvs::lp::AddString(r,  "info ", msg);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    for (size_t slot = 0; slot < slot_dv_ind.size(); slot++) {
+      for (int m = 0; m < GM_NUM_METRICS; m++) {
+        if (met_bound[m].mon_metric)
+          add_stats(r, slot, m);
+      }
+    }
+  }
+  rvs::lp::LogRecordFlush(r);
+}
+
+/**
+ * @brief Sampler thread function
+ *
+ * Reads the monitored metrics of one device every sample_interval msec and
+ * publishes them into the device snapshot.
+ *
+ * @param slot device slot
+ * */
+void Worker::sample_device(size_t slot) {
+  rvs::pacer pace;
+  int64_t value[GM_NUM_METRICS];
+  bool valid[GM_NUM_METRICS];
+
+  while (brun) {
+    for (int m = 0; m < GM_NUM_METRICS; m++) {
+      value[m] = 0;
+      valid[m] = false;
+    }
+    if (met_bound[GM_METRIC_MEM_CLOCK].mon_metric) {
+      uint32_t mhz = 0;
+      valid[GM_METRIC_MEM_CLOCK] = read_clock(slot, true, &mhz);
+      value[GM_METRIC_MEM_CLOCK] = mhz;
+    }
+    if (met_bound[GM_METRIC_CLOCK].mon_metric) {
+      uint32_t mhz = 0;
+      valid[GM_METRIC_CLOCK] = read_clock(slot, false, &mhz);
+      value[GM_METRIC_CLOCK] = mhz;
+    }
+    if (met_bound[GM_METRIC_TEMP].mon_metric) {
+      valid[GM_METRIC_TEMP] = read_temp(slot, &value[GM_METRIC_TEMP]);
+    }
+    if (met_bound[GM_METRIC_FAN].mon_metric) {
+      valid[GM_METRIC_FAN] = read_fan(slot, &value[GM_METRIC_FAN]);
+    }
+    if (met_bound[GM_METRIC_POWER].mon_metric) {
+      uint64_t power = 0;
+      valid[GM_METRIC_POWER] = read_power(slot, &power);
+      value[GM_METRIC_POWER] = power;
+    }
+#ifdef UT_TCD_1
+    valid[GM_METRIC_TEMP] = false;
+    valid[GM_METRIC_FAN] = false;
+#endif  // UT_TCD_1
+
+    publish(slot, value, valid);
+    pace.wait_next(sample_interval);
+  }
+}
+
+/**
+ * @brief checks the samples published since the last call against bounds
+ */
+void Worker::check_bounds() {
+  std::string msg;
+  int64_t value[GM_NUM_METRICS];
+  bool valid[GM_NUM_METRICS];
+
+  for (size_t slot = 0; slot < slot_dv_ind.size(); slot++) {
+    uint64_t seq = read_snapshot(slot, value, valid);
+    if (seq == last_seq[slot])
+      continue;
+    last_seq[slot] = seq;
+
+    // the previous sample held until this one
+    uint64_t now = rvs::pacer::now_ns();
+    uint64_t dt = last_check_ns[slot] ? now - last_check_ns[slot] : 0;
+    last_check_ns[slot] = now;
+
+    for (int m = 0; m < GM_NUM_METRICS; m++) {
+      if (!met_bound[m].mon_metric)
+        continue;
+      if (!valid[m]) {
+        msg = "[" + action_name  + "] " + MODULE_NAME + " " +
+              std::to_string(slot_gpu_id[slot]) + " " +
+              metric_names[m] + " Not available";
+        rvs::lp::Log(msg, rvs::loginfo);
+        continue;
+      }
+      met_value[m][slot] = value[m];
+      bool ok = in_bounds(m, value[m]);
+      {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        Metric_stats& st = met_stats[m][slot];
+        double v = to_unit(m, value[m]);
+        st.moments.add(v);
+        st.smooth.add(v);
+        st.quantiles.add(v);
+        if (!ok && v > met_bound[m].max_val)
+          st.above_ns += dt;
+      }
+      rvs::lp::Sample(MODULE_NAME, slot_gpu_id[slot], metric_names[m], now,
+                      to_unit(m, value[m]));
+      if (ok)
+        continue;
+
+      RVSTRACE_
+      // write info and increase number of violations
+      msg = "[" + action_name  + "] " + MODULE_NAME + " " +
+            std::to_string(slot_gpu_id[slot]) + " " +
+            metric_names[m] + " " + "bounds violation " +
+            format(m, to_unit(m, value[m]));
+      rvs::lp::Log(msg, rvs::loginfo);
+      met_violation[m][slot]++;
+      if (term) {
+        RVSTRACE_
+        if (force) {
+          RVSTRACE_
+          // stop logging
+          rvs::lp::Stop(1);
+          // force exit
+          exit(EXIT_FAILURE);
+        } else {
+          RVSTRACE_
+          // just signal stop processing
+          rvs::lp::Stop(0);
+        }
+        brun = false;
+      }
+    }
+  }
+  count++;
+}
+
+/**
+ * @brief Thread function
+ *
+ * Starts one sampler thread per device and, while brun == TRUE, checks the
+ * published samples against bounds every sample_interval msec.
+ *
+ * */
+void Worker::run() {
+  brun = true;
+
+  std::string msg;
+  unsigned int sec;
+  unsigned int usec;
+  void* r;
+
+  uint64_t timer_running = 0;
+
+  // build the metric table: one slot per device, one column per metric
+  for (int m = 0; m < GM_NUM_METRICS; m++) {
+    met_bound[m] = bounds[metric_names[m]];
+  }
+  slot_dv_ind.clear();
+  slot_gpu_id.clear();
+  for (auto it = dv_ind.begin(); it != dv_ind.end(); it++) {
+    slot_dv_ind.push_back(it->first);
+    slot_gpu_id.push_back(it->second);
+  }
+  size_t slots = slot_dv_ind.size();
+  for (int m = 0; m < GM_NUM_METRICS; m++) {
+    met_value[m].assign(slots, 0);
+    met_violation[m].assign(slots, 0);
+    met_stats[m].assign(slots, Metric_stats());
+    for (size_t slot = 0; slot < slots; slot++) {
+      Metric_stats& st = met_stats[m][slot];
+      st.smooth.set_alpha(1 - exp(-static_cast<double>(sample_interval) /
+                                  GM_EWMA_TAU_MS));
+      st.quantiles = rvs::tdigest(GM_TDIGEST_COMPRESSION);
+      st.above_ns = 0;
+    }
+  }
+  last_seq.assign(slots, 0);
+  last_check_ns.assign(slots, 0);
+  snapshots.reset(new Metric_snapshot[slots]);
+  for (size_t slot = 0; slot < slots; slot++) {
+    snapshots[slot].seq = 0;
+    for (int m = 0; m < GM_NUM_METRICS; m++) {
+      snapshots[slot].value[m] = 0;
+      snapshots[slot].valid[m] = false;
+    }
+  }
+  count = 0;
+
+  if (bsysfs)
+    open_sysfs();
+
+  // get timestamp
+  rvs::lp::get_ticks(&sec, &usec);
+
+  // add JSON output
+  r = rvs::lp::LogRecordCreate("gm", action_name.c_str(), rvs::loginfo,
+                               sec, usec);
+
+  // iterate over devices
+  for (size_t slot = 0; slot < slots; slot++) {
+    RVSTRACE_
+    msg = "[" + action_name + "] gm " + std::to_string(slot_gpu_id[slot]) +
+          " started";
+    rvs::lp::Log(msg, rvs::logresults, sec, usec);
+    rvs::lp::AddString(r, "device", std::to_string(slot_gpu_id[slot]));
+    for (auto itb = bounds.begin(); itb != bounds.end(); itb++) {
+      RVSTRACE_
+
+      if (itb->second.mon_metric) {
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(slot_gpu_id[slot]) + " " + "monitoring " +
+            itb->first;
+        if (itb->second.check_bounds) {
+          msg+= " bounds min: " + std::to_string(itb->second.min_val) +
+          "  max: " + std::to_string(itb->second.max_val);
+        }
+        rvs::lp::Log(msg, rvs::loginfo);
+        rvs::lp::AddString(r, itb->first, msg);
+      }
+    }
+  }
+
+  rvs::lp::LogRecordFlush(r);
+
+  // each device is read by its own sampler so that a slow device does not
+  // delay the others
+  for (size_t slot = 0; slot < slots; slot++) {
+    samplers.push_back(std::thread(&Worker::sample_device, this, slot));
+  }
+
+  // if log_interval is set, the metrics are logged from the timer wheel
+  // shared by the gm actions (rather than from a timer thread each)
+  if (log_interval) {
+    timer_running = rvs::timer_wheel::shared().add(log_interval * 1000000ull,
+                                  std::bind(&Worker::do_metric_values, this));
+  }
+
+  // worker thread has started
+  rvs::pacer pace;
+  while (brun) {
+    RVSTRACE_
+    pace.wait_next(sample_interval);
+    check_bounds();
+  }
+
+  RVSTRACE_
+  if (timer_running)
+    rvs::timer_wheel::shared().cancel(timer_running);
+  for (size_t slot = 0; slot < samplers.size(); slot++) {
+    samplers[slot].join();
+  }
+  samplers.clear();
+
+  // get timestamp
+  rvs::lp::get_ticks(&sec, &usec);
+
+  for (size_t slot = 0; slot < slots; slot++) {
+    RVSTRACE_
+    // add std::string output
+    msg = "[" + action_name + "] gm " +
+        std::to_string(slot_gpu_id[slot]) + " stopped";
+    rvs::lp::Log(msg, rvs::logresults, sec, usec);
+  }
+
+  RVSTRACE_
+}
+
+
+/**
+ * @brief Stops monitoring
+ *
+ * Sets brun member to FALSE thus signaling end of monitoring.
+ * Then it waits for std::thread (and the samplers) to exit before printing
+ * the results.
+ *
+ * */
+void Worker::stop() {
+  RVSTRACE_
+  rvs::lp::Log("[" + stop_action_name + "] gm in Worker::stop()",
+               rvs::logtrace);
+  std::string msg;
+  unsigned int sec;
+  unsigned int usec;
+  void* r;
+
+  // reset "run" flag
+  brun = false;
+
+  // wait for the thread to exit so that the metric table is final
+  try {
+    if (t.joinable())
+      t.join();
+    }
+  catch(...) {
+  }
+
+  // get timestamp
+  rvs::lp::get_ticks(&sec, &usec);
+    // add JSON output
+  r = rvs::lp::LogRecordCreate("result", action_name.c_str(), rvs::logresults,
+                               sec, usec);
+
+  if (count != 0) {
+    RVSTRACE_
+    for (size_t slot = 0; slot < slot_dv_ind.size(); slot++) {
+      RVSTRACE_
+      for (int m = 0; m < GM_NUM_METRICS; m++) {
+        if (!met_bound[m].mon_metric)
+          continue;
+        msg = "[" + action_name + "] gm " +
+            std::to_string(slot_gpu_id[slot]) + " " +
+            metric_names[m] + " violations " +
+            std::to_string(met_violation[m][slot]);
+        rvs::lp::Log(msg, rvs::logresults, sec, usec);
+        rvs::lp::AddString(r, "result", msg);
+        Metric_stats& st = met_stats[m][slot];
+        msg = "[" + action_name + "] gm " +
+            std::to_string(slot_gpu_id[slot]) + " " +
+            metric_names[m] + " average " + format(m, st.moments.mean());
+        rvs::lp::Log(msg, rvs::logresults, sec, usec);
+        rvs::lp::AddString(r, "result", msg);
+        msg = "[" + action_name + "] gm " +
+            std::to_string(slot_gpu_id[slot]) + " " + metric_names[m] +
+            " min " + format(m, st.moments.min()) +
+            " max " + format(m, st.moments.max()) +
+            " p99 " + format(m, st.quantiles.quantile(0.99)) +
+            " stddev " + std::to_string(st.moments.stddev());
+        rvs::lp::Log(msg, rvs::logresults, sec, usec);
+        rvs::lp::AddString(r, "result", msg);
+        add_stats(r, slot, m);
+      }
+      RVSTRACE_
+    }
+    RVSTRACE_
+  }
+  RVSTRACE_
+  rvs::lp::LogRecordFlush(r);
+}
@@ -0,0 +1,344 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef GST_SO_INCLUDE_GST_WORKER_H_
+#define GST_SO_INCLUDE_GST_WORKER_H_
+
+#include <string>
+#include <memory>
+#include <vector>
+#include "include/rvsthreadbase.h"
+#include "include/rvs_blas.h"
+#include "include/rvs_pacer.h"
+#include "include/rvs_autotune.h"
+#include "include/rvs_clock.h"
+#include "include/rvs_histogram.h"
+#include "include/rvs_sim.h"
+
+#define GST_RESULT_PASS_MESSAGE         "true"
+#define GST_RESULT_FAIL_MESSAGE         "false"
+
+/**
+ * @class GSTWorker
+ * @ingroup GST
+ *
+ * @brief GSTWorker action implementation class
+ *
+ * Derives from rvs::ThreadBase and implements actual action functionality
+ * in its run() method.
+ *
+ */
+class GSTWorker : public rvs::ThreadBase {
+ public:
+    GSTWorker();
+    virtual ~GSTWorker();
+
+    //! sets action name
+    void set_name(const std::string& name) { action_name = name; }
+    //! returns action name
+    const std::string& get_name(void) { return action_name; }
+
+    //! sets GPU ID
+    void set_gpu_id(uint16_t _gpu_id) { gpu_id = _gpu_id; }
+    //! returns GPU ID
+    uint16_t get_gpu_id(void) { return gpu_id; }
+
+    //! sets the GPU index
+    void set_gpu_device_index(int _gpu_device_index) {
+        gpu_device_index = _gpu_device_index;
+    }
+    //! returns the GPU index
+    int get_gpu_device_index(void) { return gpu_device_index; }
+
+    //! sets the run delay
+    void set_run_wait_ms(uint64_t _run_wait_ms) { run_wait_ms = _run_wait_ms; }
+    //! returns the run delay
+    uint64_t get_run_wait_ms(void) { return run_wait_ms; }
+
+    //! sets the total stress test run duration
+    void set_run_duration_ms(uint64_t _run_duration_ms) {
+        run_duration_ms = _run_duration_ms;
+    }
+    //! returns the total stress test run duration
+    uint64_t get_run_duration_ms(void) { return run_duration_ms; }
+
+    //! sets the stress test ramp duration
+    void set_ramp_interval(uint64_t _ramp_interval) {
+        ramp_interval = _ramp_interval;
+    }
+    //! returns the stress test ramp duration
+    uint64_t get_ramp_interval(void) { return ramp_interval; }
+
+    //! sets the time interval at which the module reports the average GFlops
+    void set_log_interval(uint64_t _log_interval) {
+        log_interval = _log_interval;
+    }
+    //! returns the time interval at which the module reports the average GFlops
+    uint64_t get_log_interval(void) { return log_interval; }
+
+    //! sets the maximum allowed number of target_stress violations
+    void set_max_violations(uint64_t _max_violations) {
+        max_violations = _max_violations;
+    }
+    //! returns the maximum allowed number of target_stress violations
+    uint64_t get_max_violations(void) { return max_violations; }
+
+    //! sets the copy_matrix (true = the matrix will be copied to GPU each
+    //! time a new SGEMM will run, false = the matrix will be copied only once)
+    void set_copy_matrix(bool _copy_matrix) { copy_matrix = _copy_matrix; }
+    //! returns the copy_matrix value
+    bool get_copy_matrix(void) { return copy_matrix; }
+
+    //! sets the target stress (in GFlops) that the GPU will try to achieve
+    void set_target_stress(float _target_stress) {
+        target_stress = _target_stress;
+    }
+    //! returns the target stress (in GFlops) that the GPU will try to achieve
+    float get_target_stress(void) { return target_stress; }
+
+    //! sets the SGEMM matrix size
+    void set_matrix_size_a(uint64_t _matrix_size_a) {
+        matrix_size_a = _matrix_size_a;
+    }
+   //! sets the SGEMM matrix size
+    void set_matrix_size_b(uint64_t _matrix_size_b) {
+        matrix_size_b = _matrix_size_b;
+    }
+   //! sets the SGEMM matrix size
+    void set_matrix_size_c(uint64_t _matrix_size_c) {
+        matrix_size_c = _matrix_size_c;
+    }
+
+    //! returns the SGEMM matrix size
+    uint64_t get_matrix_size_a(void) { return matrix_size_a; }
+
+    //! returns the SGEMM matrix size
+    uint64_t get_matrix_size_b(void) { return matrix_size_b; }
+
+    //! returns the SGEMM matrix size
+    uint64_t get_matrix_size_c(void) { return matrix_size_b; }
+
+    //! sets the GFlops tolerance
+    void set_tolerance(float _tolerance) { tolerance = _tolerance; }
+    //! returns the GFlops tolerance
+    float get_tolerance(void) { return tolerance; }
+
+    //! returns the difference (in milliseconds) between 2 points in time
+    uint64_t time_diff(uint64_t t_end, uint64_t t_start);
+
+    //! sets the JSON flag
+    static void set_use_json(bool _bjson) { bjson = _bjson; }
+    //! returns the JSON flag
+    static bool get_use_json(void) { return bjson; }
+
+    void set_gst_ops_type(std::string _ops_type) { gst_ops_type = _ops_type; }
+
+    //! sets the way the worker waits for GEMM completion
+    void set_gemm_wait(rvs_blas::gemm_wait_t _gemm_wait) {
+        gemm_wait = _gemm_wait;
+    }
+    //! returns the way the worker waits for GEMM completion
+    rvs_blas::gemm_wait_t get_gemm_wait(void) { return gemm_wait; }
+
+    //! sets the seed of the random matrix data
+    void set_seed(uint64_t _seed) { seed = _seed; }
+    //! returns the seed of the random matrix data
+    uint64_t get_seed(void) { return seed; }
+
+    //! sets the number of GEMMs per launch (> 1 = strided-batched GEMM)
+    void set_batch_count(int _batch_count) { batch_count = _batch_count; }
+    //! sets the number of streams the GEMM launches are spread over
+    void set_gemm_streams(int _gemm_streams) { gemm_streams = _gemm_streams; }
+    //! sets the number of GEMM launches kept in flight (> 1 selects the
+    //! pipelined submission)
+    void set_gemm_inflight(int _gemm_inflight) {
+        gemm_inflight = _gemm_inflight;
+    }
+
+    //! sets the number of GEMMs between two result verifications
+    //! (0 = disabled)
+    void set_verify_interval(uint64_t _verify_interval) {
+        verify_interval = _verify_interval;
+    }
+    //! sets the number of C tiles checked by each result verification
+    void set_verify_tiles(int _verify_tiles) { verify_tiles = _verify_tiles; }
+
+    //! sets autotune (true = the matrix sizes come from the autotune cache
+    //! or from a sweep of GEMM shapes)
+    void set_autotune(bool _autotune) { autotune = _autotune; }
+    //! sets the autotune cache file path
+    void set_autotune_cache(const std::string& _autotune_cache) {
+        autotune_cache = _autotune_cache;
+    }
+
+    //! sets the multiple of the median GEMM time above which a GEMM is
+    //! reported as a stall
+    void set_stall_factor(float _stall_factor) {
+        stall_factor = _stall_factor;
+    }
+    //! sets the max allowed (p99 - p50) / p50 of the GEMM times
+    //! (0 = not checked)
+    void set_max_jitter(float _max_jitter) { max_jitter = _max_jitter; }
+
+    void set_sim_backend(const rvs::sim_model& model);
+    //! returns TRUE if the GEMMs run on the simulated device
+    bool is_sim_backend(void) { return use_sim; }
+
+ protected:
+    void setup_blas(int *error, std::string *err_description);
+    bool upload_next_matrices(int *error, std::string *err_description);
+    void hit_max_gflops(int *error, std::string *err_description);
+    void hit_max_gflops_pipelined(int *error, std::string *err_description);
+    bool fill_gemm_pipeline(int *error, std::string *err_description);
+    bool do_gst_ramp(int *error, std::string *err_description);
+    bool do_gst_stress_test(int *error, std::string *err_description);
+    bool do_gst_stress_test_pipelined(int *error,
+                                      std::string *err_description);
+    void log_gst_test_result(bool gst_test_passed);
+    virtual void run(void);
+    void log_to_json(const std::string &key, const std::string &value,
+                     int log_level);
+    void log_interval_gflops(double gflops_interval);
+    bool check_gflops_violation(double gflops_interval);
+    void init_gemm_control(void);
+    void wait_gemm_slot(void);
+    bool update_gemm_control(double gemm_ms, double *window_gflops);
+    bool verify_gemm_results(bool final_check, int *error,
+                             std::string *err_description);
+    void log_verify_mismatches(
+                        const std::vector<rvs_gemm_mismatch>& mismatches);
+    bool autotune_matrix_size(int *error, std::string *err_description);
+    double measure_gemm_shape(const rvs::gemm_shape& shape);
+    rvs_blas* create_blas(int m, int n, int k, int num_inflight);
+    void record_gemm_time(double gemm_ms);
+    void log_gemm_stall(double gemm_ms);
+    double gemm_jitter(void);
+
+ protected:
+    //! name of the action
+    std::string action_name;
+    //! index of the GPU that will run the stress test
+    int gpu_device_index;
+    //! ID of the GPU that will run the stress test
+    uint16_t gpu_id;
+    //! stress test run delay
+    uint64_t run_wait_ms;
+    //! stress test run duration
+    uint64_t run_duration_ms;
+    //! stress test ramp duration
+    uint64_t ramp_interval;
+    //! time interval at which the module reports the average GFlops
+    uint64_t log_interval;
+    //! maximum allowed number of target_stress violations
+    uint64_t max_violations;
+    //! specifies whether to copy the matrix to the GPU for each SGEMM operation
+    bool copy_matrix;
+    //! target stress (in GFlops) that the GPU will try to achieve
+    float target_stress;
+    //! GFlops tolerance (how much the GFlops can fluctuare after
+    //! the ramp period for the test to succeed)
+    float tolerance;
+    //! SGEMM matrix size
+    uint64_t matrix_size_a;
+    uint64_t matrix_size_b;
+    uint64_t matrix_size_c;
+    //! actual ramp time in case the GPU achieves the given target_stress Gflops
+    uint64_t ramp_actual_time;
+    //! rvs_blas pointer
+    std::unique_ptr<rvs_blas> gpu_blas;
+    //! max gflops achieved during the stress test
+    double max_gflops;
+    //! peak Gflops measured by hit_max_gflops()
+    double peak_gflops;
+    //! GEMM rate controller (relative Gflops error -> duty cycle correction)
+    rvs::pid gemm_ctrl;
+    //! GEMM launch deadlines
+    rvs::pacer gemm_pacer;
+    //! feed-forward duty cycle (target_stress / peak_gflops)
+    double ff_duty;
+    //! current duty cycle (GEMM time / launch period)
+    double gemm_duty;
+    //! average GPU time (ms) of one GEMM launch
+    double avg_gemm_ms;
+    //! start (clk, ns) of the current control window
+    uint64_t ctrl_window_start_ns;
+    //! GEMMs completed in the current control window
+    uint64_t ctrl_window_gemms;
+    //! TRUE if the ramp settled around target_stress
+    bool ramp_settled;
+    //! time (ms) the controller needed to settle
+    uint64_t ramp_settle_ms;
+    //! highest control window Gflops during the ramp, relative to
+    //! target_stress (0 = no overshoot)
+    double ramp_overshoot;
+    //! TRUE if JSON output is required
+    static bool bjson;
+    //Type of operation
+    std::string gst_ops_type;
+    //! the way the worker waits for GEMM completion
+    rvs_blas::gemm_wait_t gemm_wait;
+    //! seed of the random matrix data
+    uint64_t seed;
+    //! number of GEMMs per launch
+    int batch_count;
+    //! number of streams the GEMM launches are spread over
+    int gemm_streams;
+    //! number of GEMM launches kept in flight
+    int gemm_inflight;
+    //! number of GEMMs between two result verifications (0 = disabled)
+    uint64_t verify_interval;
+    //! number of C tiles checked by each result verification
+    int verify_tiles;
+    //! GEMMs completed since the last result verification was started
+    uint64_t num_gemms_since_verify;
+    //! number of C elements which failed the result verification
+    uint64_t num_verify_mismatches;
+    //! TRUE if the matrix sizes are autotuned
+    bool autotune;
+    //! autotune cache file path
+    std::string autotune_cache;
+    //! TRUE if the GEMMs run on the simulated device
+    bool use_sim;
+    //! virtual time of the simulated backend
+    std::unique_ptr<rvs::virtual_clock> sim_clock;
+    //! simulated device
+    std::unique_ptr<rvs::sim_device> sim_dev;
+    //! time source of all the worker timing (real time unless simulated)
+    rvs::clock* clk;
+    //! distribution of the stress test GEMM times (ns)
+    rvs::histogram gemm_hist;
+    //! multiple of the median GEMM time above which a GEMM is a stall
+    float stall_factor;
+    //! max allowed (p99 - p50) / p50 of the GEMM times (0 = not checked)
+    float max_jitter;
+    //! number of stalls during the stress test
+    uint64_t num_stalls;
+    //! median GEMM time (ms) the stalls are detected against
+    double stall_ref_ms;
+    //! previous completion time (ms) of the pipelined submission (< 0 =
+    //! none yet)
+    double prev_completion_ms;
+};
+
+#endif  // GST_SO_INCLUDE_GST_WORKER_H_
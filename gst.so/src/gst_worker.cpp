@@ -0,0 +1,1277 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/gst_worker.h"
+
+#include <unistd.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <vector>
+
+#include "include/rvs_blas.h"
+#include "include/rvs_module.h"
+#include "include/rvsloglp.h"
+
+#define MODULE_NAME                             "gst"
+
+#define GST_MEM_ALLOC_ERROR                     "memory allocation error!"
+#define GST_BLAS_ERROR                          "memory/blas error!"
+#define GST_BLAS_MEMCPY_ERROR                   "HostToDevice mem copy error!"
+#define GST_AUTOTUNE_ERROR                      "no GEMM shape could be run!"
+
+#define GST_MAX_GFLOPS_OUTPUT_KEY               "Gflop"
+#define GST_MAX_TFLOPS_OUTPUT_KEY               "Tflops"
+#define GST_FLOPS_PER_OP_OUTPUT_KEY             "flops_per_op"
+#define GST_MAX_GOPS_OUTPUT_KEY                 "Gop"
+#define GST_MAX_TOPS_OUTPUT_KEY                 "Tops"
+#define GST_OPS_PER_OP_OUTPUT_KEY               "ops_per_op"
+#define GST_BYTES_COPIED_PER_OP_OUTPUT_KEY      "bytes_copied_per_op"
+#define GST_TRY_OPS_PER_SEC_OUTPUT_KEY          "try_ops_per_sec"
+
+#define GST_LOG_GFLOPS_INTERVAL_KEY             "Gflops"
+#define GST_LOG_GOPS_INTERVAL_KEY               "Gops"
+#define GST_JSON_LOG_GPU_ID_KEY                 "gpu_id"
+
+#define NMAX_MS_GPU_RUN_PEAK_PERFORMANCE        1000
+
+//! GEMM rate controller: the launch period is gemm_time / duty, where
+//! duty = feed-forward duty (target / peak) * (1 + PI output) and the PI
+//! input is the relative Gflops error measured over each control window
+#define GST_CTRL_KP                             0.5
+#define GST_CTRL_KI                             2.0
+#define GST_CTRL_MIN_DUTY                       0.01
+//! length (ms) and minimum number of GEMMs of a control window
+#define GST_CTRL_WINDOW_MS                      100
+#define GST_CTRL_WINDOW_MIN_GEMMS               4
+//! weight of the last GEMM in the GEMM time average
+#define GST_CTRL_GEMM_MS_WEIGHT                 0.1
+//! consecutive in-band control windows needed to end the ramp
+#define GST_CTRL_SETTLE_WINDOWS                 3
+
+//! time (ms) each GEMM shape runs during the autotune sweep
+#define GST_AUTOTUNE_TRIAL_MS                   250
+
+//! GEMMs timed before the stall detection starts
+#define GST_STALL_MIN_GEMMS                     32
+//! number of GEMMs between two updates of the stall reference (the median)
+#define GST_STALL_REF_GEMMS                     32
+
+#define GST_COPY_MATRIX_MSG                     "copy matrix"
+#define GST_SEED_MSG                            "seed"
+#define GST_START_MSG                           "start"
+#define GST_PASS_KEY                            "pass"
+#define GST_RAMP_EXCEEDED_MSG                   "ramp time exceeded"
+#define GST_TARGET_ACHIEVED_MSG                 "target achieved"
+#define GST_STRESS_VIOLATION_MSG                "stress violation"
+#define GST_VERIFY_MISMATCH_MSG                 "verify mismatch"
+#define GST_VERIFY_CHECKS_KEY                   "verify_checks"
+#define GST_VERIFY_MISMATCHES_KEY               "verify_mismatches"
+#define GST_RAMP_SETTLE_MS_KEY                  "ramp_settle_ms"
+#define GST_RAMP_OVERSHOOT_KEY                  "ramp_overshoot"
+#define GST_AUTOTUNE_MSG                        "autotune"
+#define GST_AUTOTUNE_TRIAL_MSG                  "autotune trial"
+#define GST_GEMM_STALL_MSG                      "gemm stall"
+#define GST_GEMM_P50_MS_KEY                     "gemm_p50_ms"
+#define GST_GEMM_P99_MS_KEY                     "gemm_p99_ms"
+#define GST_GEMM_MAX_MS_KEY                     "gemm_max_ms"
+#define GST_GEMM_STALLS_KEY                     "gemm_stalls"
+#define GST_GEMM_JITTER_KEY                     "gemm_jitter"
+
+//! max number of mismatching elements logged per result verification
+#define GST_VERIFY_MAX_LOGGED                   10
+
+using std::string;
+
+bool GSTWorker::bjson = false;
+
+GSTWorker::GSTWorker() : gemm_ctrl(GST_CTRL_KP, GST_CTRL_KI, 0, 0, 0) {
+    gemm_wait = rvs_blas::GEMM_WAIT_BLOCKING_SYNC;
+    seed = 0;
+    batch_count = 1;
+    gemm_streams = 1;
+    gemm_inflight = 1;
+    verify_interval = 0;
+    verify_tiles = 4;
+    num_gemms_since_verify = 0;
+    num_verify_mismatches = 0;
+    peak_gflops = 0;
+    ff_duty = gemm_duty = 1;
+    avg_gemm_ms = 0;
+    ctrl_window_start_ns = 0;
+    ctrl_window_gemms = 0;
+    ramp_actual_time = 0;
+    ramp_settled = false;
+    ramp_settle_ms = 0;
+    ramp_overshoot = 0;
+    autotune = false;
+    use_sim = false;
+    clk = rvs::clock::real();
+    stall_factor = 3;
+    max_jitter = 0;
+    num_stalls = 0;
+    stall_ref_ms = 0;
+    prev_completion_ms = -1;
+}
+GSTWorker::~GSTWorker() {}
+
+/**
+ * @brief selects the simulated backend: the GEMMs run on a rvs::sim_device
+ * and all the worker timing comes from a virtual clock, so a test of
+ * several minutes completes in a fraction of a second
+ * @param model performance/power model of the simulated device
+ */
+void GSTWorker::set_sim_backend(const rvs::sim_model& model) {
+    use_sim = true;
+    sim_clock.reset(new rvs::virtual_clock());
+    sim_dev.reset(new rvs::sim_device(model, sim_clock.get()));
+    clk = sim_clock.get();
+    gemm_pacer.set_clock(clk);
+}
+
+/**
+ * @brief creates the GEMM object, on the GPU or on the simulated device
+ * @param m matrix size
+ * @param n matrix size
+ * @param k matrix size
+ * @param num_inflight max number of GEMM launches kept in flight
+ * @return pointer to the new rvs_blas
+ */
+rvs_blas* GSTWorker::create_blas(int m, int n, int k, int num_inflight) {
+    if (use_sim)
+        return new rvs_blas_sim(sim_dev.get(), m, n, k, gst_ops_type,
+                                batch_count, gemm_streams, num_inflight);
+    return new rvs_blas(gpu_device_index, m, n, k, gst_ops_type,
+                        batch_count, gemm_streams, num_inflight);
+}
+
+/**
+ * @brief runs GEMMs of the given shape for GST_AUTOTUNE_TRIAL_MS
+ * @param shape GEMM shape
+ * @return Gflops achieved (0 if the shape could not be run, e.g.: the
+ * matrices do not fit in the GPU memory)
+ */
+double GSTWorker::measure_gemm_shape(const rvs::gemm_shape& shape) {
+    double millis_gemm = 0;
+    uint64_t num_gemms = 0, start_ns;
+    bool warmed_up = false;
+
+    std::unique_ptr<rvs_blas> blas(create_blas(shape.m, shape.n, shape.k, 1));
+    if (blas->error())
+        return 0;
+
+    blas->set_gemm_wait(gemm_wait);
+    blas->generate_random_matrix_data(seed);
+    if (!blas->copy_data_to_gpu())
+        return 0;
+
+    start_ns = clk->now_ns();
+    while (clk->now_ns() - start_ns <
+                            GST_AUTOTUNE_TRIAL_MS * 1000000ULL) {
+        if (rvs::lp::Stopping())
+            return 0;
+        if (!blas->run_blass_gemm() || !blas->wait_gemm_op_complete())
+            return 0;
+        // the first GEMM pays for the kernel load, it is not counted
+        if (!warmed_up) {
+            warmed_up = true;
+            continue;
+        }
+        millis_gemm += blas->get_gemm_op_time_ms();
+        num_gemms++;
+    }
+
+    if (millis_gemm <= 0)
+        return 0;
+    return blas->gemm_gflop_count() * num_gemms / (millis_gemm / 1000);
+}
+
+/**
+ * @brief sets the matrix sizes to the best GEMM shape of this GPU, either
+ * found in the autotune cache or measured by a sweep of square shapes
+ * followed by a refinement of the depth (k) of the best one
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if the matrix sizes were set
+ */
+bool GSTWorker::autotune_matrix_size(int *error, string *err_description) {
+    string msg;
+    rvs::autotune_cache cache(autotune_cache);
+    string key = use_sim ?
+        rvs::autotune_cache::make_key(gst_ops_type, gpu_id, "sim", "sim") :
+        rvs::autotune_cache::device_key(gst_ops_type, gpu_id,
+                                        gpu_device_index);
+    rvs::gemm_shape best = {0, 0, 0, 0};
+    bool cached = cache.lookup(key, &best);
+    // integer GEMMs are reported in ops instead of flops
+    string unit = gst_ops_type == "i8gemm" ? GST_LOG_GOPS_INTERVAL_KEY :
+                                             GST_LOG_GFLOPS_INTERVAL_KEY;
+
+    *error = 0;
+    if (!cached) {
+        std::vector<rvs::gemm_shape> shapes =
+                                rvs::autotune_cache::candidates();
+        for (int pass = 0; pass < 2; pass++) {
+            for (rvs::gemm_shape shape : shapes) {
+                shape.gflops = measure_gemm_shape(shape);
+                if (rvs::lp::Stopping())
+                    return false;
+
+                msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                    std::to_string(gpu_id) + " " + GST_AUTOTUNE_TRIAL_MSG +
+                    " " + std::to_string(shape.m) + "x" +
+                    std::to_string(shape.n) + "x" + std::to_string(shape.k) +
+                    " " + unit + ": " +
+                    std::to_string(shape.gflops);
+                rvs::lp::Log(msg, rvs::logdebug);
+
+                if (shape.gflops > best.gflops)
+                    best = shape;
+            }
+            if (best.gflops <= 0)
+                break;
+            shapes = rvs::autotune_cache::refine(best);
+        }
+
+        if (best.gflops <= 0) {
+            *error = 1;
+            *err_description = GST_AUTOTUNE_ERROR;
+            return false;
+        }
+
+        if (!cache.store(key, best)) {
+            msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_AUTOTUNE_MSG +
+                " cannot update " + cache.get_path();
+            rvs::lp::Log(msg, rvs::loginfo);
+        }
+    }
+
+    matrix_size_a = best.m;
+    matrix_size_b = best.n;
+    matrix_size_c = best.k;
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+        std::to_string(gpu_id) + " " + GST_AUTOTUNE_MSG + " " +
+        std::to_string(best.m) + "x" + std::to_string(best.n) + "x" +
+        std::to_string(best.k) + " " + (cached ? "cached" : "measured") +
+        " " + unit + ": " + std::to_string(best.gflops);
+    rvs::lp::Log(msg, rvs::logresults);
+    log_to_json(GST_AUTOTUNE_MSG, std::to_string(best.m) + "x" +
+                std::to_string(best.n) + "x" + std::to_string(best.k),
+                rvs::logresults);
+    return true;
+}
+
+/**
+ * @brief performs the rvsBlas setup
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ */
+void GSTWorker::setup_blas(int *error, string *err_description) {
+    *error = 0;
+    // setup rvsBlas
+    gpu_blas = std::unique_ptr<rvs_blas>(
+        create_blas(matrix_size_a, matrix_size_b, matrix_size_c, gemm_inflight));
+
+    if (!gpu_blas) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+
+    if (gpu_blas->error()) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+
+    gpu_blas->set_gemm_wait(gemm_wait);
+
+    if (verify_interval && !gpu_blas->init_verify(verify_tiles)) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+
+    // copy_matrix: pinned host matrices, uploaded on a copy stream into two
+    // device copies, so PCIe and compute are stressed together
+    if (copy_matrix && !gpu_blas->init_async_copy()) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+
+    // generate random matrix & copy it to the GPU (with copy_matrix, this is
+    // the upload of the first GEMM)
+    gpu_blas->generate_random_matrix_data(seed);
+    if (!gpu_blas->copy_data_to_gpu()) {
+        *error = 1;
+        *err_description = GST_BLAS_MEMCPY_ERROR;
+    }
+}
+
+/**
+ * @brief with copy_matrix, uploads the matrices of the next GEMM; called
+ * right after a GEMM was enqueued, so the upload runs while it computes
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if everything went fine, otherwise false
+ */
+bool GSTWorker::upload_next_matrices(int *error, string *err_description) {
+    if (!copy_matrix)
+        return true;
+    if (!gpu_blas->copy_data_to_gpu()) {
+        *error = 1;
+        *err_description = GST_BLAS_MEMCPY_ERROR;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief attempts to hit the maximum Gflops value
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ */
+void GSTWorker::hit_max_gflops(int *error, string *err_description) {
+    uint64_t gst_start_time, gst_end_time, gst_log_interval_time;
+    double seconds_elapsed = 0, curr_gflops, millis_gemm_log_interval = 0;
+    double millis_gemm_total = 0;
+    uint16_t num_sgemm_ops_log_interval = 0;
+    uint64_t millis_sgemm_ops, num_sgemm_ops_total = 0;
+    string msg;
+
+    *error = 0;
+    peak_gflops = 0;
+    if (gpu_blas->get_num_inflight() > 1) {
+        hit_max_gflops_pipelined(error, err_description);
+        return;
+    }
+
+    gst_start_time = clk->now_ms();
+    gst_log_interval_time = clk->now_ms();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            break;
+
+        gst_end_time = clk->now_ms();
+        if (time_diff(gst_end_time, gst_start_time) >=
+                            NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+            break;
+
+        // run GEMM & wait for completion
+        if (!gpu_blas->run_blass_gemm())
+            continue;  // failed to run the current SGEMM
+        if (!upload_next_matrices(error, err_description))
+            return;
+
+        if (!gpu_blas->wait_gemm_op_complete()) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return;
+        }
+
+        // peak GFLOPS are computed from the GPU time of the GEMMs alone
+        // (as measured by the HIP events), host side gaps are not counted
+        millis_gemm_log_interval += gpu_blas->get_gemm_op_time_ms();
+        num_sgemm_ops_log_interval++;
+        millis_gemm_total += gpu_blas->get_gemm_op_time_ms();
+        num_sgemm_ops_total++;
+
+        gst_end_time = clk->now_ms();
+        millis_sgemm_ops = time_diff(gst_end_time, gst_log_interval_time);
+
+        if (millis_sgemm_ops >= log_interval) {
+            // compute the GFLOPS
+            seconds_elapsed = millis_gemm_log_interval / 1000;
+            if (seconds_elapsed != 0) {
+                curr_gflops = static_cast<double>(gpu_blas->gemm_gflop_count() *
+                                num_sgemm_ops_log_interval) / seconds_elapsed;
+                log_interval_gflops(curr_gflops);
+            }
+
+            num_sgemm_ops_log_interval = 0;
+            millis_gemm_log_interval = 0;
+            gst_log_interval_time = clk->now_ms();
+        }
+    }
+
+    if (millis_gemm_total > 0)
+        peak_gflops = gpu_blas->gemm_gflop_count() * num_sgemm_ops_total /
+                        (millis_gemm_total / 1000);
+}
+
+/**
+ * @brief sets up the GEMM rate controller from the peak Gflops measured by
+ * hit_max_gflops()
+ */
+void GSTWorker::init_gemm_control(void) {
+    if (peak_gflops > 0) {
+        ff_duty = std::min(1.0, target_stress / peak_gflops);
+        avg_gemm_ms = 1000 * gpu_blas->gemm_gflop_count() / peak_gflops;
+    } else {
+        ff_duty = 1;
+        avg_gemm_ms = 0;
+    }
+    ff_duty = std::max(ff_duty, GST_CTRL_MIN_DUTY);
+
+    // the PI output scales the feed-forward duty within [min duty, 1]
+    gemm_ctrl.set_limits(GST_CTRL_MIN_DUTY / ff_duty - 1, 1 / ff_duty - 1);
+    gemm_ctrl.reset(0);
+    gemm_duty = ff_duty;
+
+    ctrl_window_start_ns = clk->now_ns();
+    ctrl_window_gemms = 0;
+    gemm_pacer.start();
+}
+
+/**
+ * @brief waits for the launch deadline of the next GEMM (the previous
+ * deadline plus GEMM time / duty); no wait at full duty
+ */
+void GSTWorker::wait_gemm_slot(void) {
+    if (gemm_duty >= 1) {
+        gemm_pacer.start();
+        return;
+    }
+    gemm_pacer.wait_next(avg_gemm_ms / gemm_duty);
+}
+
+/**
+ * @brief accounts one completed GEMM and, at the end of each control window,
+ * updates the duty cycle from the Gflops achieved in the window
+ * @param gemm_ms GPU time of the GEMM (0 if not measured)
+ * @param window_gflops [out] Gflops of the control window (can be nullptr)
+ * @return true if a control window ended
+ */
+bool GSTWorker::update_gemm_control(double gemm_ms, double *window_gflops) {
+    if (gemm_ms > 0)
+        avg_gemm_ms += GST_CTRL_GEMM_MS_WEIGHT * (gemm_ms - avg_gemm_ms);
+    ctrl_window_gemms++;
+
+    uint64_t now = clk->now_ns();
+    double window_ms = static_cast<double>(now - ctrl_window_start_ns) / 1e6;
+    if (window_ms < GST_CTRL_WINDOW_MS ||
+            ctrl_window_gemms < GST_CTRL_WINDOW_MIN_GEMMS)
+        return false;
+
+    double gflops = gpu_blas->gemm_gflop_count() * ctrl_window_gemms /
+                        (window_ms / 1000);
+    double rel_error = (target_stress - gflops) / target_stress;
+    gemm_duty = ff_duty * (1 + gemm_ctrl.update(rel_error, window_ms / 1000));
+
+    ctrl_window_start_ns = now;
+    ctrl_window_gemms = 0;
+    if (window_gflops)
+        *window_gflops = gflops;
+    return true;
+}
+
+/**
+ * @brief performs the ramp-up on the given GPU (attempts to reach the given 
+ * target stress Gflops)
+ *
+ * After the peak Gflops are measured, the GEMMs are launched on absolute
+ * deadlines whose period (GEMM GPU time / duty cycle) is set by a PI
+ * controller. The ramp ends once GST_CTRL_SETTLE_WINDOWS consecutive control
+ * windows are within target_stress +/- tolerance / 2; the settle time and
+ * the overshoot are reported with the test result.
+ *
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if target stress is achieved within the ramp_interval,
+ * false otherwise
+ */
+bool GSTWorker::do_gst_ramp(int *error, string *err_description) {
+    uint64_t gst_start_time, gst_end_time, gst_log_interval_time;
+    double seconds_elapsed, curr_gflops, window_gflops;
+    uint16_t num_sgemm_ops_log_interval = 0;
+    uint64_t millis_sgemm_ops;
+    int settled_windows = 0;
+    string msg;
+
+    // make sure that the ramp_interval & duration are not less than
+    // NMAX_MS_GPU_RUN_PEAK_PERFORMANCE (e.g.: 1000)
+    if (run_duration_ms < NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+        run_duration_ms += NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+    if (ramp_interval < NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+        ramp_interval += NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+
+    // stage 1. setup rvs blas
+    setup_blas(error, err_description);
+    if (*error)
+        return false;
+
+    // stage 2. run SGEMM with the given matrix_size for about
+    // NMAX_MS_GPU_RUN_PEAK_PERFORMANCE ms (e.g.: 1000) in order to hit the
+    // maximum Gflops value
+    hit_max_gflops(error, err_description);
+    if (*error)
+        return false;
+
+    // check if stop signal was received
+    if (rvs::lp::Stopping())
+        return false;
+
+    // stage 3. pace the SGEMMs with the rate controller until the Gflops
+    // settle around target_stress
+    init_gemm_control();
+    ramp_settled = false;
+    ramp_overshoot = 0;
+    ramp_actual_time = ramp_interval;
+
+    gst_start_time = clk->now_ms();
+    gst_log_interval_time = clk->now_ms();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        gst_end_time = clk->now_ms();
+        if (time_diff(gst_end_time,  gst_start_time) >
+                            ramp_interval - NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+            return false;
+
+        // run GEMM (on its launch deadline) & wait for completion
+        wait_gemm_slot();
+        if (!gpu_blas->run_blass_gemm())
+            continue;  // failed to run the current SGEMM
+        if (!upload_next_matrices(error, err_description))
+            return false;
+        if (!gpu_blas->wait_gemm_op_complete()) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+        num_sgemm_ops_log_interval++;
+
+        if (update_gemm_control(gpu_blas->get_gemm_op_time_ms(),
+                                &window_gflops)) {
+            ramp_overshoot = std::max(ramp_overshoot,
+                                      window_gflops / target_stress - 1);
+            if (fabs(window_gflops - target_stress) <=
+                    target_stress * tolerance / 2)
+                settled_windows++;
+            else
+                settled_windows = 0;
+
+            if (settled_windows >= GST_CTRL_SETTLE_WINDOWS) {
+                gst_end_time = clk->now_ms();
+                ramp_settled = true;
+                ramp_settle_ms = time_diff(gst_end_time, gst_start_time);
+                ramp_actual_time = ramp_settle_ms +
+                                    NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+                return true;
+            }
+        }
+
+        gst_end_time = clk->now_ms();
+        millis_sgemm_ops =
+                    time_diff(gst_end_time, gst_log_interval_time);
+        if (millis_sgemm_ops >= log_interval) {
+            // compute the GFLOPS
+            seconds_elapsed = static_cast<double>
+                                (millis_sgemm_ops) / 1000;
+            if (seconds_elapsed > 0) {
+                curr_gflops = static_cast<double>(
+                                gpu_blas->gemm_gflop_count() *
+                                num_sgemm_ops_log_interval) / seconds_elapsed;
+                log_interval_gflops(curr_gflops);
+            }
+
+            num_sgemm_ops_log_interval = 0;
+            gst_log_interval_time = clk->now_ms();
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief logs the Gflops computed over the last log_interval period 
+ * @param gflops_interval the Gflops that the GPU achieved
+ */
+void GSTWorker::log_interval_gflops(double gflops_interval) {
+    string msg;
+    // integer GEMMs are reported in Gops
+    string key = gpu_blas->is_integer_op() ? GST_LOG_GOPS_INTERVAL_KEY :
+                                             GST_LOG_GFLOPS_INTERVAL_KEY;
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + key + " " +
+            std::to_string(gflops_interval);
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(key, std::to_string(gflops_interval), rvs::loginfo);
+    rvs::lp::Sample(MODULE_NAME, gpu_id, key.c_str(), gflops_interval);
+}
+
+/**
+ * @brief drives the sampled result verification: collects the previous check
+ * once the host is done with it and starts a new one every verify_interval
+ * GEMMs; the host side of a check runs while the next GEMMs execute
+ * @param final_check true at the end of the stress test: waits for the
+ * pending check and does not start a new one
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if everything went fine, otherwise false
+ */
+bool GSTWorker::verify_gemm_results(bool final_check, int *error,
+                                    string *err_description) {
+    std::vector<rvs_gemm_mismatch> mismatches;
+
+    if (!verify_interval)
+        return true;
+
+    if (!final_check) {
+        num_gemms_since_verify++;
+        // the host is still checking the previous sample
+        if (gpu_blas->is_verify_running())
+            return true;
+    }
+
+    if (!gpu_blas->finish_verify(&mismatches)) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+        return false;
+    }
+    log_verify_mismatches(mismatches);
+
+    if (!final_check && num_gemms_since_verify >= verify_interval) {
+        if (!gpu_blas->start_verify()) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+        num_gemms_since_verify = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief logs the C elements which failed a result verification, together
+ * with the seed the matrix data can be regenerated from
+ * @param mismatches out of tolerance elements
+ */
+void GSTWorker::log_verify_mismatches(
+                        const std::vector<rvs_gemm_mismatch>& mismatches) {
+    string msg, value;
+    char gpu_value[32], ref_value[32];
+
+    num_verify_mismatches += mismatches.size();
+    for (size_t i = 0; i < mismatches.size() && i < GST_VERIFY_MAX_LOGGED;
+            i++) {
+        snprintf(gpu_value, sizeof(gpu_value), "%.9g", mismatches[i].gpu);
+        snprintf(ref_value, sizeof(ref_value), "%.9g", mismatches[i].ref);
+        value = string(GST_SEED_MSG) + ":" + std::to_string(seed) +
+                " batch:" + std::to_string(mismatches[i].batch) +
+                " row:" + std::to_string(mismatches[i].row) +
+                " col:" + std::to_string(mismatches[i].col) +
+                " gpu:" + gpu_value + " ref:" + ref_value;
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_VERIFY_MISMATCH_MSG + " " +
+                value;
+        rvs::lp::Log(msg, rvs::logresults);
+        log_to_json(GST_VERIFY_MISMATCH_MSG, value, rvs::logresults);
+    }
+    if (mismatches.size() > GST_VERIFY_MAX_LOGGED) {
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_VERIFY_MISMATCH_MSG + " " +
+                std::to_string(mismatches.size() - GST_VERIFY_MAX_LOGGED) +
+                " more";
+        rvs::lp::Log(msg, rvs::logresults);
+    }
+}
+
+/**
+ * @brief checks for Gflops violation 
+ * @param gflops_interval the Gflops that the GPU achieved over the last
+ * log_interval period
+ * @return true if this gflops violates the bounds, false otherwise
+ */
+bool GSTWorker::check_gflops_violation(double gflops_interval) {
+    string msg;
+
+    if (!(gflops_interval > target_stress - target_stress * tolerance &&
+            gflops_interval < target_stress + target_stress * tolerance)) {
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_STRESS_VIOLATION_MSG + " " +
+                std::to_string(gflops_interval);
+//        rvs::lp::Log(msg, rvs::loginfo);
+
+        //log_to_json(GST_STRESS_VIOLATION_MSG, std::to_string(gflops_interval),
+         //           rvs::loginfo);
+        return true;
+    }
+
+
+    return false;
+}
+
+/**
+ * @brief performs the stress test on the given GPU
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if stress violations is less than max_violations, false otherwise
+ */
+bool GSTWorker::do_gst_stress_test(int *error, std::string *err_description) {
+    uint16_t num_sgemm_ops = 0, num_gflops_violations = 0;
+    uint64_t total_milliseconds, log_interval_milliseconds;
+    double seconds_elapsed, gflops_interval;
+    string msg;
+    uint64_t gst_start_time, gst_end_time, gst_log_interval_time;
+
+    *error = 0;
+    max_gflops = 0;
+    num_sgemm_ops = 0;
+    gemm_hist.reset();
+    num_stalls = 0;
+    stall_ref_ms = 0;
+    prev_completion_ms = -1;
+
+    if (gpu_blas->get_num_inflight() > 1)
+        return do_gst_stress_test_pipelined(error, err_description);
+
+    gst_start_time = clk->now_ms();
+    gst_log_interval_time = clk->now_ms();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        // run GEMM (on its launch deadline) & wait for completion
+        wait_gemm_slot();
+        if (gpu_blas->run_blass_gemm()) {
+            if (!upload_next_matrices(error, err_description))
+                return false;
+            if (!gpu_blas->wait_gemm_op_complete()) {
+                *error = 1;
+                *err_description = GST_BLAS_ERROR;
+                return false;
+            }
+            num_sgemm_ops++;
+            // the controller keeps the load steady for the whole test
+            update_gemm_control(gpu_blas->get_gemm_op_time_ms(), nullptr);
+            record_gemm_time(gpu_blas->get_gemm_op_time_ms());
+        }
+
+        if (!verify_gemm_results(false, error, err_description))
+            return false;
+
+        gst_end_time = clk->now_ms();
+        total_milliseconds = time_diff(gst_end_time, gst_start_time);
+        log_interval_milliseconds = time_diff(gst_end_time,
+                                              gst_log_interval_time);
+
+        if (log_interval_milliseconds >= log_interval && num_sgemm_ops > 0) {
+            seconds_elapsed = static_cast<double> (log_interval_milliseconds) /
+                                1000;
+            if (seconds_elapsed != 0) {
+                gflops_interval =
+                        static_cast<double>(gpu_blas->gemm_gflop_count()
+                            * num_sgemm_ops) / seconds_elapsed;
+                if (gflops_interval > max_gflops)
+                    max_gflops = gflops_interval;
+
+                log_interval_gflops(gflops_interval);
+
+                if (check_gflops_violation(gflops_interval))
+                    num_gflops_violations++;
+
+                // reset time & gflops related data
+                num_sgemm_ops = 0;
+                gst_log_interval_time = clk->now_ms();
+            }
+        }
+
+        if (total_milliseconds >= run_duration_ms - ramp_actual_time)
+            break;
+    }
+
+    if (!verify_gemm_results(true, error, err_description))
+        return false;
+
+    if (num_gflops_violations > max_violations)
+        return false;
+
+    return true;
+}
+
+/**
+ * @brief tops up the pipelined submission so that gemm_inflight GEMM
+ * launches are queued
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if everything went fine, otherwise false
+ */
+bool GSTWorker::fill_gemm_pipeline(int *error, string *err_description) {
+    while (gpu_blas->get_gemms_in_flight() < gpu_blas->get_num_inflight()) {
+        if (!gpu_blas->enqueue_gemm()) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+        if (!upload_next_matrices(error, err_description))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief pipelined version of hit_max_gflops(): keeps gemm_inflight GEMM
+ * launches queued across gemm_streams streams; the GFLOPS are computed from
+ * the GPU completion timestamps
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ */
+void GSTWorker::hit_max_gflops_pipelined(int *error, string *err_description) {
+    uint64_t gst_start_time;
+    double interval_start_ms = 0, interval_ms, curr_gflops;
+    uint64_t num_gemm_ops_log_interval = 0, num_gemm_ops_total = 0;
+
+    if (!gpu_blas->start_gemm_timeline()) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+        return;
+    }
+
+    gst_start_time = clk->now_ms();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            break;
+
+        if (time_diff(clk->now_ms(), gst_start_time) >=
+                            NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+            break;
+
+        if (!fill_gemm_pipeline(error, err_description))
+            return;
+
+        if (!gpu_blas->wait_oldest_gemm()) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return;
+        }
+        num_gemm_ops_log_interval++;
+        num_gemm_ops_total++;
+
+        interval_ms = gpu_blas->get_last_completion_ms() - interval_start_ms;
+        if (interval_ms >= log_interval) {
+            curr_gflops = static_cast<double>(gpu_blas->gemm_gflop_count() *
+                            num_gemm_ops_log_interval) / (interval_ms / 1000);
+            log_interval_gflops(curr_gflops);
+
+            num_gemm_ops_log_interval = 0;
+            interval_start_ms = gpu_blas->get_last_completion_ms();
+        }
+    }
+
+    if (gpu_blas->get_last_completion_ms() > 0)
+        peak_gflops = gpu_blas->gemm_gflop_count() * num_gemm_ops_total /
+                        (gpu_blas->get_last_completion_ms() / 1000);
+
+    if (!gpu_blas->drain_gemms()) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+    }
+}
+
+/**
+ * @brief pipelined version of do_gst_stress_test(): keeps gemm_inflight GEMM
+ * launches queued across gemm_streams streams; the GFLOPS are computed from
+ * the GPU completion timestamps
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if stress violations is less than max_violations, false otherwise
+ */
+bool GSTWorker::do_gst_stress_test_pipelined(int *error,
+                                             string *err_description) {
+    uint64_t gst_start_time;
+    double interval_start_ms = 0, interval_ms, gflops_interval;
+    uint64_t num_gemm_ops = 0, num_gflops_violations = 0;
+
+    if (!gpu_blas->start_gemm_timeline()) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+        return false;
+    }
+
+    gst_start_time = clk->now_ms();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping()) {
+            gpu_blas->drain_gemms();
+            return false;
+        }
+
+        if (!fill_gemm_pipeline(error, err_description))
+            return false;
+
+        if (!gpu_blas->wait_oldest_gemm()) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+        num_gemm_ops++;
+        // the launches overlap, so the time between two completions stands
+        // for the GEMM time (the first one also includes the queue fill)
+        if (prev_completion_ms >= 0)
+            record_gemm_time(gpu_blas->get_last_completion_ms() -
+                             prev_completion_ms);
+        prev_completion_ms = gpu_blas->get_last_completion_ms();
+
+        if (!verify_gemm_results(false, error, err_description))
+            return false;
+
+        // the GEMM time of the pipelined launches is not measured, the
+        // controller keeps the one of the (serial) ramp
+        update_gemm_control(0, nullptr);
+        // space out the launches as set by the ramp controller
+        wait_gemm_slot();
+
+        interval_ms = gpu_blas->get_last_completion_ms() - interval_start_ms;
+        if (interval_ms >= log_interval) {
+            gflops_interval = static_cast<double>(gpu_blas->gemm_gflop_count()
+                                * num_gemm_ops) / (interval_ms / 1000);
+            if (gflops_interval > max_gflops)
+                max_gflops = gflops_interval;
+
+            log_interval_gflops(gflops_interval);
+
+            if (check_gflops_violation(gflops_interval))
+                num_gflops_violations++;
+
+            num_gemm_ops = 0;
+            interval_start_ms = gpu_blas->get_last_completion_ms();
+        }
+
+        if (time_diff(clk->now_ms(), gst_start_time) >=
+                run_duration_ms - ramp_actual_time)
+            break;
+    }
+
+    if (!gpu_blas->drain_gemms()) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+        return false;
+    }
+
+    if (!verify_gemm_results(true, error, err_description))
+        return false;
+
+    if (num_gflops_violations > max_violations)
+        return false;
+
+    return true;
+}
+
+/**
+ * @brief performs the stress test on the given GPU
+ */
+void GSTWorker::run() {
+    string msg, err_description;
+    int error = 0;
+    bool gst_test_passed = true;
+
+    max_gflops = 0;
+
+    // log GST stress test - start message
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_START_MSG + " " +
+            std::to_string(target_stress) + " " + GST_COPY_MATRIX_MSG + ":" +
+            (copy_matrix ? "true":"false") + " " + GST_SEED_MSG + ":" +
+            std::to_string(seed);
+    rvs::lp::Log(msg, rvs::loginfo);
+
+    log_to_json(GST_START_MSG, std::to_string(target_stress), rvs::loginfo);
+    log_to_json(GST_COPY_MATRIX_MSG, (copy_matrix ? "true":"false"),
+                rvs::loginfo);
+    log_to_json(GST_SEED_MSG, std::to_string(seed), rvs::loginfo);
+
+    if (autotune && !autotune_matrix_size(&error, &err_description)) {
+        if (error) {
+            msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + err_description;
+            rvs::lp::Log(msg, rvs::logerror);
+            log_to_json("err", err_description, rvs::logerror);
+        }
+        return;
+    }
+
+    // let the GPU ramp-up and check the result
+    bool ramp_up_success = do_gst_ramp(&error, &err_description);
+
+    // check if stop signal was received (the GEMM waits return early)
+    if (rvs::lp::Stopping())
+        return;
+
+    // GPU was not able to do the processing (HIP/rocBlas error(s) occurred)
+    if (error) {
+        string msg = "[" + action_name + "] " + MODULE_NAME + " "
+                        + std::to_string(gpu_id) + " " + err_description;
+        rvs::lp::Log(msg, rvs::logerror);
+        log_to_json("err", err_description, rvs::logerror);
+
+        return;
+    }
+
+#if 0
+    if (!ramp_up_success) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return;
+
+        // the selected GPU was not able to achieve the target_stress GFLOPS
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_RAMP_EXCEEDED_MSG + " " +
+                std::to_string(ramp_interval);
+        rvs::lp::Log(msg, rvs::loginfo);
+        log_to_json(GST_RAMP_EXCEEDED_MSG, std::to_string(ramp_interval),
+                    rvs::loginfo);
+        gst_test_passed = false;
+    } else {
+#endif
+
+        // the GPU succeeded to achieve the target_stress GFLOPS
+        // continue with the same workload for the rest of the test duration
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_TARGET_ACHIEVED_MSG + " " +
+                std::to_string(target_stress);
+        rvs::lp::Log(msg, rvs::logresults);
+        log_to_json(GST_TARGET_ACHIEVED_MSG, std::to_string(target_stress),
+                    rvs::logresults);
+        if (run_duration_ms > 0) {
+            gst_test_passed = do_gst_stress_test(&error, &err_description);
+            // wrong GEMM results fail the test regardless of the Gflops
+            if (num_verify_mismatches)
+                gst_test_passed = false;
+            // so do GEMM times spread beyond max_jitter
+            if (max_jitter > 0 && gemm_jitter() > max_jitter)
+                gst_test_passed = false;
+            // check if stop signal was received
+            if (rvs::lp::Stopping())
+                return;
+
+            if (error) {
+                // GPU didn't complete the test (HIP/rocBlas error(s) occurred)
+                string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                                std::to_string(gpu_id) + " " + err_description;
+                rvs::lp::Log(msg, rvs::logerror);
+                log_to_json("err", err_description, rvs::logerror);
+                return;
+            }
+        }
+#if 0
+    }
+#endif
+
+    log_gst_test_result(gst_test_passed);
+}
+
+/**
+ * @brief adds a GEMM time to the stress test distribution and reports it as
+ * a stall if it exceeds stall_factor times the median so far
+ * @param gemm_ms GEMM time (ms)
+ */
+void GSTWorker::record_gemm_time(double gemm_ms) {
+    gemm_hist.add(static_cast<uint64_t>(gemm_ms * 1e6));
+
+    // the median is only recomputed now and then (it walks the buckets)
+    if (gemm_hist.count() % GST_STALL_REF_GEMMS == 0)
+        stall_ref_ms = static_cast<double>(gemm_hist.percentile(50)) / 1e6;
+
+    if (gemm_hist.count() > GST_STALL_MIN_GEMMS && stall_ref_ms > 0 &&
+            gemm_ms > stall_factor * stall_ref_ms) {
+        num_stalls++;
+        log_gemm_stall(gemm_ms);
+    }
+}
+
+/**
+ * @brief logs a GEMM stall; the log record carries the monotonic time stamp
+ * the gm samples use, so the stall can be matched with the GPU metrics
+ * @param gemm_ms GEMM time (ms)
+ */
+void GSTWorker::log_gemm_stall(double gemm_ms) {
+    unsigned int sec, usec;
+    char ts[32];
+
+    rvs::lp::get_ticks(&sec, &usec);
+    snprintf(ts, sizeof(ts), "%u.%06u", sec, usec);
+
+    string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+        std::to_string(gpu_id) + " " + GST_GEMM_STALL_MSG + " " +
+        std::to_string(gemm_ms) + " ms median " +
+        std::to_string(stall_ref_ms) + " ms at " + ts;
+    rvs::lp::Log(msg, rvs::loginfo, sec, usec);
+    log_to_json(GST_GEMM_STALL_MSG, std::to_string(gemm_ms), rvs::loginfo);
+}
+
+/**
+ * @brief returns the spread of the stress test GEMM times
+ * @return (p99 - p50) / p50 (0 if no GEMM was timed)
+ */
+double GSTWorker::gemm_jitter(void) {
+    double p50 = static_cast<double>(gemm_hist.percentile(50));
+    if (p50 <= 0)
+        return 0;
+    return (static_cast<double>(gemm_hist.percentile(99)) - p50) / p50;
+}
+
+/**
+ * @brief logs the GST test result
+ * @param gst_test_passed true if test succeeded, false otherwise
+ */
+void GSTWorker::log_gst_test_result(bool gst_test_passed) {
+    string msg;
+    bool is_integer = gpu_blas->is_integer_op();
+    // integer GEMMs are reported in ops instead of flops
+    string max_key = is_integer ? GST_MAX_GOPS_OUTPUT_KEY :
+                                  GST_MAX_GFLOPS_OUTPUT_KEY;
+    string max_t_key = is_integer ? GST_MAX_TOPS_OUTPUT_KEY :
+                                    GST_MAX_TFLOPS_OUTPUT_KEY;
+    string per_op_key = is_integer ? GST_OPS_PER_OP_OUTPUT_KEY :
+                                     GST_FLOPS_PER_OP_OUTPUT_KEY;
+
+    double flops_per_op = (2 * (static_cast<double>(gpu_blas->get_m())/1000) *
+                                (static_cast<double>(gpu_blas->get_n())/1000) *
+                                (static_cast<double>(gpu_blas->get_k())/1000));
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+        std::to_string(gpu_id) + " " + max_key + ": " +
+        std::to_string(max_gflops) + " " + max_t_key + ": " +
+        std::to_string(max_gflops / 1000) + " " + per_op_key + ": " +
+        std::to_string(flops_per_op) + "x1e9" + " " +
+        GST_BYTES_COPIED_PER_OP_OUTPUT_KEY + ": " +
+        std::to_string(gpu_blas->get_bytes_copied_per_op()) +
+        " " + GST_TRY_OPS_PER_SEC_OUTPUT_KEY + ": "+
+        std::to_string(target_stress / gpu_blas->gemm_gflop_count()) +
+        " "  ;
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(max_key, std::to_string(max_gflops), rvs::loginfo);
+    log_to_json(max_t_key, std::to_string(max_gflops / 1000), rvs::loginfo);
+    log_to_json(per_op_key, std::to_string(flops_per_op) + "x1e9",
+                rvs::loginfo);
+    log_to_json(GST_BYTES_COPIED_PER_OP_OUTPUT_KEY,
+                std::to_string(gpu_blas->get_bytes_copied_per_op()),
+                rvs::loginfo);
+    log_to_json(GST_TRY_OPS_PER_SEC_OUTPUT_KEY,
+                std::to_string(target_stress / gpu_blas->gemm_gflop_count()),
+                rvs::loginfo);
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+        std::to_string(gpu_id) + " " + GST_RAMP_SETTLE_MS_KEY + ": " +
+        (ramp_settled ? std::to_string(ramp_settle_ms) : "none") + " " +
+        GST_RAMP_OVERSHOOT_KEY + ": " + std::to_string(ramp_overshoot * 100) +
+        "%";
+    rvs::lp::Log(msg, rvs::logresults);
+    log_to_json(GST_RAMP_SETTLE_MS_KEY,
+                ramp_settled ? std::to_string(ramp_settle_ms) : "none",
+                rvs::logresults);
+    log_to_json(GST_RAMP_OVERSHOOT_KEY, std::to_string(ramp_overshoot * 100),
+                rvs::logresults);
+
+    if (gemm_hist.count()) {
+        double p50 = static_cast<double>(gemm_hist.percentile(50)) / 1e6;
+        double p99 = static_cast<double>(gemm_hist.percentile(99)) / 1e6;
+        double pmax = static_cast<double>(gemm_hist.max()) / 1e6;
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_GEMM_P50_MS_KEY + ": " +
+            std::to_string(p50) + " " + GST_GEMM_P99_MS_KEY + ": " +
+            std::to_string(p99) + " " + GST_GEMM_MAX_MS_KEY + ": " +
+            std::to_string(pmax) + " " + GST_GEMM_STALLS_KEY + ": " +
+            std::to_string(num_stalls) + " " + GST_GEMM_JITTER_KEY + ": " +
+            std::to_string(gemm_jitter());
+        rvs::lp::Log(msg, rvs::logresults);
+        log_to_json(GST_GEMM_P50_MS_KEY, std::to_string(p50),
+                    rvs::logresults);
+        log_to_json(GST_GEMM_P99_MS_KEY, std::to_string(p99),
+                    rvs::logresults);
+        log_to_json(GST_GEMM_MAX_MS_KEY, std::to_string(pmax),
+                    rvs::logresults);
+        log_to_json(GST_GEMM_STALLS_KEY, std::to_string(num_stalls),
+                    rvs::logresults);
+        log_to_json(GST_GEMM_JITTER_KEY, std::to_string(gemm_jitter()),
+                    rvs::logresults);
+    }
+
+    if (verify_interval) {
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_VERIFY_CHECKS_KEY + ": " +
+            std::to_string(gpu_blas->get_num_verify()) + " " +
+            GST_VERIFY_MISMATCHES_KEY + ": " +
+            std::to_string(num_verify_mismatches);
+        rvs::lp::Log(msg, rvs::logresults);
+        log_to_json(GST_VERIFY_CHECKS_KEY,
+                    std::to_string(gpu_blas->get_num_verify()),
+                    rvs::logresults);
+        log_to_json(GST_VERIFY_MISMATCHES_KEY,
+                    std::to_string(num_verify_mismatches), rvs::logresults);
+    }
+    log_to_json(GST_PASS_KEY, (gst_test_passed ?
+            GST_RESULT_PASS_MESSAGE : GST_RESULT_FAIL_MESSAGE),
+            rvs::logresults);
+}
+
+/**
+ * @brief computes the difference (in milliseconds) between 2 points in time
+ * @param t_end second point in time (ms, as returned by clk->now_ms())
+ * @param t_start first point in time (ms)
+ * @return time difference in milliseconds
+ */
+uint64_t GSTWorker::time_diff(uint64_t t_end, uint64_t t_start) {
+    return t_end > t_start ? t_end - t_start : 0;
+}
+
+/**
+ * @brief logs a message to JSON
+ * @param key info type
+ * @param value message to log
+ * @param log_level the level of log (e.g.: info, results, error)
+ */
+void GSTWorker::log_to_json(const std::string &key, const std::string &value,
+                     int log_level) {
+    if (GSTWorker::bjson) {
+        unsigned int sec;
+        unsigned int usec;
+
+        rvs::lp::get_ticks(&sec, &usec);
+        void *json_node = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), log_level, sec, usec);
+        if (json_node) {
+            rvs::lp::AddString(json_node, GST_JSON_LOG_GPU_ID_KEY,
+                            std::to_string(gpu_id));
+            rvs::lp::AddString(json_node, key, value);
+            rvs::lp::LogRecordFlush(json_node);
+        }
+    }
+}
@@ -0,0 +1,201 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef IET_SO_INCLUDE_BLAS_WORKER_H_
+#define IET_SO_INCLUDE_BLAS_WORKER_H_
+
+#include <atomic>
+#include <string>
+#include <memory>
+#include <mutex>
+#include "include/rvsthreadbase.h"
+#include "include/rvs_barrier.h"
+#include "include/rvs_blas.h"
+#include "include/rvs_clock.h"
+#include "include/rvs_sim.h"
+
+/**
+ * @class blas_worker
+ * @ingroup IET
+ *
+ * @brief blas_worker action implementation class
+ *
+ * Derives from rvs::ThreadBase and implements actual action functionality
+ * in its run() method.
+ *
+ * Once a SGEMM delay is set, the SGEMMs are launched on absolute deadlines
+ * (see rvs::pacer) one SGEMM time plus the delay apart, so the scheduler
+ * latency of each wait does not add up and the duty cycle stays the one the
+ * delay was computed for. New pacing parameters are picked up at the next
+ * launch: the worker never stops the load to take them.
+ *
+ */
+class blas_worker : public rvs::ThreadBase {
+ public:
+    //! square wave load schedule of the burst mode
+    struct burst_schedule {
+        //! barrier shared by all the workers that burst together
+        rvs::barrier* sync;
+        //! full load part of each cycle (ms)
+        uint64_t on_ms;
+        //! idle part of each cycle (ms)
+        uint64_t off_ms;
+        //! time the load takes to go from idle to full at each rising edge
+        //! (ms, 0 = step)
+        uint64_t edge_ms;
+        //! number of cycles
+        uint64_t cycles;
+    };
+
+    blas_worker(int _gpu_device_index, uint64_t _matrix_size);
+    virtual ~blas_worker();
+
+    void set_sgemm_delay(uint64_t _sgemm_delay);
+    uint64_t get_sgemm_delay(void);
+    void set_sgemm_time(uint64_t _sgemm_time);
+    void set_pacing(uint64_t _sgemm_time, uint64_t _sgemm_delay);
+
+    void reset_launch_stats(void);
+    void get_launch_rate(double *requested_hz, double *achieved_hz);
+
+    void set_bcount_sgemm(bool _bcount_sgemm);
+    bool get_bcount_sgemm(void);
+    uint64_t get_num_sgemm_ops(void);
+
+    bool is_setup_complete(void);
+    bool is_sgemm_complete(void);
+
+    void stop(void);
+
+    //! returns the GPU index
+    int get_gpu_device_index(void) { return gpu_device_index; }
+    //! returns the SGEMM matrix size
+    uint64_t get_matrix_size(void) { return matrix_size; }
+    //! returns the BLAS error code
+    int get_blas_error(void) { return blas_error; }
+
+    //! sets the way the worker waits for SGEMM completion (must be called
+    //! before start())
+    void set_gemm_wait(rvs_blas::gemm_wait_t _gemm_wait) {
+        gemm_wait = _gemm_wait;
+    }
+    //! sets the seed of the random matrix data (must be called before
+    //! start())
+    void set_seed(uint64_t _seed) { seed = _seed; }
+    //! runs the SGEMMs on a simulated device instead of the GPU (must be
+    //! called before start())
+    void set_sim_device(rvs::sim_device* _sim_dev) { sim_dev = _sim_dev; }
+    //! sets the time source of the SGEMM delay (must be called before
+    //! start())
+    void set_clock(rvs::clock* _clk) { clk = _clk; }
+    //! sets how long (us) before each launch deadline the worker stops
+    //! sleeping and polls the clock (must be called before start())
+    void set_pacing_spin(uint64_t _pacing_spin) { pacing_spin = _pacing_spin; }
+    //! switches the worker to the burst mode (must be called before start())
+    void set_burst(const burst_schedule& _burst) {
+        burst = _burst;
+        bburst = true;
+    }
+    //! returns the time (ns, on the worker clock) of the first rising edge
+    //! of the burst mode, 0 until the workers agreed on it
+    uint64_t get_burst_epoch(void) { return burst_epoch.load(); }
+    //! returns the number of burst cycles run so far
+    uint64_t get_burst_cycles_done(void) { return burst_cycles_done.load(); }
+
+ protected:
+    virtual void run(void);
+    void set_setup_complete(void);
+    void setup_blas(void);
+    uint64_t get_launch_period(void);
+    bool run_sgemm(void);
+    bool is_running(void);
+    void wait_until(uint64_t deadline_ns);
+    void run_burst(void);
+
+ protected:
+    //! index of the GPU that will run the SGEMM
+    int gpu_device_index;
+    //! SGEMM matrix size
+    uint64_t matrix_size;
+    //! total number of SGEMM that the thread managed to run
+    uint64_t num_sgemm_ops;
+    //! SGEMM delay (which gives the actual SGEMM frequency)
+    uint64_t sgemm_delay;
+    //! expected SGEMM time (us), added to sgemm_delay to get the launch period
+    uint64_t sgemm_time;
+    //! sgemm_time + sgemm_delay (us, 0 if sgemm_delay is 0), read by run()
+    //! without locking
+    std::atomic<uint64_t> launch_period;
+    //! time before each launch deadline spent polling the clock (us)
+    uint64_t pacing_spin;
+    //! number of paced launch periods since reset_launch_stats()
+    uint64_t num_launches;
+    //! sum of the requested launch periods (ns)
+    uint64_t launch_requested_ns;
+    //! sum of the achieved launch periods (ns)
+    uint64_t launch_actual_ns;
+    //! TRUE in burst mode
+    bool bburst;
+    //! burst mode schedule
+    burst_schedule burst;
+    //! first rising edge of the burst mode (ns), 0 until known
+    std::atomic<uint64_t> burst_epoch;
+    //! number of burst cycles run so far
+    std::atomic<uint64_t> burst_cycles_done;
+    //! TRUE when needed to count the number of SGEMM
+    bool bcount_sgemm;
+    //! Loops while TRUE
+    bool brun;
+    //! TRUE when BLAS setup finished
+    bool setup_finished;
+    //! TRUE if last SGEMM finished
+    bool sgemm_done;
+    //! brun synchronization mutex
+    std::mutex mtx_brun;
+    //! SGEMM counter synchronization mutex
+    std::mutex mtx_num_sgemm;
+    //! BLAS setup synchronization mutex
+    std::mutex mtx_blas_setup;
+    //! SGEMM delay synchronization mutex
+    std::mutex mtx_sgemm_delay;
+    //! SGEMM counter flag synchronization mutex
+    std::mutex mtx_bcount_sgemm;
+    //! SGEMM done synchronization mutex
+    std::mutex mtx_bsgemm_done;
+    //! launch statistics synchronization mutex
+    std::mutex mtx_launch_stats;
+    //! rvs_blas pointer
+    std::unique_ptr<rvs_blas> gpu_blas;
+    //! BLAS related error code
+    int blas_error;
+    //! the way the worker waits for SGEMM completion
+    rvs_blas::gemm_wait_t gemm_wait;
+    //! seed of the random matrix data
+    uint64_t seed;
+    //! simulated device (nullptr = the SGEMMs run on the GPU)
+    rvs::sim_device* sim_dev;
+    //! time source
+    rvs::clock* clk;
+};
+#endif  // IET_SO_INCLUDE_BLAS_WORKER_H_
@@ -0,0 +1,299 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef IET_SO_INCLUDE_IET_WORKER_H_
+#define IET_SO_INCLUDE_IET_WORKER_H_
+
+#include <string>
+#include <memory>
+#include <vector>
+#include "include/rvsthreadbase.h"
+#include "include/blas_worker.h"
+#include "include/log_worker.h"
+#include "include/rvs_clock.h"
+#include "include/rvs_power.h"
+#include "include/rvs_sim.h"
+#include "include/rvs_stats.h"
+
+/**
+ * @class IETWorker
+ * @ingroup IET
+ *
+ * @brief IETWorker action implementation class
+ *
+ * Derives from rvs::ThreadBase and implements actual action functionality
+ * in its run() method.
+ *
+ */
+class IETWorker : public rvs::ThreadBase {
+ public:
+    IETWorker();
+    virtual ~IETWorker();
+
+    //! sets action name
+    void set_name(const std::string& name) { action_name = name; }
+    //! returns action name
+    const std::string& get_name(void) { return action_name; }
+
+    //! sets GPU ID
+    void set_gpu_id(uint16_t _gpu_id) { gpu_id = _gpu_id; }
+    //! returns GPU ID
+    uint16_t get_gpu_id(void) { return gpu_id; }
+
+    //! sets the GPU index
+    void set_gpu_device_index(int _gpu_device_index) {
+        gpu_device_index = _gpu_device_index;
+    }
+    //! returns the GPU index
+    int get_gpu_device_index(void) { return gpu_device_index; }
+
+    //! sets the GPU power-index
+    void set_pwr_device_id(int _pwr_device_id) {
+        pwr_device_id = _pwr_device_id;
+    }
+    //! returns the GPU power-index
+    int get_pwr_device_id(void) { return pwr_device_id; }
+
+    //! sets the run delay
+    void set_run_wait_ms(uint64_t _run_wait_ms) {
+        run_wait_ms = _run_wait_ms;
+    }
+    //! returns the run delay
+    uint64_t get_run_wait_ms(void) { return run_wait_ms; }
+
+    //! sets the total EDPp test run duration
+    void set_run_duration_ms(uint64_t _run_duration_ms) {
+        run_duration_ms = _run_duration_ms;
+    }
+    //! returns the total EDPp test run duration
+    uint64_t get_run_duration_ms(void) { return run_duration_ms; }
+
+    //! sets the EDPp test ramp duration
+    void set_ramp_interval(uint64_t _ramp_interval) {
+        ramp_interval = _ramp_interval;
+    }
+    //! returns the EDPp test ramp duration
+    uint64_t get_ramp_interval(void) { return ramp_interval; }
+
+    //! sets the time interval at which the module reports the GPU's power
+    void set_log_interval(uint64_t _log_interval) {
+        log_interval = _log_interval;
+    }
+    //! returns the time interval at which the module reports the GPU's power
+    uint64_t get_log_interval(void) { return log_interval; }
+
+    //! sets the sampling rate for the target_power
+    void set_sample_interval(uint64_t _sample_interval) {
+        sample_interval = _sample_interval;
+    }
+    //! returns the sampling rate for the target_power
+    uint64_t get_sample_interval(void) { return sample_interval; }
+
+    //! sets the maximum allowed number of target_power violations
+    void set_max_violations(uint64_t _max_violations) {
+        max_violations = _max_violations;
+    }
+    //! returns the maximum allowed number of target_power violations
+    uint64_t get_max_violations(void) { return max_violations; }
+
+    //! sets the target power level for the EDPp test
+    void set_target_power(float _target_power) {
+        target_power = _target_power;
+    }
+    //! returns the target power level for the test
+    float get_target_power(void) { return target_power; }
+
+    //! sets the SGEMM matrix size
+    void set_matrix_size(uint64_t _matrix_size) {
+        matrix_size = _matrix_size;
+    }
+    //! returns the SGEMM matrix size
+    uint64_t get_matrix_size(void) { return matrix_size; }
+
+    //! sets the way the BLAS worker waits for SGEMM completion
+    void set_gemm_wait(rvs_blas::gemm_wait_t _gemm_wait) {
+        gemm_wait = _gemm_wait;
+    }
+    //! returns the way the BLAS worker waits for SGEMM completion
+    rvs_blas::gemm_wait_t get_gemm_wait(void) { return gemm_wait; }
+
+    //! sets the seed of the random matrix data
+    void set_seed(uint64_t _seed) { seed = _seed; }
+    //! returns the seed of the random matrix data
+    uint64_t get_seed(void) { return seed; }
+
+    //! sets how long (us) before each SGEMM launch deadline the BLAS worker
+    //! polls the clock instead of sleeping
+    void set_pacing_spin(uint64_t _pacing_spin) { pacing_spin = _pacing_spin; }
+    //! returns the SGEMM launch spin time (us)
+    uint64_t get_pacing_spin(void) { return pacing_spin; }
+
+    //! switches the worker to the burst mode (square wave load in step with
+    //! the other workers sharing the schedule's barrier)
+    void set_burst(const blas_worker::burst_schedule& _burst_sched) {
+        burst_sched = _burst_sched;
+        bburst = true;
+    }
+    //! enables the training cache: a result for the same key that is at
+    //! most _max_age s old and passes a short probe replaces the training
+    void set_training_cache(const std::string& _path, const std::string& _key,
+                            uint64_t _max_age) {
+        training_cache_path = _path;
+        training_key = _key;
+        training_max_age = _max_age;
+    }
+
+    //! selects the ramp controller: a duty cycle -> power fit (true) or
+    //! steps proportional to the power error (false)
+    void set_ramp_model(bool _bramp_model) { bramp_model = _bramp_model; }
+    //! returns TRUE if the ramp uses the duty cycle -> power fit
+    bool get_ramp_model(void) { return bramp_model; }
+
+    //! returns the average GPU power (W) before the first rising edge
+    float get_burst_idle_power(void) { return burst_idle_power; }
+    //! returns the average GPU power (W) of the on part of each burst cycle
+    const std::vector<float>& get_burst_on_power(void) {
+        return burst_on_power;
+    }
+    //! returns the average GPU power (W) of the off part of each burst cycle
+    const std::vector<float>& get_burst_off_power(void) {
+        return burst_off_power;
+    }
+
+    //! sets the EDPp power tolerance
+    void set_tolerance(float _tolerance) { tolerance = _tolerance; }
+    //! returns the EDPp power tolerance
+    float get_tolerance(void) { return tolerance; }
+
+    //! sets the JSON flag
+    static void set_use_json(bool _bjson) { bjson = _bjson; }
+
+    void set_sim_backend(const rvs::sim_model& model);
+    //! returns the JSON flag
+    static bool get_use_json(void) { return bjson; }
+
+ protected:
+    virtual void run(void);
+    bool do_gpu_init_training(std::string *err_description);
+    bool start_gpu_worker(std::string *err_description);
+    bool run_training(uint64_t window_ms, std::string *err_description);
+    bool use_cached_training(std::string *err_description);
+    void log_training_cache(const std::string& status);
+    bool do_iet_burst(std::string *err_description);
+    void compute_gpu_stats(void);
+    void compute_new_sgemm_freq(float avg_power);
+    float get_duty_cycle(void);
+    void compute_model_sgemm_freq(float avg_power);
+    void log_convergence(uint64_t convergence_ms);
+    void log_launch_rate(void);
+    bool do_iet_ramp(int *error, std::string *err_description);
+    bool do_iet_power_stress(void);
+    void log_to_json(const std::string &key, const std::string &value,
+                        int log_level);
+
+
+ protected:
+    //! name of the action
+    std::string action_name;
+    //! index of the GPU (as reported by HIP API) that will run the EDPp test
+    int gpu_device_index;
+    //! ID of the GPU that will run the EDPp test
+    uint16_t gpu_id;
+    //! index of the GPU device as requested by rocm_smi
+    uint32_t pwr_device_id;
+    //! EDPp test run delay
+    uint64_t run_wait_ms;
+    //! EDPp test run duration
+    uint64_t run_duration_ms;
+    //! stress test ramp duration
+    uint64_t ramp_interval;
+    //! time interval at which the GPU's power is logged out
+    uint64_t log_interval;
+    //! sampling rate for the target_power
+    uint64_t sample_interval;
+    //! maximum allowed number of target_power violations
+    uint64_t max_violations;
+    //! target power level for the test
+    float target_power;
+    //! power tolerance (how much the target_power can fluctuare after
+    //! the ramp period for the test to succeed)
+    float tolerance;
+    //! SGEMM matrix size
+    uint64_t matrix_size;
+    //! the way the BLAS worker waits for SGEMM completion
+    rvs_blas::gemm_wait_t gemm_wait;
+    //! seed of the random matrix data
+    uint64_t seed;
+    //! time before each SGEMM launch deadline spent polling the clock (us)
+    uint64_t pacing_spin;
+    //! TRUE if JSON output is required
+    static bool bjson;
+    //! blas_worker pointer
+    std::unique_ptr<blas_worker> gpu_worker;
+    //! log_worker pointer
+    std::unique_ptr<log_worker> pwr_log_worker;
+    //! simulated device (backend: sim), nullptr for the GPU
+    std::unique_ptr<rvs::sim_device> sim_dev;
+    //! source of the power readings
+    rvs::power_reader* pwr_reader;
+    //! time source
+    rvs::clock* clk;
+
+    //! actual training time
+    uint64_t training_time_ms;
+    //! actual ramp time
+    uint64_t ramp_actual_time;
+    //! number of SGEMMs that the GPU achieved during the training
+    uint64_t num_sgemms_training;
+    //! average GPU power during training
+    float avg_power_training;
+    //! the SGEMM delay which gives the actual GPU SGEMM frequency
+    float sgemm_si_delay;
+    //! SGEMM time measured during the training (ms)
+    float sgemm_time_ms;
+    //! training cache file path
+    std::string training_cache_path;
+    //! training cache key of the GPU
+    std::string training_key;
+    //! largest age (s) of a cached training result, 0 = no cache
+    uint64_t training_max_age;
+    //! TRUE if the ramp uses the duty cycle -> power fit
+    bool bramp_model;
+    //! duty cycle -> power fit of the ramp samples
+    rvs::linear_rls power_fit;
+    //! number of SGEMM delay changes during the ramp
+    uint64_t ramp_steps;
+
+    //! TRUE in burst mode
+    bool bburst;
+    //! burst mode schedule
+    blas_worker::burst_schedule burst_sched;
+    //! average GPU power before the first rising edge (W)
+    float burst_idle_power;
+    //! average GPU power of the on part of each burst cycle (W)
+    std::vector<float> burst_on_power;
+    //! average GPU power of the off part of each burst cycle (W)
+    std::vector<float> burst_off_power;
+};
+#endif  // IET_SO_INCLUDE_IET_WORKER_H_
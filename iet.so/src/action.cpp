@@ -0,0 +1,890 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <regex>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <map>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <pci/pci.h>
+#ifdef __cplusplus
+}
+#endif
+#include <dirent.h>
+
+#define __HIP_PLATFORM_HCC__
+#include "hip/hip_runtime.h"
+#include "hip/hip_runtime_api.h"
+
+#include "include/rvs_key_def.h"
+#include "include/iet_worker.h"
+#include "include/blas_worker.h"
+#include "include/rvs_rand.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvs_module.h"
+#include "include/rvsactionbase.h"
+#include "include/rvsloglp.h"
+#include "include/rsmi_util.h"
+#include "include/rvs_autotune.h"
+#include "include/rvs_barrier.h"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::regex;
+using std::fstream;
+
+#define RVS_CONF_TARGET_POWER_KEY       "target_power"
+#define RVS_CONF_RAMP_INTERVAL_KEY      "ramp_interval"
+#define RVS_CONF_TOLERANCE_KEY          "tolerance"
+#define RVS_CONF_MAX_VIOLATIONS_KEY     "max_violations"
+#define RVS_CONF_SAMPLE_INTERVAL_KEY    "sample_interval"
+#define RVS_CONF_LOG_INTERVAL_KEY       "log_interval"
+#define RVS_CONF_MATRIX_SIZE_KEY        "matrix_size"
+#define RVS_CONF_AUTOTUNE_KEY           "autotune"
+#define RVS_CONF_AUTOTUNE_CACHE_KEY     "autotune_cache"
+#define RVS_CONF_BACKEND_KEY            "backend"
+#define RVS_CONF_SIM_PEAK_GFLOPS_KEY    "sim_peak_gflops"
+#define RVS_CONF_SIM_IDLE_POWER_KEY     "sim_idle_power"
+#define RVS_CONF_SIM_MAX_POWER_KEY      "sim_max_power"
+#define RVS_CONF_PACING_SPIN_KEY        "pacing_spin"
+#define RVS_CONF_BURST_KEY              "burst"
+#define RVS_CONF_BURST_ON_KEY           "burst_on"
+#define RVS_CONF_BURST_OFF_KEY          "burst_off"
+#define RVS_CONF_BURST_EDGE_KEY         "burst_edge"
+#define RVS_CONF_TRAINING_CACHE_KEY     "training_cache"
+#define RVS_CONF_TRAINING_MAX_AGE_KEY   "training_max_age"
+#define RVS_CONF_RAMP_MODEL_KEY         "ramp_model"
+
+#define MODULE_NAME                     "iet"
+#define MODULE_NAME_CAPS                "IET"
+
+#define IET_DEFAULT_RAMP_INTERVAL       5000
+#define IET_DEFAULT_LOG_INTERVAL        1000
+#define IET_DEFAULT_MAX_VIOLATIONS      0
+#define IET_DEFAULT_TOLERANCE           0.1
+#define IET_DEFAULT_SAMPLE_INTERVAL     100
+
+#define IET_DEFAULT_MATRIX_SIZE         5760
+#define IET_DEFAULT_AUTOTUNE            false
+#define IET_DEFAULT_BACKEND             "hip"
+#define IET_DEFAULT_SIM_PEAK_GFLOPS     10000
+#define IET_DEFAULT_SIM_IDLE_POWER      40
+#define IET_DEFAULT_SIM_MAX_POWER       300
+#define IET_DEFAULT_PACING_SPIN         0
+#define IET_DEFAULT_BURST               false
+#define IET_DEFAULT_BURST_ON            100
+#define IET_DEFAULT_BURST_OFF           100
+#define IET_DEFAULT_BURST_EDGE          0
+#define IET_DEFAULT_TRAINING_MAX_AGE    0
+#define IET_DEFAULT_RAMP_MODEL          true
+
+#define IET_BURST_RISING_EDGE_MSG       "burst rising edge"
+#define IET_BURST_FALLING_EDGE_MSG      "burst falling edge"
+//! the IET BLAS workers run SGEMMs
+#define IET_AUTOTUNE_OPS_TYPE           "sgemm"
+
+#define RVS_DEFAULT_PARALLEL            false
+#define RVS_DEFAULT_DURATION            0
+
+#define IET_NO_COMPATIBLE_GPUS          "No AMD compatible GPU found!"
+#define PCI_ALLOC_ERROR                 "pci_alloc() error"
+
+#define FLOATING_POINT_REGEX            "^[0-9]*\\.?[0-9]+$"
+
+#define JSON_CREATE_NODE_ERROR          "JSON cannot create node"
+
+/**
+ * @brief default class constructor
+ */
+iet_action::iet_action() {
+}
+
+/**
+ * @brief class destructor
+ */
+iet_action::~iet_action() {
+    property.clear();
+}
+
+/**
+ * @brief reads all IET's related configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool iet_action::get_all_iet_config_keys(void) {
+    int error;
+    string msg, ststress;
+    bool bsts = true;
+
+    if (property_get(RVS_CONF_BURST_KEY, &iet_burst, IET_DEFAULT_BURST)) {
+      msg = "invalid '" + std::string(RVS_CONF_BURST_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    } else if (iet_burst && !property_parallel) {
+      // the GPUs can only step together if they run at the same time
+      msg = "'" + std::string(RVS_CONF_BURST_KEY) + "' requires '"
+      + std::string(RVS_CONF_PARALLEL_KEY) + ": true'";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    iet_target_power = 0;
+    if ((error =
+      property_get(RVS_CONF_TARGET_POWER_KEY, &iet_target_power)) &&
+      !(error == 2 && iet_burst)) {
+      switch (error) {
+        case 1:
+          msg = "invalid '" + std::string(RVS_CONF_TARGET_POWER_KEY) +
+              "' key value " + ststress;
+          rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+          break;
+
+        case 2:
+          msg = "key '" + std::string(RVS_CONF_TARGET_POWER_KEY) +
+          "' was not found";
+          rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      }
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_RAMP_INTERVAL_KEY,
+      &iet_ramp_interval, IET_DEFAULT_RAMP_INTERVAL)) {
+      msg = "invalid '" + std::string(RVS_CONF_RAMP_INTERVAL_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_LOG_INTERVAL_KEY,
+      &property_log_interval, IET_DEFAULT_LOG_INTERVAL)) {
+      msg = "invalid '" + std::string(RVS_CONF_LOG_INTERVAL_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_SAMPLE_INTERVAL_KEY,
+      &iet_sample_interval, IET_DEFAULT_SAMPLE_INTERVAL)) {
+      msg = "invalid '" + std::string(RVS_CONF_SAMPLE_INTERVAL_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<int>(RVS_CONF_MAX_VIOLATIONS_KEY,
+      &iet_max_violations, IET_DEFAULT_MAX_VIOLATIONS)) {
+      msg = "invalid '" + std::string(RVS_CONF_MAX_VIOLATIONS_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get<float>(RVS_CONF_TOLERANCE_KEY,
+      &iet_tolerance, IET_DEFAULT_TOLERANCE)) {
+      msg = "invalid '" + std::string(RVS_CONF_TOLERANCE_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_MATRIX_SIZE_KEY,
+      &iet_matrix_size, IET_DEFAULT_MATRIX_SIZE)) {
+      msg = "invalid '" + std::string(RVS_CONF_MATRIX_SIZE_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get(RVS_CONF_AUTOTUNE_KEY, &iet_autotune,
+      IET_DEFAULT_AUTOTUNE)) {
+      msg = "invalid '" + std::string(RVS_CONF_AUTOTUNE_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get<std::string>(RVS_CONF_AUTOTUNE_CACHE_KEY,
+      &iet_autotune_cache, RVS_AUTOTUNE_DEFAULT_CACHE) ||
+      iet_autotune_cache.empty()) {
+      msg = "invalid '" + std::string(RVS_CONF_AUTOTUNE_CACHE_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get<std::string>(RVS_CONF_BACKEND_KEY, &iet_backend,
+      IET_DEFAULT_BACKEND) ||
+      (iet_backend != "hip" && iet_backend != "sim")) {
+      msg = "invalid '" + std::string(RVS_CONF_BACKEND_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get<float>(RVS_CONF_SIM_PEAK_GFLOPS_KEY,
+      &iet_sim_peak_gflops, IET_DEFAULT_SIM_PEAK_GFLOPS) ||
+      iet_sim_peak_gflops <= 0) {
+      msg = "invalid '" + std::string(RVS_CONF_SIM_PEAK_GFLOPS_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get<float>(RVS_CONF_SIM_IDLE_POWER_KEY,
+      &iet_sim_idle_power, IET_DEFAULT_SIM_IDLE_POWER) ||
+      iet_sim_idle_power < 0) {
+      msg = "invalid '" + std::string(RVS_CONF_SIM_IDLE_POWER_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get<float>(RVS_CONF_SIM_MAX_POWER_KEY,
+      &iet_sim_max_power, IET_DEFAULT_SIM_MAX_POWER) ||
+      iet_sim_max_power <= iet_sim_idle_power) {
+      msg = "invalid '" + std::string(RVS_CONF_SIM_MAX_POWER_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_PACING_SPIN_KEY,
+      &iet_pacing_spin, IET_DEFAULT_PACING_SPIN)) {
+      msg = "invalid '" + std::string(RVS_CONF_PACING_SPIN_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_BURST_ON_KEY,
+      &iet_burst_on, IET_DEFAULT_BURST_ON) || iet_burst_on == 0) {
+      msg = "invalid '" + std::string(RVS_CONF_BURST_ON_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_BURST_OFF_KEY,
+      &iet_burst_off, IET_DEFAULT_BURST_OFF)) {
+      msg = "invalid '" + std::string(RVS_CONF_BURST_OFF_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (iet_burst && property_duration < iet_burst_on + iet_burst_off) {
+      msg = "'" + std::string(RVS_CONF_DURATION_KEY) + "' must cover at "
+      "least one burst cycle";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_BURST_EDGE_KEY,
+      &iet_burst_edge, IET_DEFAULT_BURST_EDGE) ||
+      iet_burst_edge > iet_burst_on) {
+      msg = "invalid '" + std::string(RVS_CONF_BURST_EDGE_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get<std::string>(RVS_CONF_TRAINING_CACHE_KEY,
+      &iet_training_cache, RVS_TRAINING_DEFAULT_CACHE) ||
+      iet_training_cache.empty()) {
+      msg = "invalid '" + std::string(RVS_CONF_TRAINING_CACHE_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get_int<uint64_t>(RVS_CONF_TRAINING_MAX_AGE_KEY,
+      &iet_training_max_age, IET_DEFAULT_TRAINING_MAX_AGE)) {
+      msg = "invalid '" + std::string(RVS_CONF_TRAINING_MAX_AGE_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    if (property_get(RVS_CONF_RAMP_MODEL_KEY, &iet_ramp_model,
+      IET_DEFAULT_RAMP_MODEL)) {
+      msg = "invalid '" + std::string(RVS_CONF_RAMP_MODEL_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    // a fresh seed is used for each action unless one is given
+    error = property_get_int<uint64_t>(RVS_CONF_SEED_KEY, &iet_seed);
+    if (error == 1) {
+      msg = "invalid '" + std::string(RVS_CONF_SEED_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    } else if (error == 2) {
+      iet_seed = rvs::rand::new_seed();
+    }
+
+    std::string str_gemm_wait;
+    error = property_get<std::string>(RVS_CONF_GEMM_WAIT_KEY, &str_gemm_wait,
+                                      "blocking-sync");
+    if (error == 1 || rvs_blas::str2gemm_wait(str_gemm_wait, &iet_gemm_wait)) {
+      msg = "invalid '" + std::string(RVS_CONF_GEMM_WAIT_KEY)
+      + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    return bsts;
+}
+
+/**
+ * @brief reads all common configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool iet_action::get_all_common_config_keys(void) {
+    string msg, sdevid, sdev;
+    int error;
+    bool bsts = true;
+
+    // get <device> property value (a list of gpu id)
+    if ((error = property_get_device())) {
+      switch (error) {
+      case 1:
+        msg = "Invalid 'device' key value.";
+        break;
+      case 2:
+        msg = "Missing 'device' key.";
+        break;
+      }
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    // get the <deviceid> property value if provided
+    if (property_get_int<uint16_t>(RVS_CONF_DEVICEID_KEY,
+                                  &property_device_id, 0u)) {
+      msg = "Invalid 'deviceid' key value.";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    // get the other action/IET related properties
+    if (property_get(RVS_CONF_PARALLEL_KEY, &property_parallel, false)) {
+      msg = "invalid '" +
+              std::string(RVS_CONF_PARALLEL_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    error = property_get_int<uint64_t>
+    (RVS_CONF_COUNT_KEY, &property_count, DEFAULT_COUNT);
+    if (error == 1) {
+      msg = "invalid '" +
+              std::string(RVS_CONF_COUNT_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    error = property_get_int<uint64_t>
+    (RVS_CONF_WAIT_KEY, &property_wait, DEFAULT_WAIT);
+    if (error == 1) {
+      msg = "invalid '" +
+              std::string(RVS_CONF_WAIT_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    error = property_get_int<uint64_t>
+    (RVS_CONF_DURATION_KEY, &property_duration);
+    if (error == 1) {
+      msg = "invalid '" +
+              std::string(RVS_CONF_DURATION_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+
+    return bsts;
+}
+
+/**
+ * @brief runs the edp test
+ * @return true if no error occured, false otherwise
+ */
+bool iet_action::do_edp_test(void) {
+    std::string msg;
+    size_t k = 0;
+    for (;;) {
+        unsigned int i = 0;
+        if (property_wait != 0)  // delay iet execution
+            sleep(property_wait);
+
+        vector<IETWorker> workers(edpp_gpus.size());
+        vector<gpu_hwmon_info>::iterator it;
+
+        // burst mode: all the workers step together
+        rvs::barrier burst_sync(edpp_gpus.size());
+        blas_worker::burst_schedule burst_sched;
+        burst_sched.sync = &burst_sync;
+        burst_sched.on_ms = iet_burst_on;
+        burst_sched.off_ms = iet_burst_off;
+        burst_sched.edge_ms = iet_burst_edge;
+        burst_sched.cycles = property_duration / (iet_burst_on + iet_burst_off);
+
+        // all worker instances have the same json settings
+        IETWorker::set_use_json(bjson);
+
+        rsmi_init(0);
+
+        for (it = edpp_gpus.begin(); it != edpp_gpus.end(); ++it) {
+            // set worker thread params
+            workers[i].set_name(action_name);
+            workers[i].set_gpu_id((*it).gpu_id);
+            workers[i].set_gpu_device_index((*it).hip_gpu_deviceid);
+            uint32_t dev_idx = i;
+            msg = std::string("BDF: ") + rvs::bdf2string((*it).bdf_id);
+            rvs::lp::Log(msg, rvs::logdebug);
+            if (iet_backend == "sim") {
+                rvs::sim_model model;
+                model.peak_gflops = iet_sim_peak_gflops;
+                model.idle_power = iet_sim_idle_power;
+                model.max_power = iet_sim_max_power;
+                model.seed = iet_seed;
+                workers[i].set_sim_backend(model);
+            } else if (RSMI_STATUS_SUCCESS !=
+                       rvs::rsmi_dev_ind_get((*it).bdf_id, &dev_idx)) {
+              rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+              rvs::lp::Err(std::string("rsmi device index not found"),
+                                       MODULE_NAME_CAPS, action_name);
+            }
+            rvs::lp::Log(std::string("dev_idx: ") + std::to_string(dev_idx),
+                         rvs::logdebug);
+
+            workers[i].set_pwr_device_id(dev_idx);
+            workers[i].set_run_wait_ms(property_wait);
+            workers[i].set_run_duration_ms(property_duration);
+            workers[i].set_ramp_interval(iet_ramp_interval);
+            workers[i].set_log_interval(property_log_interval);
+            workers[i].set_sample_interval(iet_sample_interval);
+            workers[i].set_max_violations(iet_max_violations);
+            workers[i].set_target_power(iet_target_power);
+            workers[i].set_tolerance(iet_tolerance);
+            workers[i].set_matrix_size(get_matrix_size(*it));
+            workers[i].set_gemm_wait(iet_gemm_wait);
+            workers[i].set_seed(iet_seed);
+            workers[i].set_pacing_spin(iet_pacing_spin);
+            workers[i].set_ramp_model(iet_ramp_model);
+            if (iet_training_max_age > 0)
+                workers[i].set_training_cache(iet_training_cache,
+                                              get_training_key(*it),
+                                              iet_training_max_age);
+            if (iet_burst)
+                workers[i].set_burst(burst_sched);
+            i++;
+        }
+
+
+        if (property_parallel) {
+            for (i = 0; i < edpp_gpus.size(); i++)
+                workers[i].start();
+
+            // join threads
+            for (i = 0; i < edpp_gpus.size(); i++)
+                workers[i].join();
+        } else {
+            for (i = 0; i < edpp_gpus.size(); i++) {
+                workers[i].start();
+                workers[i].join();
+
+                // check if stop signal was received
+                if (rvs::lp::Stopping()) {
+                    rsmi_shut_down();
+                    return false;
+                }
+            }
+        }
+
+        rsmi_shut_down();
+
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        if (iet_burst)
+            log_burst_edges(workers);
+
+        if (property_count != 0) {
+            k++;
+            if (k == property_count)
+                break;
+        }
+    }
+    return rvs::lp::Stopping() ? false : true;
+}
+
+/**
+ * @brief logs the board power (sum over the GPUs of the action) before and
+ * after each edge of the burst square wave
+ * @param workers the workers that ran the burst
+ */
+void iet_action::log_burst_edges(vector<IETWorker>& workers) {
+    size_t cycles = 0;
+    float before = 0, on, off;
+    string msg;
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        before += workers[i].get_burst_idle_power();
+        cycles = std::max(cycles, workers[i].get_burst_on_power().size());
+    }
+
+    for (size_t k = 0; k < cycles; k++) {
+        on = off = 0;
+        for (size_t i = 0; i < workers.size(); i++) {
+            if (k < workers[i].get_burst_on_power().size()) {
+                on += workers[i].get_burst_on_power()[k];
+                off += workers[i].get_burst_off_power()[k];
+            }
+        }
+
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                IET_BURST_RISING_EDGE_MSG + " " + std::to_string(k) +
+                " board power " + std::to_string(before) + " W -> " +
+                std::to_string(on) + " W";
+        rvs::lp::Log(msg, rvs::loginfo);
+        log_burst_edge(IET_BURST_RISING_EDGE_MSG, k, before, on);
+
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                IET_BURST_FALLING_EDGE_MSG + " " + std::to_string(k) +
+                " board power " + std::to_string(on) + " W -> " +
+                std::to_string(off) + " W";
+        rvs::lp::Log(msg, rvs::loginfo);
+        log_burst_edge(IET_BURST_FALLING_EDGE_MSG, k, on, off);
+
+        before = off;
+    }
+}
+
+/**
+ * @brief logs one burst edge to JSON
+ * @param key edge type (rising/falling)
+ * @param cycle burst cycle of the edge
+ * @param power_before board power before the edge (W)
+ * @param power_after board power after the edge (W)
+ */
+void iet_action::log_burst_edge(const char* key, size_t cycle,
+                                float power_before, float power_after) {
+    if (!bjson)
+        return;
+
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void *json_node = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::loginfo, sec, usec);
+    if (!json_node) {
+        rvs::lp::Err(JSON_CREATE_NODE_ERROR, MODULE_NAME_CAPS, action_name);
+        return;
+    }
+    rvs::lp::AddString(json_node, key, std::to_string(cycle));
+    rvs::lp::AddString(json_node, "board power before",
+                       std::to_string(power_before));
+    rvs::lp::AddString(json_node, "board power after",
+                       std::to_string(power_after));
+    rvs::lp::LogRecordFlush(json_node);
+}
+
+/**
+ * @brief returns the SGEMM matrix size of a GPU: the size found by a GST
+ * autotune run on the same device/VBIOS/ROCm if autotune is set and the
+ * cache has it, the matrix_size key otherwise
+ * @param gpu_info GPU identification data
+ * @return matrix size
+ */
+uint64_t iet_action::get_matrix_size(const gpu_hwmon_info& gpu_info) {
+    if (!iet_autotune)
+        return iet_matrix_size;
+
+    rvs::autotune_cache cache(iet_autotune_cache);
+    rvs::gemm_shape shape;
+    string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                 std::to_string(gpu_info.gpu_id) + " autotune ";
+    string key = iet_backend == "sim" ?
+        rvs::autotune_cache::make_key(IET_AUTOTUNE_OPS_TYPE, gpu_info.gpu_id,
+                                      "sim", "sim") :
+        rvs::autotune_cache::device_key(IET_AUTOTUNE_OPS_TYPE,
+                                        gpu_info.gpu_id,
+                                        gpu_info.hip_gpu_deviceid);
+    if (!cache.lookup(key, &shape)) {
+        // IET does not sweep (it would disturb the power ramp), a GST
+        // action with autotune has to run first
+        msg += "no cached result, matrix_size " +
+               std::to_string(iet_matrix_size);
+        rvs::lp::Log(msg, rvs::loginfo);
+        return iet_matrix_size;
+    }
+
+    // the IET SGEMMs are square
+    msg += "cached matrix_size " + std::to_string(shape.m);
+    rvs::lp::Log(msg, rvs::loginfo);
+    return shape.m;
+}
+
+/**
+ * @brief returns the training cache key of a GPU: besides the device, VBIOS
+ * and ROCm version of the autotune key it holds the amdgpu driver version
+ * and the GPU ID (two boards of the same kind do not draw the same power)
+ * @param gpu_info GPU identification data
+ * @return training cache key
+ */
+string iet_action::get_training_key(const gpu_hwmon_info& gpu_info) {
+    if (iet_backend == "sim")
+        return rvs::autotune_cache::make_key(IET_AUTOTUNE_OPS_TYPE,
+                                             gpu_info.gpu_id, "sim", "sim") +
+               "/sim/" + std::to_string(gpu_info.gpu_id);
+
+    return rvs::autotune_cache::device_key(IET_AUTOTUNE_OPS_TYPE,
+                                           gpu_info.gpu_id,
+                                           gpu_info.hip_gpu_deviceid) + "/" +
+           rvs::autotune_cache::read_driver_version() + "/" +
+           std::to_string(gpu_info.gpu_id);
+}
+
+/**
+ * @brief gets the number of ROCm compatible AMD GPUs
+ * @return run number of GPUs
+ */
+int iet_action::get_num_amd_gpu_devices(void) {
+    int hip_num_gpu_devices;
+    string msg;
+
+    hipGetDeviceCount(&hip_num_gpu_devices);
+    return hip_num_gpu_devices;
+}
+
+/**
+ * @brief retrieves the GPU identification data  and adds it to the list of 
+ * those that will run the EDPp test
+ * @param dev_location_id GPU device location ID
+ * @param gpu_id GPU's ID as exported by KFD
+ * @param hip_num_gpu_devices number of GPU devices (as reported by HIP API)
+ * @return true if all info could be retrieved and the gpu was successfully to
+ * the EDPp test list, false otherwise
+ */
+bool iet_action::add_gpu_to_edpp_list(uint16_t dev_location_id, int32_t gpu_id,
+                                  int hip_num_gpu_devices) {
+    for (int i = 0; i < hip_num_gpu_devices; i++) {
+        // get GPU device properties
+        hipDeviceProp_t props;
+        hipGetDeviceProperties(&props, i);
+
+        // compute device location_id (needed to match this device
+        // with one of those found while querying the pci bus
+        uint16_t hip_dev_location_id =
+                ((((uint16_t) (props.pciBusID)) << 8) | (props.pciDeviceID));
+        if (hip_dev_location_id == dev_location_id) {
+            gpu_hwmon_info cgpu_info;
+            cgpu_info.hip_gpu_deviceid = i;
+            cgpu_info.gpu_id = gpu_id;
+            cgpu_info.bdf_id = hip_dev_location_id;
+            edpp_gpus.push_back(cgpu_info);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief gets all selected GPUs and starts the worker threads
+ * @return run result
+ */
+int iet_action::get_all_selected_gpus(void) {
+    string msg;
+    bool amd_gpus_found = false;
+    int hip_num_gpu_devices;
+    struct pci_access *pacc;
+    struct pci_dev *pci_cdev;
+
+    hip_num_gpu_devices = get_num_amd_gpu_devices();
+    if (hip_num_gpu_devices == 0)
+        return 0;  // no AMD compatible GPU found!
+
+    // get the pci_access structure
+    pacc = pci_alloc();
+
+    if (pacc == NULL) {
+        // log the error
+        msg = std::string(PCI_ALLOC_ERROR);
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+
+        return -1;  // EDPp test cannot continue
+    }
+
+    // initialize the PCI library
+    pci_init(pacc);
+    // get the list of devices
+    pci_scan_bus(pacc);
+
+    // iterate over devices
+    for (pci_cdev = pacc->devices; pci_cdev; pci_cdev = pci_cdev->next) {
+        // fill in the info
+        pci_fill_info(pci_cdev,
+                PCI_FILL_IDENT | PCI_FILL_BASES | PCI_FILL_CLASS);
+
+        // computes the actual dev's location_id (sysfs entry)
+        uint16_t dev_location_id = ((((uint16_t) (pci_cdev->bus)) << 8)
+                | (pci_cdev->dev));
+
+        // check if this pci_dev corresponds to one of the AMD GPUs
+        uint16_t gpu_id;
+        // if not and AMD GPU just continue
+        if (rvs::gpulist::location2gpu(dev_location_id, &gpu_id))
+          continue;
+
+        // that should be an AMD GPU
+        // check for deviceid filtering
+        if (property_device_id > 0) {
+          if (pci_cdev->device_id != property_device_id) {
+            continue;
+          }
+        }
+
+        // check if the GPU is part of the EDPp test  (either <device>: all
+        // or the gpu_id is in the device: <gpu id> list)
+        bool cur_gpu_selected = false;
+
+        if (property_device_all) {
+            cur_gpu_selected = true;
+        } else {
+            // search for this gpu in the list
+            // provided under the <device> property
+            auto it_gpu_id = find(property_device.begin(),
+                                  property_device.end(),
+                                  gpu_id);
+
+            if (it_gpu_id != property_device.end())
+                cur_gpu_selected = true;
+        }
+
+        if (cur_gpu_selected) {
+            if (add_gpu_to_edpp_list(dev_location_id, gpu_id,
+              hip_num_gpu_devices))
+                amd_gpus_found = true;
+        }
+    }
+
+    pci_cleanup(pacc);
+
+    if (amd_gpus_found) {
+        if (do_edp_test())
+            return 0;
+        return -1;
+    } else {
+      msg = "No devices match criteria from the test configuation.";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief starts the worker threads on simulated GPUs (backend: sim); no
+ * GPU is needed, the GPU IDs come from the <device> list (a single GPU 0
+ * for device: all)
+ * @return run result
+ */
+int iet_action::get_all_sim_gpus(void) {
+    gpu_hwmon_info cgpu_info;
+
+    cgpu_info.bdf_id = 0;
+    if (property_device_all) {
+        cgpu_info.hip_gpu_deviceid = 0;
+        cgpu_info.gpu_id = 0;
+        edpp_gpus.push_back(cgpu_info);
+    } else {
+        for (size_t i = 0; i < property_device.size(); i++) {
+            cgpu_info.hip_gpu_deviceid = i;
+            cgpu_info.gpu_id = property_device[i];
+            edpp_gpus.push_back(cgpu_info);
+        }
+    }
+
+    if (edpp_gpus.empty()) {
+        rvs::lp::Err("No devices match criteria from the test configuation.",
+                     MODULE_NAME_CAPS, action_name);
+        return -1;
+    }
+    return do_edp_test() ? 0 : -1;
+}
+
+/**
+ * @brief runs the whole IET logic
+ * @return run result
+ */
+int iet_action::run(void) {
+    string msg;
+
+    // get the action name
+    if (property_get(RVS_CONF_NAME_KEY, &action_name)) {
+      rvs::lp::Err("Action name missing", MODULE_NAME_CAPS);
+      return -1;
+    }
+
+    // check for -j flag (json logging)
+    if (property.find("cli.-j") != property.end())
+        bjson = true;
+
+    if (!get_all_common_config_keys())
+        return -1;
+
+    if (!get_all_iet_config_keys())
+        return -1;
+
+    if (property_duration > 0 && (property_duration < iet_ramp_interval)) {
+        msg = std::string(RVS_CONF_DURATION_KEY) + "' cannot be less than '" +
+        RVS_CONF_RAMP_INTERVAL_KEY + "'";
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+    }
+
+    if (iet_backend == "sim")
+        return get_all_sim_gpus();
+    return get_all_selected_gpus();
+}
@@ -0,0 +1,434 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/blas_worker.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <mutex>
+
+#include "include/rvs_barrier.h"
+#include "include/rvs_blas.h"
+#include "include/rvs_pacer.h"
+#include "include/rvsloglp.h"
+
+#define IET_MEM_ALLOC_ERROR                     1
+#define IET_BLAS_ERROR                          2
+#define IET_BLAS_MEMCPY_ERROR                   3
+#define MODULE_NAME "IET"
+
+//! time between the burst workers meeting and the first rising edge, so that
+//! all of them are awake and waiting for it
+#define IET_BURST_LEAD_MS                       50
+//! number of duty cycle steps of a rising edge (burst mode)
+#define IET_BURST_EDGE_STEPS                    10
+
+using std::string;
+
+/**
+ * @brief default class constructor
+ * @param _gpu_device_index index of the gpu that will run the GEMM
+ * @param _matrix_size size of SGEMM m atrices
+ */
+blas_worker::blas_worker(int _gpu_device_index, uint64_t _matrix_size) :
+                            gpu_device_index(_gpu_device_index),
+                            matrix_size(_matrix_size) {
+    bcount_sgemm = false;
+    sgemm_delay = 0;
+    sgemm_time = 0;
+    launch_period = 0;
+    pacing_spin = 0;
+    num_launches = 0;
+    launch_requested_ns = 0;
+    launch_actual_ns = 0;
+    bburst = false;
+    burst_epoch = 0;
+    burst_cycles_done = 0;
+    blas_error = 0;
+    setup_finished = false;
+    gemm_wait = rvs_blas::GEMM_WAIT_BLOCKING_SYNC;
+    seed = 0;
+    sim_dev = nullptr;
+    clk = rvs::clock::real();
+}
+
+blas_worker::~blas_worker() {}
+
+/**
+ * @brief performs the rvsBlas setup
+ */
+void blas_worker::setup_blas(void) {
+    blas_error = 0;
+    // setup rvsBlas
+    if (sim_dev)
+        gpu_blas = std::unique_ptr<rvs_blas>(
+            new rvs_blas_sim(sim_dev, matrix_size, matrix_size, matrix_size,
+                             "sgemm"));
+    else
+        gpu_blas = std::unique_ptr<rvs_blas>(
+            new rvs_blas(gpu_device_index, matrix_size, matrix_size,
+                         matrix_size, "sgemm"));
+
+    // no lock guard for blas_error atm because there are no sync issues
+    if (gpu_blas == nullptr) {
+        blas_error = IET_MEM_ALLOC_ERROR;
+        set_setup_complete();
+        return;
+    }
+
+    if (gpu_blas->error()) {
+        blas_error = IET_BLAS_ERROR;
+        set_setup_complete();
+        return;
+    }
+
+    gpu_blas->set_gemm_wait(gemm_wait);
+
+    // generate random matrix & copy it to the GPU
+    gpu_blas->generate_random_matrix_data(seed);
+    if (!gpu_blas->copy_data_to_gpu()) {
+        blas_error = IET_BLAS_MEMCPY_ERROR;
+        set_setup_complete();
+        return;
+    }
+
+    set_setup_complete();
+}
+
+/**
+ * @brief marks the BLAS setup as completed
+ */
+void blas_worker::set_setup_complete(void) {
+    std::lock_guard<std::mutex> lck(mtx_blas_setup);
+    setup_finished = true;
+}
+
+/**
+ * @brief checks for BLAS setup completeness
+ * @return true if BLAS setup finished, false otherwise
+ */
+bool blas_worker::is_setup_complete(void) {
+    std::lock_guard<std::mutex> lck(mtx_blas_setup);
+    return setup_finished;
+}
+
+/**
+ * @brief checks for SGEMM completeness
+ * @return true if last SGEMM finished, false otherwise
+ */
+bool blas_worker::is_sgemm_complete(void) {
+    std::lock_guard<std::mutex> lck(mtx_bsgemm_done);
+    return sgemm_done;
+}
+
+/**
+ * @brief sets the brun flag to false (signal the thread to stop)
+ */
+void blas_worker::stop(void) {
+    std::lock_guard<std::mutex> lck(mtx_brun);
+    brun = false;
+}
+
+/**
+ * @brief returns the total number of SGEMM that the thread managed to run
+ * @return SGEMMs number
+ */
+uint64_t blas_worker::get_num_sgemm_ops(void) {
+    std::lock_guard<std::mutex> lck(mtx_num_sgemm);
+    return num_sgemm_ops;
+}
+
+/**
+ * @brief sets whether SGEMM counting is needed or not
+ * @param _bcount_sgemm true if SGEMM ops counting is needed, false otherwise
+ */
+void blas_worker::set_bcount_sgemm(bool _bcount_sgemm) {
+    std::lock_guard<std::mutex> lck(mtx_bcount_sgemm);
+    bcount_sgemm = _bcount_sgemm;
+}
+
+/**
+ * @brief checks for the SGEMM-counter active-flag status 
+ * @return true if BLAS was setup to count the SGEMM ops, false otherwise
+ */
+bool blas_worker::get_bcount_sgemm(void) {
+    std::lock_guard<std::mutex> lck(mtx_bcount_sgemm);
+    return bcount_sgemm;
+}
+
+/**
+ * @brief sets the SGEMM delay(frequency)
+ * @param _sgemm_delay SGEMM delay
+ */
+void blas_worker::set_sgemm_delay(uint64_t _sgemm_delay) {
+    std::lock_guard<std::mutex> lck(mtx_sgemm_delay);
+    sgemm_delay = _sgemm_delay;
+    launch_period = sgemm_delay ? sgemm_time + sgemm_delay : 0;
+}
+
+/**
+ * @brief sets the expected SGEMM time, which the delay is added to
+ * @param _sgemm_time SGEMM time (us)
+ */
+void blas_worker::set_sgemm_time(uint64_t _sgemm_time) {
+    std::lock_guard<std::mutex> lck(mtx_sgemm_delay);
+    sgemm_time = _sgemm_time;
+    launch_period = sgemm_delay ? sgemm_time + sgemm_delay : 0;
+}
+
+/**
+ * @brief sets the SGEMM time and delay at once, so the running worker never
+ * launches with one of them updated and not the other
+ * @param _sgemm_time SGEMM time (us)
+ * @param _sgemm_delay SGEMM delay (us)
+ */
+void blas_worker::set_pacing(uint64_t _sgemm_time, uint64_t _sgemm_delay) {
+    std::lock_guard<std::mutex> lck(mtx_sgemm_delay);
+    sgemm_time = _sgemm_time;
+    sgemm_delay = _sgemm_delay;
+    launch_period = sgemm_delay ? sgemm_time + sgemm_delay : 0;
+}
+
+/**
+ * @brief returns the time between two SGEMM launches
+ * @return launch period (us), 0 if the SGEMMs run back to back
+ */
+uint64_t blas_worker::get_launch_period(void) {
+    return launch_period.load();
+}
+
+/**
+ * @brief restarts the launch rate statistics
+ */
+void blas_worker::reset_launch_stats(void) {
+    std::lock_guard<std::mutex> lck(mtx_launch_stats);
+    num_launches = 0;
+    launch_requested_ns = 0;
+    launch_actual_ns = 0;
+}
+
+/**
+ * @brief returns the requested and achieved SGEMM launch rates since
+ * reset_launch_stats() (time not paced excluded)
+ * @param requested_hz requested launch rate (0 if no paced launch yet)
+ * @param achieved_hz achieved launch rate (0 if no paced launch yet)
+ */
+void blas_worker::get_launch_rate(double *requested_hz, double *achieved_hz) {
+    std::lock_guard<std::mutex> lck(mtx_launch_stats);
+    *requested_hz = launch_requested_ns ?
+                        num_launches * 1e9 / launch_requested_ns : 0;
+    *achieved_hz = launch_actual_ns ?
+                        num_launches * 1e9 / launch_actual_ns : 0;
+}
+
+/**
+ * @brief returns the current SGEMM delay
+ * @return SGEMM delay
+ */
+uint64_t blas_worker::get_sgemm_delay(void) {
+    std::lock_guard<std::mutex> lck(mtx_sgemm_delay);
+    return sgemm_delay;
+}
+
+/**
+ * @brief performs SGEMMs on the selected GPU with a given frequency
+ */
+void blas_worker::run() {
+    setup_blas();
+    if (blas_error) {
+        // the other burst workers must not wait for this one
+        if (bburst)
+            burst.sync->leave();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(mtx_brun);
+        brun = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(mtx_num_sgemm);
+        num_sgemm_ops = 0;
+    }
+
+    if (bburst) {
+        run_burst();
+        return;
+    }
+
+    rvs::pacer pace(clk);
+    pace.set_spin(pacing_spin * 1000);
+    uint64_t period, launch, prev_launch = 0;
+
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lck(mtx_brun);
+            if (!brun)
+                break;
+        }
+
+        // wait for the launch deadline; a new period published meanwhile
+        // applies from the next launch on
+        period = get_launch_period();
+        if (period == 0) {
+            prev_launch = 0;
+        } else {
+            if (prev_launch == 0)
+                pace.start();
+            pace.wait_next(period / 1000.0);
+
+            launch = clk->now_ns();
+            if (prev_launch != 0) {
+                std::lock_guard<std::mutex> lck(mtx_launch_stats);
+                num_launches++;
+                launch_requested_ns += period * 1000;
+                launch_actual_ns += launch - prev_launch;
+            }
+            prev_launch = launch;
+        }
+
+        run_sgemm();
+
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            break;
+    }
+}
+
+/**
+ * @brief runs one SGEMM and waits for its completion (the wait does not keep
+ * a host core busy, which would otherwise skew the measured power)
+ * @return true if the SGEMM succeeded, false otherwise
+ */
+bool blas_worker::run_sgemm(void) {
+    {
+        std::lock_guard<std::mutex> lck(mtx_bsgemm_done);
+        sgemm_done = false;
+    }
+
+    bool sgemm_success = gpu_blas->run_blass_gemm() &&
+                            gpu_blas->wait_gemm_op_complete();
+
+    {
+        std::lock_guard<std::mutex> lck(mtx_bsgemm_done);
+        sgemm_done = true;
+    }
+
+    // increase number of SGEMM ops
+    if (sgemm_success) {
+        std::lock_guard<std::mutex> lck(mtx_bcount_sgemm);
+        if (bcount_sgemm) {
+            // lock_guard [num_sgemm_ops]
+            std::lock_guard<std::mutex> lck(mtx_num_sgemm);
+            num_sgemm_ops++;
+        }
+    }
+
+    return sgemm_success;
+}
+
+/**
+ * @brief checks whether the worker has to go on
+ * @return false if the worker was stopped, true otherwise
+ */
+bool blas_worker::is_running(void) {
+    if (rvs::lp::Stopping())
+        return false;
+    std::lock_guard<std::mutex> lck(mtx_brun);
+    return brun;
+}
+
+/**
+ * @brief sleeps until the given time, polling the clock for the last
+ * pacing_spin us
+ * @param deadline_ns wake-up time (ns, on clk)
+ */
+void blas_worker::wait_until(uint64_t deadline_ns) {
+    uint64_t spin_ns = pacing_spin * 1000, now = clk->now_ns();
+
+    if (deadline_ns <= now)
+        return;
+    if (deadline_ns - now > spin_ns)
+        clk->sleep_until_ns(deadline_ns - spin_ns);
+    if (spin_ns > 0)
+        clk->spin_until_ns(deadline_ns);
+}
+
+/**
+ * @brief burst mode: full load during the on part of each cycle, idle during
+ * the off part, with the rising edges of all the workers sharing the barrier
+ * at the same instant
+ *
+ * The workers meet at the barrier once their SGEMM is staged (matrices on
+ * the GPU, one SGEMM already run) and take the release time plus
+ * IET_BURST_LEAD_MS as the first rising edge; the next ones follow on
+ * absolute deadlines. Before each cycle the workers meet again, so none
+ * starts a cycle while another is still busy with the previous one.
+ */
+void blas_worker::run_burst(void) {
+    const uint64_t on_ns = burst.on_ms * 1000000ull;
+    const uint64_t period_ns = (burst.on_ms + burst.off_ms) * 1000000ull;
+    const uint64_t edge_ns = burst.edge_ms * 1000000ull;
+    uint64_t epoch, rise, fall, now, done;
+    double duty;
+
+    // stage: the first launch pays for the kernel load, keep it out of
+    // the burst
+    run_sgemm();
+
+    epoch = burst.sync->wait() + IET_BURST_LEAD_MS * 1000000ull;
+    burst_epoch = epoch;
+
+    for (uint64_t k = 0; k < burst.cycles && is_running(); k++) {
+        if (k > 0)
+            burst.sync->wait();
+
+        rise = epoch + k * period_ns;
+        fall = rise + on_ns;
+        wait_until(rise);
+
+        while ((now = clk->now_ns()) < fall) {
+            if (!run_sgemm() || !is_running())
+                break;
+            if (edge_ns == 0 || now >= rise + edge_ns)
+                continue;
+
+            // rising edge: the duty cycle goes up in IET_BURST_EDGE_STEPS
+            // steps, the idle time after each SGEMM keeping it on target
+            done = clk->now_ns();
+            duty = static_cast<double>(
+                (done - rise) * IET_BURST_EDGE_STEPS / edge_ns + 1) /
+                IET_BURST_EDGE_STEPS;
+            if (duty < 1)
+                wait_until(std::min(fall, done + static_cast<uint64_t>(
+                    (done - now) * (1 - duty) / duty)));
+        }
+        burst_cycles_done++;
+    }
+
+    burst.sync->leave();
+}
@@ -0,0 +1,893 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/iet_worker.h"
+
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "include/blas_worker.h"
+#include "include/log_worker.h"
+#include "include/rvs_autotune.h"
+#include "include/rvs_module.h"
+#include "include/rvs_pacer.h"
+#include "include/rvsloglp.h"
+
+#define MODULE_NAME                             "iet"
+#define POWER_PROCESS_DELAY                     5
+#define MAX_MS_TRAIN_GPU                        1000
+#define MAX_MS_WAIT_BLAS_THREAD                 (1000 * 100)
+#define SGEMM_DELAY_FREQ_DEV                    10
+//! forgetting factor of the ramp's duty cycle -> power fit
+#define IET_RAMP_FIT_FORGETTING                 0.7
+//! smallest duty cycle the ramp's power model may ask for
+#define IET_RAMP_MIN_DUTY                       0.01
+//! the ramp's power model ignores the first 1/IET_RAMP_SETTLE_DIV of each
+//! sample_interval
+#define IET_RAMP_SETTLE_DIV                     2
+//! length of the probe that validates a cached training result (ms)
+#define IET_TRAINING_PROBE_MS                   200
+//! largest relative SGEMM time difference between the probe and the cached
+//! training result
+#define IET_TRAINING_PROBE_TOLERANCE            0.1
+//! power sampling period of the burst mode (ms)
+#define IET_BURST_SAMPLE_MS                     10
+
+#define IET_RESULT_PASS_MESSAGE                 "TRUE"
+#define IET_RESULT_FAIL_MESSAGE                 "FALSE"
+
+#define IET_BLAS_FAILURE                        "BLAS setup failed!"
+#define IET_MEM_ALLOC_ERROR                     "memory allocation error!"
+#define IET_POWER_PROC_ERROR                    "could not get/process the GPU"\
+                                                " power!"
+#define IET_SGEMM_FAILURE                       "GPU failed to run the SGEMMs!"
+
+#define IET_PWR_VIOLATION_MSG                   "power violation"
+#define IET_PWR_TARGET_ACHIEVED_MSG             "target achieved"
+#define IET_PWR_RAMP_EXCEEDED_MSG               "ramp time exceeded"
+#define IET_LAUNCH_RATE_MSG                     "sgemm launch rate"
+#define IET_REQUESTED_LAUNCH_RATE_MSG           "requested sgemm launch rate"
+#define IET_BURST_CYCLES_MSG                    "burst cycles"
+#define IET_TRAINING_CACHE_MSG                  "training cache"
+#define IET_CONVERGENCE_TIME_MSG                "convergence time"
+#define IET_RAMP_STEPS_MSG                      "ramp steps"
+#define IET_STEADY_STATE_ERROR_MSG              "steady state error"
+#define IET_PASS_KEY                            "pass"
+
+#define IET_JSON_LOG_GPU_ID_KEY                 "gpu_id"
+
+using std::string;
+
+bool IETWorker::bjson = false;
+
+/**
+ * @brief computes the difference (in milliseconds) between 2 points in time
+ * @param t_end second point in time (ms, as returned by clk->now_ms())
+ * @param t_start first point in time (ms)
+ * @return time difference in milliseconds
+ */
+static uint64_t time_diff(uint64_t t_end, uint64_t t_start) {
+    return t_end > t_start ? t_end - t_start : 0;
+}
+
+/**
+ * @brief class default constructor
+ */
+IETWorker::IETWorker() {
+    gpu_worker = nullptr;
+    pwr_log_worker = nullptr;
+    gemm_wait = rvs_blas::GEMM_WAIT_BLOCKING_SYNC;
+    seed = 0;
+    pacing_spin = 0;
+    sgemm_time_ms = 0;
+    bburst = false;
+    burst_idle_power = 0;
+    training_max_age = 0;
+    bramp_model = true;
+    ramp_steps = 0;
+    power_fit = rvs::linear_rls(IET_RAMP_FIT_FORGETTING);
+    pwr_reader = rvs::power_reader::rsmi();
+    clk = rvs::clock::real();
+}
+
+IETWorker::~IETWorker() {}
+
+/**
+ * @brief selects the simulated backend: the SGEMMs run on a rvs::sim_device
+ * and the power readings come from its model
+ *
+ * The BLAS, logging and control threads share the device, so it runs in
+ * real time (a virtual clock is only deterministic with a single thread).
+ *
+ * @param model performance/power model of the simulated device
+ */
+void IETWorker::set_sim_backend(const rvs::sim_model& model) {
+    sim_dev.reset(new rvs::sim_device(model, clk));
+    pwr_reader = sim_dev.get();
+}
+
+/**
+ * @brief logs a message to JSON
+ * @param key info type
+ * @param value message to log
+ * @param log_level the level of log (e.g.: info, results, error)
+ */
+void IETWorker::log_to_json(const std::string &key, const std::string &value,
+                     int log_level) {
+    if (IETWorker::bjson) {
+        unsigned int sec;
+        unsigned int usec;
+
+        rvs::lp::get_ticks(&sec, &usec);
+        void *json_node = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), log_level, sec, usec);
+        if (json_node) {
+            rvs::lp::AddString(json_node, IET_JSON_LOG_GPU_ID_KEY,
+                            std::to_string(gpu_id));
+            rvs::lp::AddString(json_node, key, value);
+            rvs::lp::LogRecordFlush(json_node);
+        }
+    }
+}
+
+/**
+ * @brief performs the EDPp rampup on the given GPU (attempts to reach the given
+ * target power)
+ * @param err_description stores the error description if any
+ * @return true if gpu training succeeded, false otherwise
+ */
+bool IETWorker::do_gpu_init_training(string *err_description) {
+    // init with no error
+    *err_description = "";
+
+    if (!start_gpu_worker(err_description))
+        return false;
+
+    if (training_max_age > 0) {
+        if (use_cached_training(err_description))
+            return true;
+        if (!err_description->empty())
+            return false;
+    }
+
+    // let the GPU run SGEMMs for MAX_MS_TRAIN_GPU ms (e.g.: 1000) and:
+    // 1. get the number of SGEMMs the GPU managed to run (needed in order
+    // to detect/change the SGEMMs frequency)
+    // 2. get the max power
+    if (!run_training(MAX_MS_TRAIN_GPU, err_description))
+        return false;
+
+    if (training_max_age > 0) {
+        rvs::training_cache cache(training_cache_path);
+        rvs::training_result result;
+        result.matrix_size = matrix_size;
+        result.ms_per_sgemm =
+                static_cast<double>(training_time_ms) / num_sgemms_training;
+        result.avg_power = avg_power_training;
+        result.timestamp = time(nullptr);
+        if (!cache.store(training_key, result))
+            log_training_cache("could not update " + training_cache_path);
+    }
+    return true;
+}
+
+/**
+ * @brief logs the outcome of the training cache lookup
+ * @param status what happened
+ */
+void IETWorker::log_training_cache(const string& status) {
+    string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                    std::to_string(gpu_id) + " " + IET_TRAINING_CACHE_MSG +
+                    ": " + status;
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(IET_TRAINING_CACHE_MSG, status, rvs::loginfo);
+}
+
+/**
+ * @brief takes the training result from the cache if there is one for this
+ * GPU, recent enough, and a short probe still finds the same SGEMM time
+ * @param err_description stores the error description if any
+ * @return true if the cached result is used, false otherwise
+ */
+bool IETWorker::use_cached_training(string *err_description) {
+    rvs::training_cache cache(training_cache_path);
+    rvs::training_result cached;
+    uint64_t now = time(nullptr);
+
+    if (!cache.lookup(training_key, &cached) ||
+        cached.matrix_size != matrix_size) {
+        log_training_cache("no result for " + training_key);
+        return false;
+    }
+    if (now < cached.timestamp || now - cached.timestamp > training_max_age) {
+        log_training_cache("result expired");
+        return false;
+    }
+
+    // the SGEMM time is quick to measure (unlike the power, which needs the
+    // GPU to heat up): a different one means the GPU or its settings changed
+    if (!run_training(IET_TRAINING_PROBE_MS, err_description))
+        return false;
+    double probe_ms = static_cast<double>(training_time_ms) /
+                        num_sgemms_training;
+    if (fabs(probe_ms - cached.ms_per_sgemm) >
+                    IET_TRAINING_PROBE_TOLERANCE * cached.ms_per_sgemm) {
+        log_training_cache("probe mismatch (" + std::to_string(probe_ms) +
+                           " ms per SGEMM, cached " +
+                           std::to_string(cached.ms_per_sgemm) + ")");
+        return false;
+    }
+
+    avg_power_training = cached.avg_power;
+    log_training_cache("cached result used (" +
+                       std::to_string(cached.avg_power) + " W)");
+    return true;
+}
+
+/**
+ * @brief runs SGEMMs back to back for the given time and measures the SGEMM
+ * count and the average GPU power
+ * @param window_ms training time (ms)
+ * @param err_description stores the error description if any
+ * @return true if the training succeeded, false otherwise
+ */
+bool IETWorker::run_training(uint64_t window_ms, string *err_description) {
+    uint64_t start_time, end_time, start_sgemms;
+    float cur_power_value;
+    uint64_t power_sampling_iters = 0, last_avg_power;
+
+    num_sgemms_training = 0;
+    avg_power_training = 0;
+
+    // record inital time
+    start_sgemms = gpu_worker->get_num_sgemm_ops();
+    start_time = clk->now_ms();
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        // get power data
+        if (pwr_reader->read_power_uw(pwr_device_id, &last_avg_power)) {
+            cur_power_value = static_cast<float>(last_avg_power)/1e6;
+            avg_power_training += cur_power_value;
+            power_sampling_iters++;
+        }
+        clk->sleep_for_ns(POWER_PROCESS_DELAY * 1000);
+
+        end_time = clk->now_ms();
+        uint64_t diff_ms = time_diff(end_time, start_time);
+        if (diff_ms >= window_ms) {
+            // wait for the last sgemm to finish (the worker starts the next
+            // one right away, so the SGEMM count is what tells)
+            uint64_t num_sgemms = gpu_worker->get_num_sgemm_ops();
+            while (!gpu_worker->is_sgemm_complete() &&
+                   gpu_worker->get_num_sgemm_ops() == num_sgemms &&
+                   !rvs::lp::Stopping())
+                std::this_thread::yield();
+            // record the actual training time
+            end_time = clk->now_ms();
+            training_time_ms = time_diff(end_time, start_time);
+            // stop the training
+            break;
+        }
+    }
+
+    // gather the GPUS stats
+    num_sgemms_training = gpu_worker->get_num_sgemm_ops() - start_sgemms;
+    if (num_sgemms_training  == 0) {
+        *err_description = IET_SGEMM_FAILURE;
+        return false;
+    }
+
+    if (power_sampling_iters != 0) {
+        avg_power_training /= power_sampling_iters;
+        if (avg_power_training > 0)
+            return true;
+
+        *err_description = IET_POWER_PROC_ERROR;
+        return false;
+    }
+
+    *err_description = IET_POWER_PROC_ERROR;
+    return false;
+}
+
+/**
+ * @brief creates the BLAS worker, starts it and waits for its BLAS setup
+ * @param err_description stores the error description if any
+ * @return true if the BLAS worker is running, false otherwise
+ */
+bool IETWorker::start_gpu_worker(string *err_description) {
+    gpu_worker = std::unique_ptr<blas_worker>(
+        new blas_worker(gpu_device_index, matrix_size));
+    if (gpu_worker == nullptr) {
+        *err_description = IET_MEM_ALLOC_ERROR;
+        return false;
+    }
+    if (gpu_worker->get_blas_error()) {
+        *err_description = IET_BLAS_FAILURE;
+        return false;
+    }
+    gpu_worker->set_sgemm_delay(0);
+    gpu_worker->set_bcount_sgemm(true);
+    gpu_worker->set_gemm_wait(gemm_wait);
+    gpu_worker->set_seed(seed);
+    gpu_worker->set_sim_device(sim_dev.get());
+    gpu_worker->set_clock(clk);
+    gpu_worker->set_pacing_spin(pacing_spin);
+    if (bburst)
+        gpu_worker->set_burst(burst_sched);
+
+    // start the SGEMM workload
+    gpu_worker->start();
+
+    // wait for the BLAS setup to complete
+    while (!gpu_worker->is_setup_complete()) {}
+    if (gpu_worker->get_blas_error()) {
+        *err_description = IET_BLAS_FAILURE;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief computes SGEMMs and power related statistics after the training stage
+ */
+void IETWorker::compute_gpu_stats(void) {
+    float sgemm_target_power;
+    float sgemm_target_power_si, total_ms_sgemm_si;
+
+    // compute SGEMM time (ms)
+    sgemm_time_ms = static_cast<float>(training_time_ms) / num_sgemms_training;
+    // compute required number of SGEMM for the given target_power
+    sgemm_target_power =
+                    (target_power * num_sgemms_training) / avg_power_training;
+    sgemm_target_power_si =
+                    (sample_interval * sgemm_target_power) / training_time_ms;
+    // compute the actual SGEMM frequency for the given target_power
+    total_ms_sgemm_si = sgemm_target_power_si * sgemm_time_ms;
+    sgemm_si_delay = sample_interval - total_ms_sgemm_si;
+    if (sgemm_si_delay < 0) {
+        sgemm_si_delay = 0;
+    } else {
+        if (sgemm_target_power_si > 0)
+            sgemm_si_delay /= sgemm_target_power_si;
+        else
+            sgemm_target_power_si = sample_interval;
+
+        sgemm_si_delay = sgemm_si_delay + sgemm_si_delay / SGEMM_DELAY_FREQ_DEV;
+    }
+}
+
+/**
+ * @brief computes the new SGEMM frequency so that the GPU will achieve the
+ * given target_power
+ * @param avg_power the last GPU average power over the last sample_interval
+ */
+void IETWorker::compute_new_sgemm_freq(float avg_power) {
+    // compute the difference between the actual power data and the target_power
+    float diff_power = avg_power - target_power;
+    // gradually & dynamically increase/decrease the SGEMM frequency
+    float sgemm_delay_dev = (abs(diff_power) * sgemm_si_delay) / target_power;
+    if (diff_power < 0) {
+        if (sgemm_si_delay - sgemm_delay_dev < 0)
+            sgemm_si_delay = 1;
+        else
+            sgemm_si_delay -= sgemm_delay_dev;
+    } else {
+        sgemm_si_delay += sgemm_delay_dev;
+    }
+}
+
+/**
+ * @brief returns the fraction of the time the GPU runs SGEMMs at the current
+ * SGEMM delay
+ * @return duty cycle (0..1]
+ */
+float IETWorker::get_duty_cycle(void) {
+    return sgemm_time_ms / (sgemm_time_ms + sgemm_si_delay);
+}
+
+/**
+ * @brief adds the last sample to the duty cycle -> power fit and sets the
+ * SGEMM delay of the duty cycle the fit predicts for target_power
+ *
+ * The first step goes most of the way, the next ones refine the fit with
+ * samples close to the target. Falls back to the proportional step of
+ * compute_new_sgemm_freq() as long as the fit does not show the power rising
+ * with the load (e.g.: a single duty cycle sampled so far).
+ *
+ * @param avg_power the last GPU average power over the last sample_interval
+ */
+void IETWorker::compute_model_sgemm_freq(float avg_power) {
+    double duty;
+
+    power_fit.add(get_duty_cycle(), avg_power);
+    if (power_fit.get_slope() <= 0 || !power_fit.solve(target_power, &duty)) {
+        compute_new_sgemm_freq(avg_power);
+        return;
+    }
+
+    if (duty > 1)
+        duty = 1;
+    else if (duty < IET_RAMP_MIN_DUTY)
+        duty = IET_RAMP_MIN_DUTY;
+    sgemm_si_delay = sgemm_time_ms * (1 - duty) / duty;
+}
+
+/**
+ * @brief performs the EDPp ramp on the given GPU (attempts to reach the given
+ * target power)
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if target power is achieved within the ramp_interval, 
+ * false otherwise
+ */
+bool IETWorker::do_iet_ramp(int *error, string *err_description) {
+    uint64_t iet_start_time, end_time, sampling_start_time;
+    float cur_power_value, avg_power = 0;
+    uint64_t power_sampling_iters = 0, cur_milis_sampling, last_avg_power;
+    string msg;
+
+    *error = 0;
+    *err_description = "";
+
+    if (!do_gpu_init_training(err_description)) {
+        *error = 1;
+        return false;
+    }
+
+    pwr_log_worker = std::unique_ptr<log_worker>(
+                        new log_worker(IETWorker::bjson));
+    if (pwr_log_worker == nullptr) {
+        *error = 1;
+        *err_description = IET_MEM_ALLOC_ERROR;
+        return false;
+    }
+
+    pwr_log_worker->set_name(action_name);
+    pwr_log_worker->set_gpu_id(gpu_id);
+    pwr_log_worker->set_log_interval(log_interval);
+    pwr_log_worker->set_pwr_device_id(pwr_device_id);
+    pwr_log_worker->set_power_reader(pwr_reader);
+    pwr_log_worker->set_clock(clk);
+
+    compute_gpu_stats();
+
+    // the training ran the SGEMMs back to back: that is the first point of
+    // the duty cycle -> power fit
+    power_fit.reset();
+    power_fit.add(1.0, avg_power_training);
+    ramp_steps = 0;
+
+    // the SGEMMs are launched every sgemm_time_ms + sgemm_si_delay; the BLAS
+    // worker keeps running and switches to the new pace at its next launch
+    gpu_worker->set_pacing(sgemm_time_ms * 1000, sgemm_si_delay * 1000);
+
+    // record EDPp ramp-up start time
+    iet_start_time = clk->now_ms();
+    sampling_start_time = clk->now_ms();
+
+    pwr_log_worker->start();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        // get GPU's current average power (the power model only takes the
+        // readings of the second half of the sample_interval, once the power
+        // settled after the last SGEMM delay change)
+        cur_milis_sampling = time_diff(clk->now_ms(), sampling_start_time);
+        if ((!bramp_model ||
+             cur_milis_sampling * IET_RAMP_SETTLE_DIV >= sample_interval) &&
+            pwr_reader->read_power_uw(pwr_device_id, &last_avg_power)) {
+            cur_power_value = static_cast<float>(last_avg_power)/1e6;
+            avg_power += cur_power_value;
+            power_sampling_iters++;
+        }
+
+        end_time = clk->now_ms();
+        cur_milis_sampling = time_diff(end_time, sampling_start_time);
+        if (cur_milis_sampling >= sample_interval) {
+            // it's sampling time => check the power value against target_power
+            // (the load is not interrupted: the power is the one under load)
+            if (power_sampling_iters != 0) {
+                avg_power /= power_sampling_iters;
+                if (!(avg_power >= target_power - tolerance * target_power &&
+                    avg_power <= target_power + tolerance * target_power)) {
+                    // compute the new SGEMMs frequency
+                    if (bramp_model)
+                        compute_model_sgemm_freq(avg_power);
+                    else
+                        compute_new_sgemm_freq(avg_power);
+                    ramp_steps++;
+                    // set the new SGEMM frequency
+                    gpu_worker->set_sgemm_delay(sgemm_si_delay * 1000);
+
+                } else {
+                    // within tolerance: the fit gets one more point, close to
+                    // target_power, and the stress test starts at its finer
+                    // estimate
+                    if (bramp_model) {
+                        compute_model_sgemm_freq(avg_power);
+                        gpu_worker->set_sgemm_delay(sgemm_si_delay * 1000);
+                    }
+                    ramp_actual_time = training_time_ms +
+                                        time_diff(end_time, iet_start_time);
+                    log_convergence(time_diff(end_time, iet_start_time));
+                    return true;
+                }
+            }
+
+            avg_power = 0;
+            power_sampling_iters = 0;
+            sampling_start_time = clk->now_ms();
+        }
+
+        cur_milis_sampling = time_diff(end_time, iet_start_time);
+        if (cur_milis_sampling > ramp_interval - training_time_ms)
+            return false;
+
+        clk->sleep_for_ns(POWER_PROCESS_DELAY * 1000);
+    }
+}
+
+
+/**
+ * @brief performs the EDPp stress test on the given GPU (attempts to sustain
+ * the target power)
+ * @return true if EDPp test succeeded, false otherwise
+ */
+bool IETWorker::do_iet_power_stress(void) {
+    uint64_t iet_start_time, end_time, sampling_start_time;
+    float cur_power_value, avg_power = 0;
+    uint64_t power_sampling_iters = 0, cur_milis_sampling, total_time_ms;
+    uint64_t last_avg_power;
+    uint16_t num_power_violations = 0;
+    double sum_power_error = 0;
+    uint64_t num_power_samples = 0;
+    string msg;
+
+    // record EDPp ramp-up start time
+    iet_start_time = clk->now_ms();
+    sampling_start_time = clk->now_ms();
+
+    // the BLAS worker kept running since the ramp
+    gpu_worker->reset_launch_stats();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            break;
+
+        // get GPU's current average power
+        if (pwr_reader->read_power_uw(pwr_device_id, &last_avg_power)) {
+            cur_power_value = static_cast<float>(last_avg_power)/1e6;
+            avg_power += cur_power_value;
+            power_sampling_iters++;
+        }
+
+        end_time = clk->now_ms();
+        cur_milis_sampling = time_diff(end_time, sampling_start_time);
+        if (cur_milis_sampling >= sample_interval) {
+            // it's sampling time => check the power value against target_power
+            // (measured while the SGEMMs keep running)
+            if (power_sampling_iters != 0) {
+                avg_power /= power_sampling_iters;
+                sum_power_error += fabs(avg_power - target_power);
+                num_power_samples++;
+                if (!(avg_power >= target_power - tolerance * target_power &&
+                    avg_power <= target_power + tolerance * target_power)) {
+                    // detected a target_power violation
+                    num_power_violations++;
+                    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                        std::to_string(gpu_id) + " " + IET_PWR_VIOLATION_MSG +
+                        " " + std::to_string(avg_power);
+                    rvs::lp::Log(msg, rvs::loginfo);
+                    log_to_json(IET_PWR_VIOLATION_MSG,
+                                std::to_string(avg_power), rvs::loginfo);
+                }
+            }
+
+            avg_power = 0;
+            power_sampling_iters = 0;
+            sampling_start_time = clk->now_ms();
+        }
+
+        total_time_ms = time_diff(end_time, iet_start_time);
+        if (total_time_ms > run_duration_ms - ramp_actual_time)
+            break;
+
+        clk->sleep_for_ns(POWER_PROCESS_DELAY * 1000);
+    }
+
+    pwr_log_worker->stop();
+
+    gpu_worker->stop();
+    usleep(MAX_MS_WAIT_BLAS_THREAD);
+    gpu_worker->join();
+
+    log_launch_rate();
+
+    if (num_power_samples != 0) {
+        // mean distance to target_power, relative to it
+        float steady_error =
+                100 * sum_power_error / num_power_samples / target_power;
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + IET_STEADY_STATE_ERROR_MSG +
+                " " + std::to_string(steady_error) + " %";
+        rvs::lp::Log(msg, rvs::loginfo);
+        log_to_json(IET_STEADY_STATE_ERROR_MSG, std::to_string(steady_error),
+                    rvs::loginfo);
+    }
+
+    // check if stop signal was received
+    if (rvs::lp::Stopping())
+        return false;
+
+    if (num_power_violations > max_violations)
+        return false;
+
+    return true;
+}
+
+/**
+ * @brief logs how long and how many SGEMM delay changes the ramp took to
+ * bring the power within tolerance of target_power
+ * @param convergence_ms ramp time after the training (ms)
+ */
+void IETWorker::log_convergence(uint64_t convergence_ms) {
+    string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                    std::to_string(gpu_id) + " " + IET_CONVERGENCE_TIME_MSG +
+                    " " + std::to_string(convergence_ms) + " ms, " +
+                    IET_RAMP_STEPS_MSG + " " + std::to_string(ramp_steps);
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(IET_CONVERGENCE_TIME_MSG, std::to_string(convergence_ms),
+                rvs::loginfo);
+    log_to_json(IET_RAMP_STEPS_MSG, std::to_string(ramp_steps), rvs::loginfo);
+}
+
+/**
+ * @brief logs the SGEMM launch rate the BLAS worker achieved during the
+ * stress test next to the one the controller requested
+ */
+void IETWorker::log_launch_rate(void) {
+    double requested_hz, achieved_hz;
+    string msg;
+
+    gpu_worker->get_launch_rate(&requested_hz, &achieved_hz);
+    if (requested_hz == 0)
+        return;
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + IET_LAUNCH_RATE_MSG + " " +
+            std::to_string(achieved_hz) + " Hz (requested " +
+            std::to_string(requested_hz) + " Hz)";
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(IET_LAUNCH_RATE_MSG, std::to_string(achieved_hz),
+                rvs::loginfo);
+    log_to_json(IET_REQUESTED_LAUNCH_RATE_MSG, std::to_string(requested_hz),
+                rvs::loginfo);
+}
+
+/**
+ * @brief burst mode: lets the BLAS worker run the square wave load schedule
+ * (in step with the other GPUs) and records the average GPU power of the on
+ * and off part of each cycle
+ * @param err_description stores the error description if any
+ * @return true if all the cycles ran, false otherwise
+ */
+bool IETWorker::do_iet_burst(string *err_description) {
+    const uint64_t on_ns = burst_sched.on_ms * 1000000ull;
+    const uint64_t period_ns =
+                    (burst_sched.on_ms + burst_sched.off_ms) * 1000000ull;
+    std::vector<double> on_sum(burst_sched.cycles, 0);
+    std::vector<double> off_sum(burst_sched.cycles, 0);
+    std::vector<uint64_t> on_iters(burst_sched.cycles, 0);
+    std::vector<uint64_t> off_iters(burst_sched.cycles, 0);
+    double idle_sum = 0;
+    uint64_t idle_iters = 0, epoch, now, t, cycle, last_avg_power;
+    float cur_power_value;
+    string msg;
+
+    *err_description = "";
+    if (!start_gpu_worker(err_description))
+        return false;
+
+    rvs::pacer pace(clk);
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            break;
+
+        pace.wait_next(IET_BURST_SAMPLE_MS);
+        epoch = gpu_worker->get_burst_epoch();
+        now = clk->now_ns();
+        if (epoch != 0 && now >= epoch + burst_sched.cycles * period_ns)
+            break;
+        if (!pwr_reader->read_power_uw(pwr_device_id, &last_avg_power))
+            continue;
+        cur_power_value = static_cast<float>(last_avg_power)/1e6;
+
+        // before the first rising edge the GPU is idle
+        if (epoch == 0 || now < epoch) {
+            idle_sum += cur_power_value;
+            idle_iters++;
+            continue;
+        }
+        t = now - epoch;
+        cycle = t / period_ns;
+        if (t % period_ns < on_ns) {
+            on_sum[cycle] += cur_power_value;
+            on_iters[cycle]++;
+        } else {
+            off_sum[cycle] += cur_power_value;
+            off_iters[cycle]++;
+        }
+    }
+
+    gpu_worker->stop();
+    gpu_worker->join();
+
+    burst_idle_power = idle_iters ? idle_sum / idle_iters : 0;
+    burst_on_power.assign(burst_sched.cycles, 0);
+    burst_off_power.assign(burst_sched.cycles, 0);
+    for (cycle = 0; cycle < burst_sched.cycles; cycle++) {
+        if (on_iters[cycle])
+            burst_on_power[cycle] = on_sum[cycle] / on_iters[cycle];
+        if (off_iters[cycle])
+            burst_off_power[cycle] = off_sum[cycle] / off_iters[cycle];
+    }
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + IET_BURST_CYCLES_MSG + " " +
+            std::to_string(gpu_worker->get_burst_cycles_done()) + "/" +
+            std::to_string(burst_sched.cycles) + " sgemms " +
+            std::to_string(gpu_worker->get_num_sgemm_ops());
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(IET_BURST_CYCLES_MSG,
+                std::to_string(gpu_worker->get_burst_cycles_done()),
+                rvs::loginfo);
+
+    if (gpu_worker->get_num_sgemm_ops() == 0) {
+        *err_description = IET_SGEMM_FAILURE;
+        return false;
+    }
+    return gpu_worker->get_burst_cycles_done() == burst_sched.cycles;
+}
+
+/**
+ * @brief performs the Input EDPp test on the given GPU
+ */
+void IETWorker::run() {
+    string msg, err_description;
+    int error;
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " start " + std::to_string(target_power) +
+            " seed:" + std::to_string(seed);
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json("start", std::to_string(target_power), rvs::loginfo);
+    log_to_json("seed", std::to_string(seed), rvs::loginfo);
+
+    if (bburst) {
+        bool pass = do_iet_burst(&err_description);
+
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return;
+
+        if (!err_description.empty()) {
+            log_to_json("ERROR", err_description, rvs::logerror);
+            msg = "[" + action_name + "] " + MODULE_NAME + " "
+                    + std::to_string(gpu_id) + " " + err_description;
+            rvs::lp::Log(msg, rvs::logerror);
+        }
+
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + IET_PASS_KEY + ": " +
+                    (pass ? IET_RESULT_PASS_MESSAGE : IET_RESULT_FAIL_MESSAGE);
+        rvs::lp::Log(msg, rvs::logresults);
+        log_to_json(IET_PASS_KEY,
+                    (pass ? IET_RESULT_PASS_MESSAGE : IET_RESULT_FAIL_MESSAGE),
+                        rvs::logresults);
+        return;
+    }
+
+    if (ramp_interval < MAX_MS_TRAIN_GPU)
+        ramp_interval += MAX_MS_TRAIN_GPU;
+    if (run_duration_ms < MAX_MS_TRAIN_GPU)
+        run_duration_ms += MAX_MS_TRAIN_GPU;
+
+    if (!do_iet_ramp(&error, &err_description)) {
+        if (gpu_worker != nullptr) {
+            // terminate the blas worker thread
+            gpu_worker->stop();
+            usleep(MAX_MS_WAIT_BLAS_THREAD);
+            gpu_worker->join();
+        }
+
+        if (pwr_log_worker != nullptr)
+            pwr_log_worker->stop();
+
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return;
+
+        if (error) {
+            log_to_json("ERROR", err_description, rvs::logerror);
+            msg = "[" + action_name + "] " + MODULE_NAME + " "
+                    + std::to_string(gpu_id) + " " + err_description;
+            rvs::lp::Log(msg, rvs::logerror);
+        } else  {
+            log_to_json(IET_PWR_RAMP_EXCEEDED_MSG,
+                std::to_string(ramp_interval), rvs::loginfo);
+
+            msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + IET_PWR_RAMP_EXCEEDED_MSG + " " +
+                    std::to_string(ramp_interval);
+            rvs::lp::Log(msg, rvs::loginfo);
+        }
+
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + IET_PASS_KEY + ": " +
+                IET_RESULT_FAIL_MESSAGE;
+        rvs::lp::Log(msg, rvs::logresults);
+
+        log_to_json(IET_PASS_KEY, IET_RESULT_FAIL_MESSAGE, rvs::logresults);
+
+    } else {
+        // the GPU succeeded in achieving the given target_power
+        // => log a message and start the sustained stress test
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + IET_PWR_TARGET_ACHIEVED_MSG +
+                " " + std::to_string(target_power);
+        rvs::lp::Log(msg, rvs::loginfo);
+        log_to_json(IET_PWR_TARGET_ACHIEVED_MSG,
+                    std::to_string(target_power), rvs::loginfo);
+
+
+        bool pass = do_iet_power_stress();
+
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return;
+
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + IET_PASS_KEY + ": " +
+                    (pass ? IET_RESULT_PASS_MESSAGE : IET_RESULT_FAIL_MESSAGE);
+        rvs::lp::Log(msg, rvs::logresults);
+        log_to_json(IET_PASS_KEY,
+                    (pass ? IET_RESULT_PASS_MESSAGE : IET_RESULT_FAIL_MESSAGE),
+                        rvs::logresults);
+    }
+}
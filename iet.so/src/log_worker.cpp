@@ -0,0 +1,330 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/log_worker.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "include/rvs_module.h"
+#include "include/rvs_cancel.h"
+#include "include/rvs_pacer.h"
+#include "include/rvsloglp.h"
+
+#define MODULE_NAME                             "iet"
+
+//! power sampling period (ms)
+#define IET_LOGGER_SAMPLE_MS                    10
+//! length of the moving average window (ms), as defined by the EDPp spec
+#define IET_LOGGER_AVG_WINDOW_MS                60000
+//! capacity of the sample ring (samples)
+#define IET_LOGGER_RING_SIZE                    4096
+//! longest time a sample stays in the ring, whatever the log interval (the
+//! ring holds IET_LOGGER_RING_SIZE * IET_LOGGER_SAMPLE_MS ms of samples)
+#define IET_LOGGER_DRAIN_MS                     1000
+
+#define IET_LOGGER_JSON_LOG_GPU_ID_KEY          "gpu_id"
+#define IET_LOGGER_CURRENT_POWER_MSG            "current power"
+#define IET_LOGGER_MOVING_AVG_MSG               "power moving average"
+#define IET_LOGGER_SAMPLING_RATE_MSG            "sampling rate"
+#define IET_LOGGER_SAMPLING_JITTER_MSG          "sampling jitter"
+//! time-series metric of the power samples (see "--tsFile")
+#define IET_LOGGER_TS_POWER                     "power"
+
+using std::string;
+
+/**
+ * @brief default class constructor
+ * @param _bjson true if JSON logging is needed, false otherwise
+ */
+log_worker::log_worker(bool _bjson):
+                        bjson(_bjson),
+                        brun(true),
+                        bpaused(false),
+                        sample_period_ms(IET_LOGGER_SAMPLE_MS),
+                        samples(IET_LOGGER_RING_SIZE),
+                        minute_avg(IET_LOGGER_AVG_WINDOW_MS * 1000000ull),
+                        moving_avg(0) {
+    pwr_reader = rvs::power_reader::rsmi();
+    clk = rvs::clock::real();
+}
+
+log_worker::~log_worker() {}
+
+/**
+ * @brief stop the thread
+ */
+void log_worker::stop(void) {
+    {
+        std::lock_guard<std::mutex> lck(mtx_state);
+        brun = false;
+    }
+    cv_state.notify_all();
+
+    try {
+      if (t.joinable())
+        t.join();
+    } catch(...) {
+    }
+}
+
+/**
+ * @brief pauses the worker
+ */
+void log_worker::pause(void) {
+    std::lock_guard<std::mutex> lck(mtx_state);
+    bpaused = true;
+}
+
+/**
+ * @brief resumes the worker
+ */
+void log_worker::resume(void) {
+    {
+        std::lock_guard<std::mutex> lck(mtx_state);
+        bpaused = false;
+    }
+    cv_state.notify_all();
+}
+
+/**
+ * @brief blocks while the worker is paused
+ * @param was_paused set to true if the call had to wait
+ * @return false if the worker has to stop, true otherwise
+ */
+bool log_worker::wait_running(bool* was_paused) {
+    std::unique_lock<std::mutex> lck(mtx_state);
+    *was_paused = false;
+    while (brun && bpaused && !rvs::lp::Stopping()) {
+        *was_paused = true;
+        cv_state.wait(lck);
+    }
+    return brun && !rvs::lp::Stopping();
+}
+
+/**
+ * @brief sleeps until the given time unless the worker is paused or stopped
+ * first
+ * @param deadline_ns wake-up time (ns, on clk)
+ * @return false if the worker has to stop, true otherwise
+ */
+bool log_worker::wait_until(uint64_t deadline_ns) {
+    std::unique_lock<std::mutex> lck(mtx_state);
+
+    for (;;) {
+        if (!brun || rvs::lp::Stopping())
+            return false;
+        if (bpaused || clk->now_ns() >= deadline_ns)
+            return true;
+        clk->wait_until_ns(&cv_state, &lck, deadline_ns);
+    }
+}
+
+/**
+ * @brief logs a message to JSON
+ * @param key info type
+ * @param value message to log
+ * @param log_level the level of log (e.g.: info, results, error)
+ */
+void log_worker::log_to_json(const std::string &key, const std::string &value,
+                     int log_level) {
+    if (bjson) {
+        unsigned int sec;
+        unsigned int usec;
+
+        rvs::lp::get_ticks(&sec, &usec);
+        void *json_node = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), log_level, sec, usec);
+        if (json_node) {
+            rvs::lp::AddString(json_node, IET_LOGGER_JSON_LOG_GPU_ID_KEY,
+                            std::to_string(gpu_id));
+            rvs::lp::AddString(json_node, key, value);
+            rvs::lp::LogRecordFlush(json_node);
+        }
+    }
+}
+
+/**
+ * @brief sampling thread: reads the GPU power every sample_period_ms and
+ * pushes the samples to the ring
+ */
+void log_worker::sample_power(void) {
+    rvs::pacer pace(clk);
+    uint64_t power_uw, now;
+    bool was_paused;
+    sample s;
+
+    while (wait_running(&was_paused)) {
+        if (was_paused)
+            pace.start();
+
+        pace.wait_next(sample_period_ms);
+        now = clk->now_ns();
+        if (!pwr_reader->read_power_uw(pwr_device_id, &power_uw))
+            continue;
+
+        s.t_ns = now;
+        s.late_ns = now > pace.get_deadline() ? now - pace.get_deadline() : 0;
+        s.power = static_cast<float>(power_uw) / 1e6;
+        // if run() fell behind the sample is dropped (and counted)
+        samples.push(s);
+    }
+}
+
+/**
+ * @brief computes the GPU power for each log_interval and logs the data
+ */
+void log_worker::run() {
+    uint64_t interval_start, next_log, now;
+    uint64_t num_samples, total_samples = 0, late_sum, late_max = 0;
+    uint64_t active_start, active_time = 0;
+    double power_sum;
+    bool was_paused, paused;
+    sample s;
+    string msg, prefix;
+
+    prefix = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " ";
+
+    // a stop request wakes up both threads
+    rvs::cancel_token* token = rvs::cancel_token::process();
+    int waker = token->add_waker([this] {
+        { std::lock_guard<std::mutex> lck(mtx_state); }
+        cv_state.notify_all();
+    });
+
+    std::thread sampler(&log_worker::sample_power, this);
+
+    active_start = interval_start = clk->now_ns();
+    next_log = interval_start + log_interval * 1000000ull;
+    num_samples = late_sum = 0;
+    power_sum = 0;
+    while (wait_running(&was_paused)) {
+        if (was_paused) {
+            // the time spent paused is not part of the sampling rate
+            active_start = interval_start = clk->now_ns();
+            next_log = interval_start + log_interval * 1000000ull;
+        }
+
+        // the ring is drained on its own cadence, so that a long log
+        // interval does not overflow it
+        now = clk->now_ns();
+        if (!wait_until(std::min<uint64_t>(next_log,
+                                 now + IET_LOGGER_DRAIN_MS * 1000000ull)))
+            break;
+
+        while (samples.pop(&s)) {
+            // O(1) per sample
+            minute_avg.add(s.t_ns, s.power);
+            // every sample goes to the time-series file, not only the
+            // per-interval average
+            rvs::lp::Sample(MODULE_NAME, gpu_id, IET_LOGGER_TS_POWER, s.t_ns,
+                            s.power);
+            power_sum += s.power;
+            late_sum += s.late_ns;
+            late_max = std::max(late_max, s.late_ns);
+            num_samples++;
+        }
+        moving_avg.store(minute_avg.mean());
+
+        now = clk->now_ns();
+        {
+            // a pause cuts the interval short
+            std::lock_guard<std::mutex> lck(mtx_state);
+            paused = bpaused;
+        }
+        if (now < next_log && !paused)
+            continue;
+
+        if (num_samples != 0) {
+            float avg_power = power_sum / num_samples;
+            double rate = now > interval_start ?
+                num_samples * 1e9 / (now - interval_start) : 0;
+            double jitter_us = late_sum / 1000.0 / num_samples;
+
+            msg = prefix + IET_LOGGER_CURRENT_POWER_MSG + " " +
+                    std::to_string(avg_power);
+            rvs::lp::Log(msg, rvs::loginfo);
+            log_to_json(IET_LOGGER_CURRENT_POWER_MSG,
+                            std::to_string(avg_power), rvs::loginfo);
+            log_to_json(IET_LOGGER_MOVING_AVG_MSG,
+                            std::to_string(minute_avg.mean()), rvs::loginfo);
+
+            msg = prefix + IET_LOGGER_MOVING_AVG_MSG + " " +
+                    std::to_string(minute_avg.mean()) + " " +
+                    IET_LOGGER_SAMPLING_RATE_MSG + " " +
+                    std::to_string(rate) + " Hz " +
+                    IET_LOGGER_SAMPLING_JITTER_MSG + " " +
+                    std::to_string(jitter_us) + " us";
+            rvs::lp::Log(msg, rvs::logdebug);
+        }
+
+        total_samples += num_samples;
+        if (paused) {
+            // the report above covered the time until the pause
+            active_time += now - active_start;
+            active_start = now;
+        }
+        interval_start = now;
+        num_samples = late_sum = 0;
+        power_sum = 0;
+
+        next_log += log_interval * 1000000ull;
+        if (next_log < now)
+            next_log = now + log_interval * 1000000ull;
+    }
+
+    sampler.join();
+    token->remove_waker(waker);
+
+    // drain what the sampler pushed after the last report
+    while (samples.pop(&s)) {
+        minute_avg.add(s.t_ns, s.power);
+        late_max = std::max(late_max, s.late_ns);
+        total_samples++;
+    }
+    moving_avg.store(minute_avg.mean());
+
+    now = clk->now_ns();
+    active_time += now - active_start;
+    if (active_time > 0) {
+        double rate = total_samples * 1e9 / active_time;
+        msg = prefix + IET_LOGGER_SAMPLING_RATE_MSG + " " +
+                std::to_string(rate) + " Hz (requested " +
+                std::to_string(1000.0 / sample_period_ms) + " Hz) max " +
+                IET_LOGGER_SAMPLING_JITTER_MSG + " " +
+                std::to_string(late_max / 1000.0) + " us dropped samples " +
+                std::to_string(samples.get_dropped());
+        rvs::lp::Log(msg, rvs::loginfo);
+        log_to_json(IET_LOGGER_SAMPLING_RATE_MSG, std::to_string(rate),
+                        rvs::loginfo);
+        log_to_json(IET_LOGGER_SAMPLING_JITTER_MSG,
+                        std::to_string(late_max / 1000.0), rvs::loginfo);
+    }
+}
@@ -0,0 +1,157 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_AUTOTUNE_H_
+#define INCLUDE_RVS_AUTOTUNE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace rvs {
+
+//! default location of the autotune result cache
+#define RVS_AUTOTUNE_DEFAULT_CACHE      "/var/tmp/rvs_autotune.cache"
+//! default ROCm install location (holds .info/version)
+#define RVS_AUTOTUNE_ROCM_PATH          "/opt/rocm"
+//! sysfs PCI devices folder (holds <bdf>/vbios_version)
+#define RVS_AUTOTUNE_PCI_SYSFS          "/sys/bus/pci/devices"
+//! sysfs folder of the amdgpu kernel module (holds version)
+#define RVS_AUTOTUNE_DRIVER_SYSFS       "/sys/module/amdgpu"
+//! default location of the IET training result cache
+#define RVS_TRAINING_DEFAULT_CACHE      "/var/tmp/rvs_iet_training.cache"
+
+/**
+ * @brief GEMM shape and the throughput it achieved
+ */
+typedef struct gemm_shape {
+  uint64_t m;
+  uint64_t n;
+  uint64_t k;
+  //! throughput (Gflops, Gops for integer GEMMs)
+  double gflops;
+} gemm_shape;
+
+/**
+ * @brief IET training result: SGEMM time and GPU power under full load
+ */
+typedef struct training_result {
+  //! SGEMM matrix size
+  uint64_t matrix_size;
+  //! SGEMM time (ms)
+  double ms_per_sgemm;
+  //! average GPU power (W) while running SGEMMs back to back
+  double avg_power;
+  //! time the result was stored (s since the epoch)
+  uint64_t timestamp;
+} training_result;
+
+/**
+ * @class line_cache
+ * @ingroup RVS
+ *
+ * @brief file backed key/values store shared by several workers/processes
+ *
+ * Each line holds "<key> <values>". Updates are serialized with flock() on
+ * "<path>.lock" and the file is replaced atomically (write to a temporary
+ * file, then rename()), so workers of several GPUs or several rvs instances
+ * can share the file.
+ *
+ */
+class line_cache {
+ public:
+  explicit line_cache(const std::string& _path);
+
+  //! returns the cache file path
+  const std::string& get_path(void) const { return path; }
+
+ protected:
+  bool read_lines(std::vector<std::string> *lines);
+  bool lookup_values(const std::string& key,
+                     std::vector<std::string> *values);
+  bool store_values(const std::string& key, const std::string& values);
+
+ protected:
+  //! cache file path
+  std::string path;
+};
+
+/**
+ * @class autotune_cache
+ * @ingroup RVS
+ *
+ * @brief file backed cache of the best GEMM shape found for a device
+ *
+ * Each line holds "<key> <m> <n> <k> <gflops>" where the key identifies the
+ * GEMM type, the device ID, the VBIOS and the ROCm version (see make_key()),
+ * so a shape tuned on one SKU/firmware/stack is never reused on another.
+ *
+ */
+class autotune_cache : public line_cache {
+ public:
+  explicit autotune_cache(const std::string& _path);
+
+  bool lookup(const std::string& key, gemm_shape *shape);
+  bool store(const std::string& key, const gemm_shape& shape);
+
+  static std::string make_key(const std::string& ops_type, uint16_t device_id,
+                              const std::string& vbios,
+                              const std::string& rocm_version);
+  static std::string device_key(const std::string& ops_type, uint16_t gpu_id,
+                                int hip_device_index);
+  static std::string read_rocm_version(
+                        const std::string& rocm_path = RVS_AUTOTUNE_ROCM_PATH);
+  static std::string read_vbios_version(int pci_domain, int pci_bus,
+                        int pci_device,
+                        const std::string& sysfs = RVS_AUTOTUNE_PCI_SYSFS);
+  static std::string read_driver_version(
+                        const std::string& sysfs = RVS_AUTOTUNE_DRIVER_SYSFS);
+  static std::vector<gemm_shape> candidates(void);
+  static std::vector<gemm_shape> refine(const gemm_shape& best);
+};
+
+/**
+ * @class training_cache
+ * @ingroup RVS
+ *
+ * @brief file backed cache of the IET training results
+ *
+ * Each line holds "<key> <matrix_size> <ms_per_sgemm> <avg_power>
+ * <timestamp>". The key (see autotune_cache::make_key()) identifies the GPU,
+ * its device ID, VBIOS, driver and ROCm version, so a result is only reused
+ * on the very same board and software stack.
+ *
+ */
+class training_cache : public line_cache {
+ public:
+  explicit training_cache(const std::string& _path);
+
+  bool lookup(const std::string& key, training_result *result);
+  bool store(const std::string& key, const training_result& result);
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_AUTOTUNE_H_
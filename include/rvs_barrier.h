@@ -0,0 +1,80 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_BARRIER_H_
+#define INCLUDE_RVS_BARRIER_H_
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+
+#include "include/rvs_clock.h"
+
+namespace rvs {
+
+/**
+ * @class barrier
+ * @ingroup RVS
+ *
+ * @brief reusable rendezvous point of a fixed group of threads
+ *
+ * wait() blocks until every thread of the group called it, then releases
+ * them all and returns to each the same release time (the time the last one
+ * arrived), which the threads can use as a common time base. A thread that
+ * stops early calls leave(), so that the others are not blocked forever.
+ *
+ */
+class barrier {
+ public:
+  explicit barrier(unsigned int _count, clock* _clk = clock::real());
+
+  uint64_t wait(void);
+  void leave(void);
+  //! returns the number of threads still in the group
+  unsigned int get_count(void);
+
+ protected:
+  void release(void);
+
+ protected:
+  //! time source of the release times
+  clock* clk;
+  //! number of threads in the group
+  unsigned int count;
+  //! number of threads waiting in the current generation
+  unsigned int arrived;
+  //! incremented each time the threads are released
+  uint64_t generation;
+  //! release time of the last generation (ns)
+  uint64_t release_ns;
+  //! protects the state above
+  std::mutex mtx;
+  //! signaled when the threads are released
+  std::condition_variable cv;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_BARRIER_H_
@@ -27,21 +27,270 @@
 
 #define __HIP_PLATFORM_HCC__
 
+#include <string>
+#include <memory>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+
 #include "rocblas.h"
 #include "include/hip/hip_runtime.h"
 #include "include/hip/hip_runtime_api.h"
 
+//! edge (in elements) of the C tiles sampled by the result verification
+#define RVS_BLAS_VERIFY_TILE    32
+//! number of device copies of the matrices used by the asynchronous upload
+//! (the next matrices are copied while the current GEMM runs)
+#define RVS_BLAS_COPY_BUFS      2
+
+//! C tile sampled by the result verification (top-left corner)
+typedef struct {
+    rocblas_int row;
+    rocblas_int col;
+} rvs_gemm_tile;
+
+//! C element that failed the result verification
+typedef struct {
+    //! batch entry
+    int batch;
+    //! element row
+    rocblas_int row;
+    //! element column
+    rocblas_int col;
+    //! value computed by the GPU
+    double gpu;
+    //! value computed by the host reference
+    double ref;
+} rvs_gemm_mismatch;
+
+/**
+ * @brief per GEMM type traits (see rvs_blas.cpp): the A/B, C and alpha/beta
+ * types, the rocBlas GEMM routines and the random data conversion
+ */
+template <typename T>
+struct gemm_traits;
+
+/**
+ * @class rvs_gemm_engine
+ * @ingroup GST
+ *
+ * @brief type independent interface of the GEMM engine
+ *
+ * Holds the A/B/C host and device matrices of a single GEMM type and runs
+ * the GEMM on them. The concrete engine is selected once, when rvs_blas is
+ * created, so nothing on the GEMM launch path depends on the GEMM type.
+ *
+ */
+class rvs_gemm_engine {
+ public:
+    virtual ~rvs_gemm_engine() {}
+
+    //! returns the size (in bytes) of all the A, B and C matrices
+    virtual uint64_t matrix_bytes(void) = 0;
+    //! returns TRUE if the GEMM computes on integers (performance is then
+    //! reported in ops, not flops)
+    virtual bool is_integer(void) = 0;
+    //! allocates the host matrices
+    virtual bool allocate_host(void) = 0;
+    //! allocates the device matrices
+    virtual bool allocate_gpu(void) = 0;
+    //! fills the host matrices with random data
+    virtual void fill_random(uint64_t seed_a, uint64_t seed_b,
+                             uint64_t seed_c) = 0;
+    //! copies the host matrices to the device
+    virtual bool copy_to_gpu(void) = 0;
+    //! moves the host matrices to pinned memory and allocates num_bufs
+    //! device copies of the matrices
+    virtual bool allocate_copy_buffers(int num_bufs) = 0;
+    //! enqueues the copy of the host matrices to the buf-th device copy
+    virtual bool copy_to_gpu_async(int buf, hipStream_t stream) = 0;
+    //! enqueues C = alpha * A * B^T + beta * C on the handle's stream
+    //! (batch_count GEMMs if batched), using the buf-th device copy of the
+    //! matrices and its c_set-th set of C matrices
+    virtual bool run_gemm(rocblas_handle handle, rocblas_int m, rocblas_int n,
+                          rocblas_int k, int c_set, int buf) = 0;
+
+    //! allocates the device C the verification GEMM writes to and the
+    //! pinned host buffer the sampled tiles are copied to
+    virtual bool allocate_verify(int tile_size, int num_tiles) = 0;
+    //! enqueues C' = alpha * A * B^T (beta = 0) for the given batch entry
+    //! of the buf-th device copy of the matrices
+    virtual bool run_verify_gemm(rocblas_handle handle, rocblas_int m,
+                                 rocblas_int n, rocblas_int k, int batch,
+                                 int buf) = 0;
+    //! enqueues the copy of one sampled C' tile to the host
+    virtual bool copy_verify_tile(int idx, const rvs_gemm_tile& tile,
+                                  rocblas_int m, hipStream_t stream) = 0;
+    //! recomputes the sampled tiles on the host and collects the elements
+    //! which are out of tolerance
+    virtual void check_verify_tiles(rocblas_int m, rocblas_int n,
+                                    rocblas_int k, int batch,
+                                    const std::vector<rvs_gemm_tile>& tiles,
+                                    std::vector<rvs_gemm_mismatch>* mm) = 0;
+
+    static rvs_gemm_engine* create(const std::string& ops_type,
+                                   rocblas_int size_a, rocblas_int size_b,
+                                   rocblas_int size_c, int batch_count,
+                                   int num_c_sets);
+};
+
+/**
+ * @class rvs_gemm_engine_t
+ * @ingroup GST
+ *
+ * @brief GEMM engine for GEMM type T
+ *
+ * T is either the element type of a plain GEMM (float, double, rocblas_half)
+ * or a tag selecting a rocblas_gemm_ex configuration (input, output and
+ * compute types). The matrix types, the rocBlas call, the alpha/beta values
+ * and the random data conversion come from gemm_traits<T> (see
+ * rvs_blas.cpp). A new GEMM type is added by specializing gemm_traits and
+ * registering it in rvs_gemm_engine::create().
+ *
+ */
+template <typename T>
+class rvs_gemm_engine_t : public rvs_gemm_engine {
+ public:
+    //! A and B element type
+    typedef typename gemm_traits<T>::ab_type ab_type;
+    //! C element type
+    typedef typename gemm_traits<T>::c_type c_type;
+    //! alpha/beta type
+    typedef typename gemm_traits<T>::scalar_type scalar_type;
+
+    rvs_gemm_engine_t(rocblas_int _size_a, rocblas_int _size_b,
+                      rocblas_int _size_c, int _batch_count,
+                      int _num_c_sets);
+    virtual ~rvs_gemm_engine_t();
+
+    virtual uint64_t matrix_bytes(void) {
+        return bytes_a() + bytes_b() + bytes_c();
+    }
+    virtual bool is_integer(void) { return gemm_traits<T>::is_integer; }
+    virtual bool allocate_host(void);
+    virtual bool allocate_gpu(void);
+    virtual void fill_random(uint64_t seed_a, uint64_t seed_b,
+                             uint64_t seed_c);
+    virtual bool copy_to_gpu(void);
+    virtual bool allocate_copy_buffers(int _num_bufs);
+    virtual bool copy_to_gpu_async(int buf, hipStream_t stream);
+    virtual bool run_gemm(rocblas_handle handle, rocblas_int m, rocblas_int n,
+                          rocblas_int k, int c_set, int buf);
+
+    virtual bool allocate_verify(int tile_size, int num_tiles);
+    virtual bool run_verify_gemm(rocblas_handle handle, rocblas_int m,
+                                 rocblas_int n, rocblas_int k, int batch,
+                                 int buf);
+    virtual bool copy_verify_tile(int idx, const rvs_gemm_tile& tile,
+                                  rocblas_int m, hipStream_t stream);
+    virtual void check_verify_tiles(rocblas_int m, rocblas_int n,
+                                    rocblas_int k, int batch,
+                                    const std::vector<rvs_gemm_tile>& tiles,
+                                    std::vector<rvs_gemm_mismatch>* mm);
+
+ protected:
+    //! number of elements in A
+    rocblas_int size_a;
+    //! number of elements in B
+    rocblas_int size_b;
+    //! number of elements in C
+    rocblas_int size_c;
+    //! number of GEMMs per launch (> 1 means strided-batched GEMM)
+    int batch_count;
+    //! number of independent C sets (one per stream, so that concurrent
+    //! GEMMs do not write the same memory)
+    int num_c_sets;
+    //! number of device copies of A, B and the C sets
+    int num_bufs;
+    //! TRUE if the host matrices are in pinned memory
+    bool host_pinned;
+    //! pointer to device (GPU) memory
+    ab_type *da;
+    //! pointer to device (GPU) memory
+    ab_type *db;
+    //! pointer to device (GPU) memory
+    c_type *dc;
+    //! pointer to host memory
+    ab_type *ha;
+    //! pointer to host memory
+    ab_type *hb;
+    //! pointer to host memory
+    c_type *hc;
+    //! device C written by the verification GEMM
+    c_type *dv;
+    //! pinned host copy of the sampled C tiles
+    c_type *hv;
+    //! edge of the sampled tiles
+    int verify_tile;
+
+    void check_tile(rocblas_int m, rocblas_int n, rocblas_int k, int batch,
+                    int idx, const rvs_gemm_tile& tile,
+                    std::vector<rvs_gemm_mismatch>* mm);
+
+    //! size (in bytes) of all the A matrices
+    uint64_t bytes_a(void) {
+        return sizeof(ab_type) * static_cast<uint64_t>(size_a) * batch_count;
+    }
+    //! size (in bytes) of all the B matrices
+    uint64_t bytes_b(void) {
+        return sizeof(ab_type) * static_cast<uint64_t>(size_b) * batch_count;
+    }
+    //! size (in bytes) of all the C sets
+    uint64_t bytes_c(void) {
+        return sizeof(c_type) * static_cast<uint64_t>(size_c) * batch_count *
+               num_c_sets;
+    }
+    //! A of the buf-th device copy
+    ab_type* dev_a(int buf) { return da + bytes_a() / sizeof(ab_type) * buf; }
+    //! B of the buf-th device copy
+    ab_type* dev_b(int buf) { return db + bytes_b() / sizeof(ab_type) * buf; }
+    //! C sets of the buf-th device copy
+    c_type* dev_c(int buf) { return dc + bytes_c() / sizeof(c_type) * buf; }
+    void free_host(void);
+};
+
+/**
+ * @brief wakes up the host threads waiting for GEMM events
+ *
+ * A host function enqueued right after each GEMM completion event a thread
+ * waits for signals it once the event completed. The functions hold a reference, so it outlives a
+ * rvs_blas destroyed while some of them are still queued.
+ */
+struct rvs_gemm_notifier {
+    rvs_gemm_notifier() : num_signals(0) {}
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    //! number of host functions run so far
+    uint64_t num_signals;
+};
+
 /**
  * @class rvs_blas
  * @ingroup GST
  *
- * @brief implements the SGEMM logic
+ * @brief implements the GEMM logic
+ *
+ * The GEMM and upload/verification methods are virtual so that a simulated
+ * device (see rvs_blas_sim in rvs_sim.h) can stand in for the GPU.
  *
  */
 class rvs_blas {
  public:
-    rvs_blas(int _gpu_device_index, int _m, int _n, int _k);
-    ~rvs_blas();
+    //! how the host thread waits for a GEMM to complete
+    typedef enum {
+        //! sleep until the GPU signals the completion event
+        GEMM_WAIT_BLOCKING_SYNC = 0,
+        //! poll the completion event for a short while, then yield the CPU
+        //! between polls
+        GEMM_WAIT_SPIN_YIELD
+    } gemm_wait_t;
+
+    rvs_blas(int _gpu_device_index, int _m, int _n, int _k,
+             const std::string& _ops_type, int _batch_count = 1,
+             int _num_streams = 1, int _num_inflight = 1);
+    virtual ~rvs_blas();
 
     //! returns the GPU index
     int get_gpu_device_index(void) { return gpu_device_index; }
@@ -51,23 +300,82 @@ class rvs_blas {
     rocblas_int get_n(void) { return n; }
     //! returns k (matrix size)
     rocblas_int get_k(void) { return k; }
+    //! returns the GEMM type (sgemm, dgemm, hgemm, hgemm_f32acc, bf16gemm,
+    //! i8gemm)
+    const std::string& get_ops_type(void) { return ops_type; }
+    //! returns the number of GEMMs per launch
+    int get_batch_count(void) { return batch_count; }
+    //! returns the number of streams used by the pipelined submission
+    int get_num_streams(void) { return num_streams; }
+    //! returns the max number of GEMM launches kept in flight
+    int get_num_inflight(void) { return num_inflight; }
 
     //! computes the number of bytes which are copied to
-    //! the GPU for one SGEMM operation
+    //! the GPU for one GEMM operation
     uint64_t get_bytes_copied_per_op(void) {
-        return sizeof(float) * (size_a + size_b + size_c);
+        return engine ? engine->matrix_bytes() : 0;
     }
-    //! computes the gflop for a SGEMM operation
+    //! computes the gflop (giga-ops for integer GEMMs) for one GEMM launch
+    //! (all the batch)
     double gemm_gflop_count(void) {
-        return static_cast<double>(2.0 * m * n * k) / 1e9;
+        return static_cast<double>(2.0 * m * n * k) * batch_count / 1e9;
+    }
+    //! returns TRUE if the GEMM computes on integers
+    virtual bool is_integer_op(void) {
+        return engine && engine->is_integer();
+    }
+    //! returns the performance unit of the GEMM type ("flops" or "ops")
+    std::string get_perf_unit(void) {
+        return is_integer_op() ? "ops" : "flops";
     }
 
     //! returns TRUE if an error occured
     bool error(void) { return is_error; }
-    void generate_random_matrix_data(void);
-    bool copy_data_to_gpu(std::string);
-    bool run_blass_gemm(std::string);
-    bool is_gemm_op_complete(void);
+    virtual void generate_random_matrix_data(uint64_t _seed);
+    //! returns the seed of the current matrix data
+    uint64_t get_seed(void) { return seed; }
+    virtual bool copy_data_to_gpu(void);
+    virtual bool run_blass_gemm(void);
+    virtual bool is_gemm_op_complete(void);
+    virtual bool wait_gemm_op_complete(void);
+    virtual double get_gemm_op_time_ms(void);
+
+    virtual bool start_gemm_timeline(void);
+    virtual bool enqueue_gemm(void);
+    virtual bool wait_oldest_gemm(void);
+    bool drain_gemms(void);
+    //! returns the number of GEMM launches currently in flight
+    int get_gemms_in_flight(void) {
+        return static_cast<int>(num_submitted - num_completed);
+    }
+    //! returns the completion time (in ms, since start_gemm_timeline()) of
+    //! the last GEMM waited for by wait_oldest_gemm()
+    double get_last_completion_ms(void) { return last_completion_ms; }
+
+    virtual bool init_verify(int _num_tiles);
+    virtual bool start_verify(void);
+    virtual bool is_verify_running(void);
+    virtual bool finish_verify(std::vector<rvs_gemm_mismatch>* mismatches);
+    //! returns the number of verifications started so far
+    uint64_t get_num_verify(void) { return num_verify; }
+
+    virtual bool init_async_copy(void);
+    //! returns TRUE if copy_data_to_gpu() uploads asynchronously
+    bool is_async_copy(void) { return is_copy_init; }
+
+    //! sets the way the host waits for GEMM completion (before the first
+    //! GEMM is enqueued)
+    void set_gemm_wait(gemm_wait_t _gemm_wait) { gemm_wait = _gemm_wait; }
+    //! returns the way the host waits for GEMM completion
+    gemm_wait_t get_gemm_wait(void) { return gemm_wait; }
+
+    static int str2gemm_wait(const std::string& str, gemm_wait_t* pwait);
+    static std::string gemm_wait2str(gemm_wait_t wait);
+    static bool is_ops_type_valid(const std::string& ops_type);
+
+ protected:
+    rvs_blas(int _m, int _n, int _k, const std::string& _ops_type,
+             int _batch_count, int _num_streams, int _num_inflight);
 
  protected:
     //! GPU device index
@@ -78,64 +386,82 @@ class rvs_blas {
     rocblas_int n;
     //! matrix size k
     rocblas_int k;
+    //! GEMM type (only the matrices of this precision are allocated)
+    std::string ops_type;
+    //! seed of the random matrix data
+    uint64_t seed;
     //! amount of memory to allocate for the matrix
     rocblas_int size_a;
     //! amount of memory to allocate for the matrix
     rocblas_int size_b;
     //! amount of memory to allocate for the matrix
     rocblas_int size_c;
+    //! number of GEMMs per launch
+    int batch_count;
+    //! number of streams used by the pipelined submission
+    int num_streams;
+    //! max number of GEMM launches kept in flight
+    int num_inflight;
 
-    //SGEMM DECLARAION
-    //! pointer to device (GPU) memory
-    float *da;
-    //! pointer to device (GPU) memory
-    float *db;
-    //! pointer to device (GPU) memory
-    float *dc;
-    //! pointer to host memory
-    float *ha;
-    //! pointer to host memory
-    float *hb;
-    //! pointer to host memory
-    float *hc;
-
-    //DGEMM Declaration
-    //! pointer to device (GPU) memory
-    double *ddbla;
-    //! pointer to device (GPU) memory
-    double *ddblb;
-    //! pointer to device (GPU) memory
-    double *ddblc;
-    //! pointer to host memory
-    double *hdbla;
-    //! pointer to host memory
-    double *hdblb;
-    //! pointer to host memory
-    double *hdblc;
-
-    //HGEMM Declaration
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfa;
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfb;
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfc;
-    //! pointer to host memory
-    rocblas_half *hhlfa;
-    //! pointer to host memory
-    rocblas_half *hhlfb;
-    //! pointer to host memory
-    rocblas_half *hhlfc;
-
-    rocblas_half  hostarrayA;
-    rocblas_half  hostarrayB;
-    rocblas_half  hostarrayC;
-
-
-
+    //! typed GEMM engine (selected once, based on ops_type)
+    std::unique_ptr<rvs_gemm_engine> engine;
 
     //! HIP API stream - used to query for GEMM completion
     hipStream_t hip_stream;
+    //! event recorded on hip_stream right before the last GEMM
+    hipEvent_t gemm_start_event;
+    //! event recorded on hip_stream right after the last GEMM
+    hipEvent_t gemm_stop_event;
+    //! TRUE if the GEMM events were successfully created
+    bool is_event_init;
+    //! streams used by the pipelined submission
+    std::vector<hipStream_t> gemm_streams;
+    //! completion event of each in-flight slot (pipelined submission)
+    std::vector<hipEvent_t> slot_stop_events;
+    //! reference event for the completion timestamps
+    hipEvent_t timeline_event;
+    //! TRUE if timeline_event was successfully created
+    bool is_timeline_init;
+    //! stream the rocBlas handle currently submits to
+    hipStream_t cur_stream;
+    //! number of GEMM launches submitted since start_gemm_timeline()
+    uint64_t num_submitted;
+    //! number of GEMM launches completed since start_gemm_timeline()
+    uint64_t num_completed;
+    //! completion time of the last GEMM waited for by wait_oldest_gemm()
+    double last_completion_ms;
+    //! the way the host waits for GEMM completion
+    gemm_wait_t gemm_wait;
+    //! signalled after each waited for GEMM event (GEMM_WAIT_BLOCKING_SYNC)
+    std::shared_ptr<rvs_gemm_notifier> notifier;
+    //! TRUE if the result verification was initialized
+    bool is_verify_init;
+    //! number of C tiles sampled by each verification
+    int verify_num_tiles;
+    //! number of verifications started so far
+    uint64_t num_verify;
+    //! batch entry checked by the current verification
+    int verify_batch;
+    //! tiles checked by the current verification
+    std::vector<rvs_gemm_tile> verify_tiles;
+    //! out of tolerance elements found by the current verification
+    std::vector<rvs_gemm_mismatch> verify_mismatches;
+    //! event recorded after the sampled tiles were copied to the host
+    hipEvent_t verify_event;
+    //! host side of the current verification
+    std::future<bool> verify_result;
+    //! TRUE if the asynchronous upload was initialized
+    bool is_copy_init;
+    //! stream the asynchronous uploads are enqueued on
+    hipStream_t copy_stream;
+    //! per device copy: recorded after its upload
+    hipEvent_t copy_done_events[RVS_BLAS_COPY_BUFS];
+    //! per device copy: recorded after the last GEMM that read it
+    hipEvent_t buf_free_events[RVS_BLAS_COPY_BUFS];
+    //! number of asynchronous uploads enqueued so far
+    uint64_t num_copies;
+    //! device copy of the matrices the next GEMM uses
+    int gemm_buf;
     //! rocBlas related handle
     rocblas_handle blas_handle;
     //! TRUE is rocBlas handle was successfully initialized
@@ -144,12 +470,17 @@ class rvs_blas {
     bool is_error;
 
     bool init_gpu_device(void);
-    bool allocate_gpu_matrix_mem(void);
-    void release_gpu_matrix_mem(void);
-
-    bool alocate_host_matrix_mem(void);
-    void release_host_matrix_mem(void);
-    float fast_pseudo_rand(u_long *nextr);
+    bool init_gemm_streams(void);
+    bool record_gemm_event(hipEvent_t event, hipStream_t stream,
+                           bool waited = false);
+    bool select_stream(hipStream_t stream);
+    bool acquire_gemm_buf(hipStream_t stream);
+    bool release_gemm_buf(hipStream_t stream);
+    bool wait_event(hipEvent_t event);
+    bool wait_event_notified(hipEvent_t event);
+    static void notify_gemm_event(void* data);
+    bool check_verify(void);
+    void release_gpu_resources(void);
 };
 
 #endif  // INCLUDE_RVS_BLAS_H_
@@ -0,0 +1,97 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_CANCEL_H_
+#define INCLUDE_RVS_CANCEL_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace rvs {
+
+/**
+ * @class cancel_token
+ * @ingroup RVS
+ *
+ * @brief process wide stop request
+ *
+ * cancel() is called once, when a module requests RVS to stop (e.g.: gm on
+ * a bounds violation with terminate: true). Polling it is a single atomic
+ * load, so busy loops can check it every iteration. Threads that sleep can
+ * wait on it instead (wait_for()) and the primitives that sleep on their own
+ * condition variable (e.g.: rvs::timer) register a waker that cancel() runs
+ * to wake them up right away.
+ *
+ * The token of the process lives in the launcher. Each module has its own
+ * copy of rvslib, so rvs::lp::Initialize() points process() of the module
+ * to the launcher token.
+ *
+ */
+class cancel_token {
+ public:
+  //! waker callback
+  typedef std::function<void()> waker_t;
+
+  cancel_token();
+
+  void cancel(void);
+  void reset(void);
+  //! returns TRUE once cancel() was called
+  bool cancelled(void) const { return flag.load(std::memory_order_acquire); }
+  bool wait_for(uint64_t ns);
+  //! returns the steady clock time cancel() was called at (ns, 0 if not)
+  uint64_t get_cancel_ns(void) const { return cancel_ns.load(); }
+  uint64_t get_latency_ns(void) const;
+  int add_waker(const waker_t& cb);
+  void remove_waker(int id);
+
+  static cancel_token* process(void);
+  static void set_process(cancel_token* token);
+  static uint64_t now_ns(void);
+
+ protected:
+  //! TRUE once cancel() was called
+  std::atomic<bool> flag;
+  //! time cancel() was called (ns)
+  std::atomic<uint64_t> cancel_ns;
+  //! guards wakers and the condition variable
+  std::mutex mtx;
+  //! wakes wait_for()
+  std::condition_variable cv;
+  //! wakers by id
+  std::map<int, waker_t> wakers;
+  //! id of the next waker
+  int next_id;
+  //! token process() returns
+  static cancel_token* current;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_CANCEL_H_
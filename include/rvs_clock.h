@@ -0,0 +1,121 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_CLOCK_H_
+#define INCLUDE_RVS_CLOCK_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace rvs {
+
+/**
+ * @class clock
+ * @ingroup RVS
+ *
+ * @brief time source of the workers
+ *
+ * Workers read the time and sleep only through a clock, so the same control
+ * logic runs either in real time (clock::real()) or on a virtual_clock, which
+ * lets a simulated test of several minutes complete in a fraction of a
+ * second.
+ *
+ */
+class clock {
+ public:
+  virtual ~clock() {}
+
+  //! returns the current time (ns, arbitrary origin)
+  virtual uint64_t now_ns(void) = 0;
+  //! sleeps until the given time
+  virtual void sleep_until_ns(uint64_t deadline_ns) = 0;
+  //! waits until the given time without giving up the CPU (a plain sleep
+  //! unless the clock can do better)
+  virtual void spin_until_ns(uint64_t deadline_ns) {
+    sleep_until_ns(deadline_ns);
+  }
+  virtual void wait_until_ns(std::condition_variable* cv,
+                             std::unique_lock<std::mutex>* lk,
+                             uint64_t deadline_ns);
+
+  //! returns the current time in ms
+  uint64_t now_ms(void) { return now_ns() / 1000000; }
+  //! sleeps for the given number of ns
+  void sleep_for_ns(uint64_t ns) { sleep_until_ns(now_ns() + ns); }
+  //! sleeps for the given number of ms
+  void sleep_for_ms(uint64_t ms) { sleep_for_ns(ms * 1000000); }
+
+  static clock* real(void);
+};
+
+/**
+ * @class mono_clock
+ * @ingroup RVS
+ *
+ * @brief real time clock: CLOCK_MONOTONIC, absolute clock_nanosleep()
+ *
+ */
+class mono_clock : public clock {
+ public:
+  virtual uint64_t now_ns(void);
+  virtual void sleep_until_ns(uint64_t deadline_ns);
+  virtual void spin_until_ns(uint64_t deadline_ns);
+  virtual void wait_until_ns(std::condition_variable* cv,
+                             std::unique_lock<std::mutex>* lk,
+                             uint64_t deadline_ns);
+};
+
+/**
+ * @class virtual_clock
+ * @ingroup RVS
+ *
+ * @brief simulated time: sleeping moves the time forward to the deadline
+ * right away
+ *
+ * Used with a single worker thread the sequence of times it observes is
+ * fully deterministic. The time only moves forward, so concurrent sleepers
+ * are safe but the interleaving depends on the scheduling.
+ *
+ */
+class virtual_clock : public clock {
+ public:
+  explicit virtual_clock(uint64_t start_ns = 0) : time_ns(start_ns) {}
+
+  virtual uint64_t now_ns(void) { return time_ns.load(); }
+  virtual void sleep_until_ns(uint64_t deadline_ns);
+  //! moves the time forward by the given number of ns
+  void advance_ns(uint64_t ns) { sleep_until_ns(now_ns() + ns); }
+
+ protected:
+  //! current time
+  std::atomic<uint64_t> time_ns;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_CLOCK_H_
@@ -0,0 +1,79 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_HISTOGRAM_H_
+#define INCLUDE_RVS_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace rvs {
+
+/**
+ * @class histogram
+ * @ingroup RVS
+ *
+ * @brief log-linear histogram of non-negative integer samples (e.g.: GEMM
+ * durations in ns)
+ *
+ * Each power of two is split in RVS_HISTOGRAM_SUB_BUCKETS linear buckets, so
+ * any value is kept with a relative error below 1 / RVS_HISTOGRAM_SUB_BUCKETS
+ * (3%) in a fixed amount of memory. Adding a sample is O(1); the
+ * percentiles walk the buckets.
+ *
+ */
+class histogram {
+ public:
+  histogram();
+
+  void add(uint64_t value);
+  void reset(void);
+  uint64_t percentile(double p) const;
+
+  //! returns the number of samples
+  uint64_t count(void) const { return num_samples; }
+  //! returns the smallest sample (0 if empty)
+  uint64_t min(void) const { return num_samples ? min_value : 0; }
+  //! returns the largest sample (0 if empty)
+  uint64_t max(void) const { return max_value; }
+
+  static int bucket(uint64_t value);
+  static uint64_t bucket_low(int idx);
+  static uint64_t bucket_high(int idx);
+
+ protected:
+  //! sample count of each bucket
+  std::vector<uint64_t> buckets;
+  //! number of samples
+  uint64_t num_samples;
+  //! smallest sample
+  uint64_t min_value;
+  //! largest sample
+  uint64_t max_value;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_HISTOGRAM_H_
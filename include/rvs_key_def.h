@@ -41,6 +41,9 @@
 #define RVS_CONF_B2B_BLOCK_SIZE_KEY     "b2b_block_size"
 #define RVS_CONF_LINK_TYPE_KEY          "link_type"
 #define RVS_CONF_MONITOR_KEY            "monitor"
+#define RVS_CONF_HOST_MEMORY_KEY        "host_memory"
+#define RVS_CONF_GEMM_WAIT_KEY          "gemm_wait"
+#define RVS_CONF_SEED_KEY               "seed"
 
 #define DEFAULT_LOG_INTERVAL (1000u)
 #define DEFAULT_DURATION (10000u)
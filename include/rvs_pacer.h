@@ -0,0 +1,128 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_PACER_H_
+#define INCLUDE_RVS_PACER_H_
+
+#include <stdint.h>
+
+#include "include/rvs_clock.h"
+
+namespace rvs {
+
+/**
+ * @class pid
+ * @ingroup RVS
+ *
+ * @brief PID controller with output limits
+ *
+ * The integral is only accumulated while the output is not saturated in the
+ * direction of the error (conditional integration), so a controller that was
+ * pinned at a limit does not wind up and overshoot when it comes back.
+ *
+ */
+class pid {
+ public:
+  pid(double _kp, double _ki, double _kd, double _out_min, double _out_max);
+
+  void set_limits(double _out_min, double _out_max);
+  void reset(double _output);
+  double update(double error, double dt);
+  //! returns the last controller output
+  double output(void) const { return out; }
+
+ protected:
+  //! proportional gain
+  double kp;
+  //! integral gain (1/s)
+  double ki;
+  //! derivative gain (s)
+  double kd;
+  //! lowest output
+  double out_min;
+  //! highest output
+  double out_max;
+  //! integral term (already multiplied by ki)
+  double integral;
+  //! error given to the previous update()
+  double prev_error;
+  //! TRUE if prev_error is valid
+  bool has_prev;
+  //! last output
+  double out;
+};
+
+/**
+ * @class pacer
+ * @ingroup RVS
+ *
+ * @brief paces a periodic activity on absolute deadlines
+ *
+ * Each wait sleeps until the previous deadline plus the period (on the real
+ * clock: clock_nanosleep() on CLOCK_MONOTONIC with TIMER_ABSTIME), so the
+ * time spent between two waits does not add up to the period and the rate
+ * does not drift. If the caller fell more than one period behind, the
+ * schedule is restarted from the current time instead of bursting to catch
+ * up. With set_spin() the last part of each wait is spent polling the clock,
+ * which trades a busy core for a wake-up that is not delayed by the
+ * scheduler.
+ *
+ */
+class pacer {
+ public:
+  explicit pacer(clock* _clk = clock::real());
+
+  //! sets the clock the deadlines are measured on
+  void set_clock(clock* _clk) { clk = _clk; start(); }
+  //! sets how long (ns) before each deadline the wait stops sleeping and
+  //! polls the clock (0 = sleep all the way)
+  void set_spin(uint64_t _spin_ns) { spin_ns = _spin_ns; }
+  void start(void);
+  void wait_next(double period_ms);
+  //! returns the number of waits that found their deadline already passed
+  uint64_t get_late_count(void) const { return late_count; }
+  //! returns the deadline the last wait_next() slept until (ns)
+  uint64_t get_deadline(void) const { return deadline; }
+
+  //! returns the current real (CLOCK_MONOTONIC) time in ns
+  static uint64_t now_ns(void) { return clock::real()->now_ns(); }
+  //! sleeps until the given real (CLOCK_MONOTONIC) time
+  static void sleep_until_ns(uint64_t deadline_ns) {
+    clock::real()->sleep_until_ns(deadline_ns);
+  }
+
+ protected:
+  //! time source
+  clock* clk;
+  //! last deadline (ns)
+  uint64_t deadline;
+  //! number of waits that found their deadline already passed
+  uint64_t late_count;
+  //! time before each deadline spent polling the clock (ns)
+  uint64_t spin_ns;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_PACER_H_
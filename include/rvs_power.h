@@ -0,0 +1,67 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_POWER_H_
+#define INCLUDE_RVS_POWER_H_
+
+#include <stdint.h>
+
+namespace rvs {
+
+/**
+ * @class power_reader
+ * @ingroup RVS
+ *
+ * @brief source of the GPU power readings
+ *
+ * The power based workers only read the power through this interface, so a
+ * simulated device (see rvs_sim.h) can stand in for ROCm SMI.
+ *
+ */
+class power_reader {
+ public:
+  virtual ~power_reader() {}
+
+  //! reads the average power (in microwatts) of the device with the given
+  //! ROCm SMI index; returns false if no reading is available
+  virtual bool read_power_uw(uint32_t dev_ix, uint64_t *power) = 0;
+
+  static power_reader* rsmi(void);
+};
+
+/**
+ * @class rsmi_power_reader
+ * @ingroup RVS
+ *
+ * @brief power readings from ROCm SMI (rsmi_dev_power_ave_get())
+ *
+ */
+class rsmi_power_reader : public power_reader {
+ public:
+  virtual bool read_power_uw(uint32_t dev_ix, uint64_t *power);
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_POWER_H_
@@ -0,0 +1,160 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_RAND_H_
+#define INCLUDE_RVS_RAND_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace rvs {
+namespace rand {
+
+//! minimum number of elements a fill thread gets (smaller buffers are
+//! filled by fewer threads)
+#define RVS_RAND_MIN_ELEMS_PER_THREAD   (1 << 20)
+
+/**
+ * @brief counter based generator (SplitMix64 finalizer applied to
+ * seed + counter)
+ *
+ * The value only depends on (seed, counter), so any range of a random
+ * sequence can be computed independently: the fill loops below vectorize and
+ * can be split across threads while still giving the same output for a given
+ * seed.
+ *
+ * @param seed sequence seed
+ * @param counter index of the value in the sequence
+ * @return 64 random bits
+ */
+inline uint64_t counter_hash(uint64_t seed, uint64_t counter) {
+  uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief returns a float uniformly distributed in [-1, 1)
+ * @param seed sequence seed
+ * @param counter index of the value in the sequence
+ * @return random float
+ */
+inline float uniform_float(uint64_t seed, uint64_t counter) {
+  // 24 random bits fill the float mantissa exactly
+  return static_cast<float>(counter_hash(seed, counter) >> 40) *
+           (2.0f / 16777216.0f) - 1.0f;
+}
+
+/**
+ * @brief returns a double uniformly distributed in [-1, 1)
+ * @param seed sequence seed
+ * @param counter index of the value in the sequence
+ * @return random double
+ */
+inline double uniform_double(uint64_t seed, uint64_t counter) {
+  // 53 random bits fill the double mantissa exactly
+  return static_cast<double>(counter_hash(seed, counter) >> 11) *
+           (2.0 / 9007199254740992.0) - 1.0;
+}
+
+/**
+ * @brief returns an int8 uniformly distributed in [-64, 63]
+ *
+ * The range is kept at half of int8 so the int32 accumulation of the int8
+ * GEMM cannot overflow for any practical k.
+ *
+ * @param seed sequence seed
+ * @param counter index of the value in the sequence
+ * @return random int8
+ */
+inline int8_t uniform_int8(uint64_t seed, uint64_t counter) {
+  return static_cast<int8_t>(static_cast<int>(counter_hash(seed, counter) >> 57)
+                             - 64);
+}
+
+uint16_t float_to_half(float value);
+uint16_t float_to_bfloat16(float value);
+float half_to_float(uint16_t value);
+
+/**
+ * @brief converts bfloat16 bits to float (exact)
+ * @param value bfloat16 bits
+ * @return float value
+ */
+inline float bfloat16_to_float(uint16_t value) {
+  uint32_t x = static_cast<uint32_t>(value) << 16;
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+uint64_t new_seed(void);
+
+/**
+ * @brief fills buf[i] = value_at(i) for i in [0, count) using up to
+ * max_threads threads
+ *
+ * Each thread fills one contiguous slice, so the result does not depend on
+ * the number of threads as long as value_at(i) only depends on i.
+ *
+ * @param buf buffer to fill
+ * @param count number of elements
+ * @param value_at functor returning the element for a given index
+ * @param max_threads maximum number of threads (0 = hardware concurrency)
+ */
+template <typename T, typename F>
+void parallel_fill(T* buf, uint64_t count, F value_at,
+                   unsigned int max_threads = 0) {
+  uint64_t nthreads = max_threads ? max_threads
+                                  : std::thread::hardware_concurrency();
+  nthreads = std::min<uint64_t>(nthreads,
+                                count / RVS_RAND_MIN_ELEMS_PER_THREAD);
+  if (nthreads < 2) {
+    for (uint64_t i = 0; i < count; i++)
+      buf[i] = value_at(i);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  uint64_t slice = (count + nthreads - 1) / nthreads;
+  for (uint64_t t = 0; t < nthreads; t++) {
+    uint64_t begin = t * slice;
+    uint64_t end = std::min(begin + slice, count);
+    threads.push_back(std::thread([buf, begin, end, value_at]() {
+      for (uint64_t i = begin; i < end; i++)
+        buf[i] = value_at(i);
+    }));
+  }
+  for (auto& th : threads)
+    th.join();
+}
+
+}  // namespace rand
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_RAND_H_
@@ -0,0 +1,109 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_RING_H_
+#define INCLUDE_RVS_RING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <vector>
+
+namespace rvs {
+
+/**
+ * @class spsc_ring
+ * @ingroup RVS
+ *
+ * @brief bounded lock-free single producer / single consumer queue
+ *
+ * One thread calls push(), one (other) thread calls pop(); neither ever
+ * blocks. The capacity is rounded up to a power of two. When the ring is
+ * full push() fails and the element is counted as dropped, so a slow
+ * consumer never stalls the producer.
+ *
+ */
+template <typename T>
+class spsc_ring {
+ public:
+  //! @param capacity minimum number of elements the ring can hold
+  explicit spsc_ring(size_t capacity) : head(0), tail(0), dropped(0) {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    slots.resize(size);
+    mask = size - 1;
+  }
+
+  //! appends an element (producer side); returns false if the ring is full
+  bool push(const T& value) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > mask) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slots[h & mask] = value;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! removes the oldest element (consumer side); returns false if empty
+  bool pop(T* value) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+      return false;
+    *value = slots[t & mask];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! returns the number of queued elements (exact only on the consumer side)
+  size_t size(void) const {
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+  }
+  //! returns the number of elements the ring can hold
+  size_t capacity(void) const { return mask + 1; }
+  //! returns the number of elements push() had to drop
+  uint64_t get_dropped(void) const {
+    return dropped.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  //! element storage
+  std::vector<T> slots;
+  //! capacity - 1
+  size_t mask;
+  //! next slot to write (only written by the producer)
+  std::atomic<size_t> head;
+  //! next slot to read (only written by the consumer)
+  std::atomic<size_t> tail;
+  //! number of elements dropped because the ring was full
+  std::atomic<uint64_t> dropped;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_RING_H_
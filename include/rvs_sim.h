@@ -0,0 +1,164 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_SIM_H_
+#define INCLUDE_RVS_SIM_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/rvs_blas.h"
+#include "include/rvs_clock.h"
+#include "include/rvs_power.h"
+
+namespace rvs {
+
+/**
+ * @brief performance/power model of a simulated GPU
+ */
+struct sim_model {
+  sim_model() : peak_gflops(10000), launch_us(10), idle_power(40),
+                max_power(300), power_tau_ms(50), jitter(0), seed(0) {}
+
+  //! GEMM throughput (Gflops, Gops for integer GEMMs)
+  double peak_gflops;
+  //! fixed cost (us) of each GEMM launch
+  double launch_us;
+  //! power (W) of the idle GPU
+  double idle_power;
+  //! power (W) of the GPU busy all the time
+  double max_power;
+  //! time constant (ms) of the first order power response
+  double power_tau_ms;
+  //! relative GEMM time jitter (0.05 = +/-5%)
+  double jitter;
+  //! seed of the jitter sequence
+  uint64_t seed;
+};
+
+/**
+ * @class sim_device
+ * @ingroup RVS
+ *
+ * @brief simulated GPU: a single in-order queue of GEMMs and a power model
+ *
+ * GEMMs run back to back, each for launch_us + gflop / peak_gflops. The power
+ * follows idle_power + (max_power - idle_power) * busy fraction through a
+ * first order filter. Everything is computed from the times of the given
+ * clock, so on a virtual_clock the results are deterministic.
+ *
+ */
+class sim_device : public power_reader {
+ public:
+  sim_device(const sim_model& _model, clock* _clk);
+
+  void submit(double gflop, uint64_t *start_ns, uint64_t *end_ns);
+  double get_power(void);
+  virtual bool read_power_uw(uint32_t dev_ix, uint64_t *power);
+  //! returns the clock the device runs on
+  clock* get_clock(void) { return clk; }
+  //! returns the model of the device
+  const sim_model& get_model(void) { return model; }
+
+ protected:
+  void update_power(uint64_t now);
+
+ protected:
+  //! guards the device state (GEMMs and power readings may come from
+  //! different threads)
+  std::mutex mtx;
+  //! performance/power model
+  sim_model model;
+  //! time source
+  clock* clk;
+  //! end of the last queued GEMM
+  uint64_t busy_until;
+  //! [start, end) of the GEMMs the power model did not consume yet
+  std::deque<std::pair<uint64_t, uint64_t>> busy;
+  //! time of the last power update
+  uint64_t power_ns;
+  //! filtered power (W)
+  double power;
+  //! number of GEMMs submitted (index of the jitter sequence)
+  uint64_t num_gemms;
+};
+
+}  // namespace rvs
+
+/**
+ * @class rvs_blas_sim
+ * @ingroup GST
+ *
+ * @brief rvs_blas on a simulated device
+ *
+ * No GPU memory or rocBlas handle is used: the GEMM launches are queued on a
+ * rvs::sim_device and their completion times come from its model. The
+ * result verification always passes.
+ *
+ */
+class rvs_blas_sim : public rvs_blas {
+ public:
+  rvs_blas_sim(rvs::sim_device* _dev, int _m, int _n, int _k,
+               const std::string& _ops_type, int _batch_count = 1,
+               int _num_streams = 1, int _num_inflight = 1);
+
+  virtual bool is_integer_op(void) { return ops_type == "i8gemm"; }
+  virtual void generate_random_matrix_data(uint64_t _seed) { seed = _seed; }
+  virtual bool copy_data_to_gpu(void) { return !is_error; }
+  virtual bool init_async_copy(void) { return !is_error; }
+  virtual bool run_blass_gemm(void);
+  virtual bool is_gemm_op_complete(void);
+  virtual bool wait_gemm_op_complete(void);
+  virtual double get_gemm_op_time_ms(void);
+
+  virtual bool start_gemm_timeline(void);
+  virtual bool enqueue_gemm(void);
+  virtual bool wait_oldest_gemm(void);
+
+  virtual bool init_verify(int _num_tiles);
+  virtual bool start_verify(void);
+  virtual bool is_verify_running(void) { return false; }
+  virtual bool finish_verify(std::vector<rvs_gemm_mismatch>* mismatches);
+
+ protected:
+  //! simulated device
+  rvs::sim_device* dev;
+  //! start of the last GEMM run by run_blass_gemm()
+  uint64_t gemm_start_ns;
+  //! end of the last GEMM run by run_blass_gemm()
+  uint64_t gemm_end_ns;
+  //! start of the GEMM timeline
+  uint64_t timeline_ns;
+  //! completion times of the in-flight launches (pipelined submission)
+  std::deque<uint64_t> inflight_end_ns;
+  //! TRUE if the result verification was initialized
+  bool sim_verify_init;
+};
+
+#endif  // INCLUDE_RVS_SIM_H_
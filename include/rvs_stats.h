@@ -0,0 +1,240 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_STATS_H_
+#define INCLUDE_RVS_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace rvs {
+
+/**
+ * @class moving_average
+ * @ingroup RVS
+ *
+ * @brief mean of the samples taken within a sliding time window (e.g.: the
+ * 1 minute average power)
+ *
+ * A running sum is updated as samples enter and leave the window, so each
+ * sample costs O(1) (amortized) whatever the window length. The sum is
+ * recomputed from the window contents every so often so that the rounding
+ * error of the additions and subtractions cannot build up over long runs.
+ *
+ */
+class moving_average {
+ public:
+  explicit moving_average(uint64_t _window_ns);
+
+  void add(uint64_t t_ns, double value);
+  void reset(void);
+  //! returns the mean of the samples in the window (0 if empty)
+  double mean(void) const {
+    return samples.empty() ? 0 : sum / samples.size();
+  }
+  //! returns the number of samples in the window
+  size_t count(void) const { return samples.size(); }
+  //! returns the window length (ns)
+  uint64_t get_window(void) const { return window_ns; }
+
+ protected:
+  //! window length (ns)
+  uint64_t window_ns;
+  //! samples within the window, oldest first
+  std::deque<std::pair<uint64_t, double> > samples;
+  //! sum of the sample values
+  double sum;
+  //! samples added since sum was last recomputed
+  uint64_t since_resum;
+};
+
+/**
+ * @class linear_rls
+ * @ingroup RVS
+ *
+ * @brief online fit of y = offset + slope * x (recursive least squares)
+ *
+ * Each sample updates the fit in O(1). Older samples are weighted down by the
+ * forgetting factor (1 = all samples count the same), so the fit follows a
+ * relation that drifts (e.g.: the GPU power at a given load as the GPU heats
+ * up) or is only locally linear.
+ *
+ */
+class linear_rls {
+ public:
+  explicit linear_rls(double _forgetting = 1.0);
+
+  void add(double x, double y);
+  void reset(void);
+  bool solve(double y, double *x) const;
+  //! returns the y value the fit predicts for x
+  double predict(double x) const { return offset + slope * x; }
+  //! returns the fitted y for x = 0
+  double get_offset(void) const { return offset; }
+  //! returns the fitted dy/dx
+  double get_slope(void) const { return slope; }
+  //! returns the number of samples added since the last reset
+  uint64_t count(void) const { return num_samples; }
+
+ protected:
+  //! forgetting factor (0 < forgetting <= 1)
+  double forgetting;
+  //! fitted y for x = 0
+  double offset;
+  //! fitted dy/dx
+  double slope;
+  //! inverse correlation matrix of [1, x] ([p00 p01; p01 p11])
+  double p00, p01, p11;
+  //! number of samples added since the last reset
+  uint64_t num_samples;
+};
+
+/**
+ * @class running_stats
+ * @ingroup RVS
+ *
+ * @brief count, mean, variance, min and max of a stream of samples
+ *
+ * Welford's update keeps the variance accurate over long runs (no sum of
+ * squares to cancel out) in O(1) memory. Two instances can be merged, e.g.:
+ * to summarize several GPUs.
+ *
+ */
+class running_stats {
+ public:
+  running_stats() { reset(); }
+
+  void add(double x);
+  void merge(const running_stats& other);
+  void reset(void);
+  //! returns the number of samples
+  uint64_t count(void) const { return n; }
+  //! returns the mean of the samples (0 if none)
+  double mean(void) const { return avg; }
+  //! returns the sample variance (0 if fewer than 2 samples)
+  double variance(void) const { return n > 1 ? m2 / (n - 1) : 0; }
+  double stddev(void) const;
+  //! returns the smallest sample (0 if none)
+  double min(void) const { return n ? lo : 0; }
+  //! returns the largest sample (0 if none)
+  double max(void) const { return n ? hi : 0; }
+
+ protected:
+  //! number of samples
+  uint64_t n;
+  //! mean of the samples
+  double avg;
+  //! sum of the squared differences from the mean
+  double m2;
+  //! smallest sample
+  double lo;
+  //! largest sample
+  double hi;
+};
+
+/**
+ * @class ewma
+ * @ingroup RVS
+ *
+ * @brief exponentially weighted moving average
+ *
+ * Each sample moves the average by alpha times its difference from it; the
+ * first sample sets it.
+ *
+ */
+class ewma {
+ public:
+  explicit ewma(double _alpha = 0.1) : alpha(_alpha) { reset(); }
+
+  void add(double x);
+  //! drops the average
+  void reset(void) { avg = 0; has_value = false; }
+  //! sets the weight of a new sample (0 < alpha <= 1)
+  void set_alpha(double _alpha) { alpha = _alpha; }
+  //! returns the average (0 if no sample was added)
+  double value(void) const { return avg; }
+
+ protected:
+  //! weight of a new sample
+  double alpha;
+  //! current average
+  double avg;
+  //! TRUE once a sample was added
+  bool has_value;
+};
+
+/**
+ * @class tdigest
+ * @ingroup RVS
+ *
+ * @brief mergeable sketch of a distribution for quantile estimates
+ *
+ * Samples are buffered and periodically merged into a sorted list of
+ * centroids (mean, weight). Centroids near the median may absorb many samples
+ * while those in the tails stay small, so the extreme quantiles (p99, p99.9)
+ * remain accurate. Memory is bounded by the compression (roughly that many
+ * centroids) whatever the number of samples, and digests of different GPUs or
+ * runs can be merged.
+ *
+ */
+class tdigest {
+ public:
+  explicit tdigest(double _compression = 100);
+
+  void add(double x, double w = 1);
+  void merge(const tdigest& other);
+  void reset(void);
+  double quantile(double q);
+  //! returns the total weight of the samples
+  double count(void) const { return total; }
+  //! returns the number of centroids (after the buffered samples are merged)
+  size_t size(void) { compress(); return centroids.size(); }
+
+ protected:
+  void compress(void);
+
+  //! centroid: mean and weight
+  typedef std::pair<double, double> centroid;
+
+  //! compression (larger is more accurate and uses more memory)
+  double compression;
+  //! centroids, sorted by mean
+  std::vector<centroid> centroids;
+  //! samples added since the last compress()
+  std::vector<centroid> buffer;
+  //! total weight (centroids and buffer)
+  double total;
+  //! smallest sample
+  double lo;
+  //! largest sample
+  double hi;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_STATS_H_
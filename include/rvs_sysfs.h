@@ -0,0 +1,124 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_SYSFS_H_
+#define INCLUDE_RVS_SYSFS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+
+//! sysfs mount point
+#define RVS_SYSFS_ROOT                  "/sys"
+//! size of the sysfs attribute read buffer (pp_dpm_* tables included)
+#define RVS_SYSFS_BUF_SIZE              512
+
+namespace rvs {
+
+bool sysfs_parse_int(const char* s, int64_t* value);
+bool sysfs_parse_dpm(const char* s, int64_t* mhz);
+
+/**
+ * @class sysfs_attr
+ * @ingroup RVS
+ *
+ * @brief sysfs attribute kept open and read again with pread()
+ *
+ * Opening a sysfs attribute costs a path lookup each time, reading it again
+ * from offset 0 only runs the driver's show() function. The value goes to a
+ * fixed buffer: nothing is allocated per read.
+ *
+ */
+class sysfs_attr {
+ public:
+  sysfs_attr();
+  ~sysfs_attr();
+
+  bool open(const std::string& path);
+  void close(void);
+  //! returns true if the attribute is open
+  bool is_open(void) const { return fd >= 0; }
+  const char* read(void);
+  bool read_int(int64_t* value);
+
+ protected:
+  //! attribute file descriptor (-1 = not open)
+  int fd;
+  //! last value read (NUL terminated)
+  char buf[RVS_SYSFS_BUF_SIZE];
+
+ private:
+  sysfs_attr(const sysfs_attr&);
+  sysfs_attr& operator=(const sysfs_attr&);
+};
+
+/**
+ * @class gpu_sysfs
+ * @ingroup RVS
+ *
+ * @brief reads the metrics of one GPU straight from its amdgpu/hwmon sysfs
+ * attributes (the same ones ROCm SMI reads), opened once
+ *
+ */
+class gpu_sysfs {
+ public:
+  //! GPU metrics
+  typedef enum {
+    //! edge temperature (millidegrees C)
+    SYSFS_TEMP,
+    //! current GPU clock (MHz)
+    SYSFS_SCLK,
+    //! current memory clock (MHz)
+    SYSFS_MCLK,
+    //! fan speed (PWM duty, 0..255 as ROCm SMI reports it)
+    SYSFS_FAN,
+    //! average power (uW)
+    SYSFS_POWER,
+    //! number of metrics
+    SYSFS_NUM_METRICS
+  } metric_t;
+
+  explicit gpu_sysfs(const std::string& _device_path);
+
+  bool open(void);
+  //! returns true if the metric's attribute could be opened
+  bool has(metric_t metric) const { return attrs[metric].is_open(); }
+  bool read(metric_t metric, int64_t* value);
+  //! returns the PCI device directory
+  const std::string& get_device_path(void) const { return device_path; }
+
+  static std::string pci_device_path(uint64_t bdfid,
+                                     const std::string& sysfs = RVS_SYSFS_ROOT);
+
+ protected:
+  //! PCI device directory (e.g.: /sys/bus/pci/devices/0000:03:00.0)
+  std::string device_path;
+  //! one attribute per metric
+  sysfs_attr attrs[SYSFS_NUM_METRICS];
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_SYSFS_H_
@@ -0,0 +1,133 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_TIMER_WHEEL_H_
+#define INCLUDE_RVS_TIMER_WHEEL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "include/rvsthreadbase.h"
+
+//! default tick of the timer wheel (ns)
+#define RVS_TIMER_WHEEL_TICK_NS         1000000
+//! default number of slots of the timer wheel
+#define RVS_TIMER_WHEEL_SLOTS           256
+
+namespace rvs {
+
+/**
+ * @class timer_wheel
+ * @ingroup RVS
+ *
+ * @brief runs many timers on a single thread
+ *
+ * The timers are kept in a hashed wheel: a timer goes in the slot of its
+ * deadline tick (modulo the number of slots), so adding and cancelling are
+ * O(1) and the thread only looks at the slots it passes. It sleeps until
+ * the next non empty slot and wakes up right away when a timer is added or
+ * the wheel stopped. A timer fires at the end of its deadline tick (at most
+ * one tick late). Periodic timers fire at start + k * period, skipping the
+ * periods missed (e.g.: a slow callback) instead of shifting the next.
+ *
+ * The callbacks run on the wheel thread and must be short: a slow one
+ * delays all the other timers.
+ *
+ */
+class timer_wheel : public ThreadBase {
+ public:
+  //! timer callback
+  typedef std::function<void()> callback_t;
+
+  explicit timer_wheel(uint64_t _tick_ns = RVS_TIMER_WHEEL_TICK_NS,
+                       size_t _num_slots = RVS_TIMER_WHEEL_SLOTS);
+  virtual ~timer_wheel();
+
+  uint64_t add(uint64_t period_ns, const callback_t& cb, bool once = false);
+  bool cancel(uint64_t id);
+  void stop(void);
+  size_t size(void);
+
+  static timer_wheel& shared(void);
+
+ protected:
+  //! a timer
+  typedef struct entry {
+    //! timer ID (as returned by add())
+    uint64_t id;
+    //! next expiration (steady clock, ns)
+    uint64_t deadline_ns;
+    //! timer period (ns)
+    uint64_t period_ns;
+    //! true if the timer fires only once
+    bool once;
+    //! called on expiration
+    callback_t cb;
+  } entry;
+
+  virtual void run(void);
+  void insert(const entry& e);
+  void join_thread(std::unique_lock<std::mutex>* lk);
+  static uint64_t now_ns(void);
+
+ protected:
+  //! tick length (ns)
+  uint64_t tick_ns;
+  //! timers by deadline tick modulo the number of slots
+  std::vector<std::list<entry> > slots;
+  //! slot of each timer, by ID
+  std::unordered_map<uint64_t, size_t> slot_of;
+  //! IDs of the due timers whose callbacks did not run yet (cancel() drops
+  //! them from here)
+  std::unordered_set<uint64_t> pending;
+  //! first tick not processed yet
+  uint64_t cursor;
+  //! ID of the next timer
+  uint64_t next_id;
+  //! ID of the timer whose callback runs (0 = none)
+  uint64_t running_id;
+  //! true while the wheel thread runs
+  bool brun;
+  //! true while stop() or add() joins the wheel thread (without mtx)
+  bool joining;
+  //! protects the state above
+  std::mutex mtx;
+  //! wakes the wheel thread (new timer, stop)
+  std::condition_variable cv;
+  //! signaled when a callback returns or the wheel thread was joined
+  std::condition_variable cv_done;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_TIMER_WHEEL_H_
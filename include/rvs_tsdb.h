@@ -0,0 +1,287 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_TSDB_H_
+#define INCLUDE_RVS_TSDB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rvs {
+
+//! size of the file header and of each block of a time-series file (bytes)
+#define RVS_TS_BLOCK_SIZE               4096
+//! size of the block header (bytes)
+#define RVS_TS_BLOCK_HEADER             64
+//! max length of a metric name (bytes, including the terminating 0)
+#define RVS_TS_METRIC_LEN               32
+//! a block still being filled is written in place at least this often (ns)
+#define RVS_TS_SYNC_NS                  10000000000ull
+
+/**
+ * @brief one sample of a time series
+ */
+typedef struct ts_sample {
+  //! time of the sample (ns, CLOCK_MONOTONIC)
+  uint64_t t_ns;
+  //! sample value
+  double value;
+} ts_sample;
+
+/**
+ * @class ts_encoder
+ * @ingroup RVS
+ *
+ * @brief packs the samples of one series into a block of fixed capacity
+ *
+ * Timestamps are kept with us resolution and stored as the difference
+ * between consecutive deltas (delta-of-delta), which is 0, i.e. a single
+ * bit, for samples taken at a steady rate. Values are stored as the XOR with
+ * the previous value, i.e. a single bit for an unchanged value and only the
+ * changed bits otherwise. Typical GPU metrics take 1 to 4 bytes per sample.
+ *
+ */
+class ts_encoder {
+ public:
+  explicit ts_encoder(size_t _capacity);
+
+  void reset(void);
+  bool add(uint64_t t_ns, double value);
+  //! returns the number of samples in the block
+  uint32_t count(void) const { return num_samples; }
+  //! returns the time of the first sample (ns)
+  uint64_t first_ns(void) const { return first_us * 1000; }
+  //! returns the time of the last sample (ns)
+  uint64_t last_ns(void) const { return prev_us * 1000; }
+  //! returns the encoded bytes
+  const uint8_t* data(void) const { return buf.data(); }
+  //! returns the number of encoded bytes
+  size_t size(void) const { return (num_bits + 7) / 8; }
+
+ protected:
+  void put_bits(uint64_t bits, int n);
+
+ protected:
+  //! encoded samples
+  std::vector<uint8_t> buf;
+  //! number of bits written
+  size_t num_bits;
+  //! number of samples
+  uint32_t num_samples;
+  //! time of the first sample (us)
+  uint64_t first_us;
+  //! time of the previous sample (us)
+  uint64_t prev_us;
+  //! previous time delta (us)
+  int64_t prev_delta;
+  //! bits of the previous value
+  uint64_t prev_bits;
+  //! leading/trailing zero bits of the previous XOR window
+  int prev_lead, prev_trail;
+};
+
+/**
+ * @class ts_decoder
+ * @ingroup RVS
+ *
+ * @brief unpacks the samples written by ts_encoder
+ *
+ */
+class ts_decoder {
+ public:
+  ts_decoder(const uint8_t* _data, size_t _size, uint32_t _count);
+
+  bool next(ts_sample* sample);
+
+ protected:
+  bool get_bits(int n, uint64_t* bits);
+
+ protected:
+  //! encoded samples
+  const uint8_t* data;
+  //! number of encoded bits
+  size_t size_bits;
+  //! number of bits read
+  size_t pos;
+  //! number of encoded samples
+  uint32_t count;
+  //! number of samples read
+  uint32_t num_samples;
+  //! time of the previous sample (us)
+  uint64_t prev_us;
+  //! previous time delta (us)
+  int64_t prev_delta;
+  //! bits of the previous value
+  uint64_t prev_bits;
+  //! leading/trailing zero bits of the previous XOR window
+  int prev_lead, prev_trail;
+};
+
+/**
+ * @brief location and time range of a block (one entry of the file index)
+ */
+typedef struct ts_block_info {
+  //! GPU ID of the series
+  int32_t gpu_id;
+  //! metric name of the series
+  std::string metric;
+  //! block number (0 = first block after the file header)
+  uint32_t block;
+  //! number of samples in the block
+  uint32_t count;
+  //! time of the first sample (ns)
+  uint64_t first_ns;
+  //! time of the last sample (ns)
+  uint64_t last_ns;
+} ts_block_info;
+
+/**
+ * @class ts_writer
+ * @ingroup RVS
+ *
+ * @brief columnar time-series file: one column per (GPU, metric)
+ *
+ * The file is a header followed by fixed size blocks, each holding a run of
+ * samples of a single series (see ts_encoder). A block still being filled
+ * keeps its place in the file and is rewritten there every RVS_TS_SYNC_NS,
+ * so at most a few seconds of samples are lost if the process dies. close()
+ * appends an index of all the blocks, which lets a reader find the blocks of
+ * a series and time range without reading the others. A file with no index
+ * (not closed) can still be read, its block headers are scanned instead.
+ *
+ * Samples may be appended from several threads.
+ *
+ */
+class ts_writer {
+ public:
+  ts_writer();
+  ~ts_writer();
+
+  bool open(const std::string& path);
+  bool append(int32_t gpu_id, const char* metric, uint64_t t_ns,
+              double value);
+  bool sync(void);
+  bool close(void);
+  //! returns true if samples are being written to a file
+  bool is_open(void) const { return opened.load(); }
+
+ protected:
+  //! series being written
+  struct series {
+    series() : enc(RVS_TS_BLOCK_SIZE - RVS_TS_BLOCK_HEADER), block(-1) {}
+    //! samples of the current block
+    ts_encoder enc;
+    //! place of the current block in the file (-1 if not written yet)
+    int64_t block;
+  };
+  typedef std::pair<int32_t, std::string> series_key;
+
+  bool write_block(const series_key& key, series* s);
+  bool end_block(const series_key& key, series* s);
+  bool write_open_blocks(void);
+
+ protected:
+  //! serializes the appends
+  std::mutex mtx;
+  //! file being written (nullptr if none)
+  FILE* fp;
+  //! true while a file is open (read without locking)
+  std::atomic<bool> opened;
+  //! number of blocks allocated in the file
+  uint32_t num_blocks;
+  //! time of the last sync (ns)
+  uint64_t last_sync_ns;
+  //! series being written
+  std::map<series_key, std::unique_ptr<series> > open_series;
+  //! blocks completed so far
+  std::vector<ts_block_info> index;
+};
+
+/**
+ * @class ts_reader
+ * @ingroup RVS
+ *
+ * @brief range queries on a file written by ts_writer
+ *
+ */
+class ts_reader {
+ public:
+  //! summary of one series of the file
+  typedef struct series_info {
+    //! GPU ID
+    int32_t gpu_id;
+    //! metric name
+    std::string metric;
+    //! number of samples
+    uint64_t count;
+    //! time of the first sample (ns)
+    uint64_t first_ns;
+    //! time of the last sample (ns)
+    uint64_t last_ns;
+  } series_info;
+
+  ts_reader();
+  ~ts_reader();
+
+  bool open(const std::string& path);
+  void close(void);
+  std::vector<series_info> get_series(void) const;
+  bool query(int32_t gpu_id, const std::string& metric, uint64_t from_ns,
+             uint64_t to_ns, std::vector<ts_sample>* samples);
+  //! returns true if the file has an index (i.e. it was closed properly)
+  bool has_index(void) const { return indexed; }
+  //! returns CLOCK_MONOTONIC when the file was created (ns)
+  uint64_t get_start_mono_ns(void) const { return start_mono_ns; }
+  //! returns CLOCK_REALTIME when the file was created (ns since the epoch)
+  uint64_t get_start_real_ns(void) const { return start_real_ns; }
+
+ protected:
+  bool read_index(void);
+  bool scan_blocks(void);
+
+ protected:
+  //! file being read
+  FILE* fp;
+  //! all the blocks of the file
+  std::vector<ts_block_info> blocks;
+  //! true if the blocks were listed by the file index
+  bool indexed;
+  //! CLOCK_MONOTONIC when the file was created (ns)
+  uint64_t start_mono_ns;
+  //! CLOCK_REALTIME when the file was created (ns since the epoch)
+  uint64_t start_real_ns;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_TSDB_H_
@@ -67,6 +67,19 @@ typedef struct linkinfo_s {
   hsa_amd_link_info_type_t etype;
 } linkinfo_t;
 
+/**
+ * @brief Type of host memory used on the host side of host-device transfers
+ *
+ */
+typedef enum {
+  //! buffer allocated from HSA system memory pool (pinned)
+  HOSTMEM_POOL = 0,
+  //! user allocated buffer locked with hsa_amd_memory_lock()
+  HOSTMEM_LOCKED_USER,
+  //! pageable user buffer staged through pinned system pool buffer
+  HOSTMEM_PAGEABLE_STAGED
+} hostmem_t;
+
 /**
  * @class hsa
  * @ingroup RVS
@@ -151,11 +164,13 @@ class hsa {
 
   int Allocate(int SrcAgent, int DstAgent, size_t Size,
                      hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
-                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff);
+                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff,
+                     bool HostBuff = true);
 
   int SendTraffic(uint32_t SrcNode, uint32_t DstNode,
                   size_t   Size,    bool     bidirectional,
-                  double*  Duration);
+                  double*  Duration,
+                  hostmem_t HostMem = HOSTMEM_POOL);
 
   int GetPeerStatus(uint32_t SrcNode, uint32_t DstNode);
   int GetPeerStatusAgent(const AgentInformation& SrcAgent,
@@ -164,6 +179,7 @@ class hsa {
                   uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr);
   double GetCopyTime(bool bidirectional,
                      hsa_signal_t signal_fwd, hsa_signal_t signal_rev);
+  bool WaitSignal(hsa_signal_t signal);
 
   static void print_hsa_status(const char* message, hsa_status_t st);
   static void print_hsa_status(const char* file, int line,
@@ -175,8 +191,46 @@ class hsa {
                                 hsa_status_t st);
   static bool check_link_type(const std::vector<rvs::linkinfo_t>& arrLinkInfo,
                               int LinkType);
+  static int str2hostmem(const std::string& Name, hostmem_t* pHostMem);
+  static std::string hostmem2str(hostmem_t HostMem);
 
  protected:
+/**
+ * @class hostxfer_t
+ * @ingroup RVS
+ *
+ * @brief Utility class used to store context of one host-device transfer
+ * when host side is not allocated from HSA system memory pool
+ *
+ */
+  typedef struct {
+    //! source agent index in agent_list
+    int SrcIx;
+    //! destination agent index in agent_list
+    int DstIx;
+    //! 'true' if source agent is CPU
+    bool bHostIsSrc;
+    //! source buffer allocated from HSA memory pool
+    void* pSrcPoolBuff;
+    //! destination buffer allocated from HSA memory pool
+    void* pDstPoolBuff;
+    //! user (malloc) buffer on host side
+    void* pUserBuff;
+    //! agent accessible pointer to locked user buffer
+    void* pLockedBuff;
+    //! signal used to wait for DMA completion
+    hsa_signal_t Sig;
+  } hostxfer_t;
+
+  int SendTrafficHostMem(uint32_t SrcNode, uint32_t DstNode,
+                         size_t Size, bool bidirectional,
+                         hostmem_t HostMem, double* Duration);
+  int HostXferInit(int SrcIx, int DstIx, size_t Size, hostmem_t HostMem,
+                   hostxfer_t* pCtx);
+  int HostXferStart(hostxfer_t* pCtx, size_t Size, hostmem_t HostMem);
+  int HostXferFinish(hostxfer_t* pCtx, size_t Size, hostmem_t HostMem);
+  void HostXferRelease(hostxfer_t* pCtx);
+
   void InitAgents();
 
   static hsa_status_t ProcessAgent(hsa_agent_t agent, void* data);
@@ -42,9 +42,15 @@ typedef int   (*t_cbLogRecordFlush)( void* pLogRecord);
 typedef void* (*t_cbCreateNode)(void* Parent, const char* Name);
 typedef void  (*t_cbAddString)(void* Parent, const char* Key, const char* Val);
 typedef void  (*t_cbAddInt)(void* Parent, const char* Key, const int Val);
+typedef void  (*t_cbAddDouble)(void* Parent, const char* Key,
+                               const double Val);
 typedef void  (*t_cbAddNode)(void* Parent, void* Child);
+typedef void  (*t_cbSample)(const char* Module, const int GpuId,
+                            const char* Metric, const uint64_t Ns,
+                            const double Val);
 typedef void  (*t_cbStop)(uint16_t flags);
 typedef bool  (*t_cbStopping)(void);
+typedef void* (*t_cbCancelToken)(void);
 typedef int   (*t_rvs_module_err)(const char*, const char*, const char*);
 
 
@@ -66,12 +72,18 @@ typedef struct tag_module_init {
   t_cbAddString        cbAddString;
   //! pointer to rvs::logger::AddInt() function
   t_cbAddInt           cbAddInt;
+  //! pointer to rvs::logger::AddDouble() function
+  t_cbAddDouble        cbAddDouble;
   //! pointer to rvs::logger::AddNode() function
   t_cbAddNode          cbAddNode;
+  //! pointer to rvs::logger::Sample() function
+  t_cbSample           cbSample;
   //! pointer to rvs::logger::Stop() function
   t_cbStop             cbStop;
   //! pointer to rvs::logger::Stopping() function
   t_cbStopping         cbStopping;
+  //! pointer to rvs::logger::CancelToken() function
+  t_cbCancelToken      cbCancelToken;
   //! pointer to rvs::logger::Err() function
   t_rvs_module_err     cbErr;
 } T_MODULE_INIT;
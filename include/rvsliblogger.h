@@ -28,6 +28,7 @@
 #include <string>
 #include <mutex>
 #include "include/rvsliblog.h"
+#include "include/rvs_tsdb.h"
 
 
 namespace rvs {
@@ -54,10 +55,13 @@ class logger {
   static  void  quiet() { b_quiet = true; }
   //! set logging file
   static  void  set_log_file(const std::string& fname);
+  //! set time-series file
+  static  void  set_ts_file(const std::string& fname);
 
   static  bool   get_ticks(uint32_t* psecs, uint32_t* pusecs);
 
   static  int    init_log_file();
+  static  int    init_ts_file();
   static  int    terminate();
 
   static  int    log(const std::string& Message, const int level = 1);
@@ -71,10 +75,15 @@ class logger {
   static  void*  CreateNode(void* Parent, const char* Name);
   static  void   AddString(void* Parent, const char* Key, const char* Val);
   static  void   AddInt(void* Parent, const char* Key, const int Val);
+  static  void   AddDouble(void* Parent, const char* Key, const double Val);
   static  void   AddNode(void* Parent, void* Child);
+  static  void   Sample(const char* Module, const int GpuId,
+                        const char* Metric, const uint64_t Ns,
+                        const double Val);
   static  int    JsonPatchAppend(int*);
   static  void   Stop(uint16_t flags);
   static  bool   Stopping(void);
+  static  void*  CancelToken(void);
   static  int    Err(const char *Message,
                    const char *Module = nullptr, const char *Action = nullptr);
 
@@ -101,6 +110,10 @@ class logger {
   static uint16_t stop_flags;
   //! logging file
   static char log_file[1024];
+  //! time-series file
+  static char ts_file[1024];
+  //! time-series file writer
+  static ts_writer ts_sink;
   //! quiet mode
   static bool b_quiet;
 };
@@ -76,7 +76,12 @@ class lp {
                          const std::string& Val);
   static void  AddString(void* Parent, const char* Key, const char* Val);
   static void  AddInt(void* Parent, const char* Key, const int Val);
+  static void  AddDouble(void* Parent, const char* Key, const double Val);
   static void  AddNode(void* Parent, void* Child);
+  static void  Sample(const char* Module, const int GpuId, const char* Metric,
+                      const double Val);
+  static void  Sample(const char* Module, const int GpuId, const char* Metric,
+                      const uint64_t Ns, const double Val);
   static bool  get_ticks(unsigned int* psec, unsigned int* pusec);
   static void  Stop(uint16_t flags);
   static bool  Stopping();
@@ -37,7 +37,8 @@ typedef enum eLN {
   List    = 1,
   String  = 2,
   Integer = 3,
-  Record  = 4
+  Record  = 4,
+  Double  = 5
 } T_LNTYPE;
 
 /**
@@ -26,8 +26,11 @@
 #define INCLUDE_RVSTIMER_H_
 
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 #include "include/rvsthreadbase.h"
+#include "include/rvs_cancel.h"
 
 namespace rvs {
 
@@ -41,7 +44,11 @@ namespace rvs {
  * It accepts parameter T which is a class which member function will
  * be called upon expiration of timer interval.
  *
- * Timer resolution is 1ms
+ * The timer thread sleeps on a condition variable until the next deadline
+ * (steady_clock, so wall clock changes do not matter) and wakes up right
+ * away when the timer is restarted or stopped. A periodic timer fires at
+ * start + k * interval: a late callback does not shift the next ones.
+ * A stop request (rvs::cancel_token) wakes the thread up and ends the timer.
  *
  */
 
@@ -61,6 +68,10 @@ class timer : public ThreadBase {
   timer(timerfunc_t cbFunc, T* cbArg) {
     cbfunc = cbFunc;
     cbarg = cbArg;
+    brun = false;
+    bthread = false;
+    brunonce = false;
+    timeset = 0;
   }
 
   //! Default destructor
@@ -76,15 +87,33 @@ class timer : public ThreadBase {
   *
   * */
   void start(int Interval, bool RunOnce = false) {
-    brunonce = RunOnce;
     timeset = Interval;
-    end_time = std::chrono::system_clock::now() +
-               std::chrono::milliseconds(timeset);
-    // recalculate the end time and only if thread is not started start it
-    if (brun == false) {
-      brun = true;
-      rvs::ThreadBase::start();
+    start(std::chrono::milliseconds(Interval), RunOnce);
+  }
+
+  /**
+  * @brief Start timer with a sub-millisecond interval
+  *
+  * @param Interval Timer interval
+  * @param RunOnce 'true' if timer is to fire only once
+  *
+  * */
+  void start(std::chrono::nanoseconds Interval, bool RunOnce = false) {
+    std::lock_guard<std::mutex> lk(mtx);
+    brunonce = RunOnce;
+    period = Interval;
+    end_time = std::chrono::steady_clock::now() + period;
+    brun = true;
+    // the thread picks up the new end time, start it only if not running
+    if (bthread) {
+      cv.notify_all();
+      return;
     }
+    // a one shot timer thread that fired has already exited
+    if (t.joinable())
+      t.join();
+    bthread = true;
+    rvs::ThreadBase::start();
   }
 
 
@@ -97,10 +126,11 @@ class timer : public ThreadBase {
  * */
   void stop() {
     // signal thread to exit
-    brun = false;
-
-    // wait a bit to make sure thread has exited
-    std::this_thread::yield();
+    {
+      std::lock_guard<std::mutex> lk(mtx);
+      brun = false;
+    }
+    cv.notify_all();
 
     try {
       if (t.joinable())
@@ -115,45 +145,64 @@ class timer : public ThreadBase {
  *
  * */
   virtual void run() {
-    do {
-      std::chrono::time_point<std::chrono::system_clock> curr_time;
-      // wait for time to ellsapse (or for timer to be stopped)
-      while (brun) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        curr_time = std::chrono::system_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>
-                                         (curr_time - end_time).count() >= 0) {
-          break;
-        }
+    rvs::cancel_token* token = rvs::cancel_token::process();
+    int waker = token->add_waker([this] {
+      { std::lock_guard<std::mutex> lk(mtx); }
+      cv.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lk(mtx);
+    while (brun && !token->cancelled()) {
+      // wait for time to ellapse (or for timer to be restarted/stopped)
+      std::chrono::steady_clock::time_point deadline = end_time;
+      std::chrono::steady_clock::time_point curr_time =
+        std::chrono::steady_clock::now();
+      if (curr_time < deadline) {
+        cv.wait_until(lk, deadline);
+        continue;
       }
 
-      // if timer is not stopped, call the callback function
-      if (brun) {
-        (cbarg->*cbfunc)();
+      if (!brunonce) {
+        // next deadline on the original grid, skipping the missed ones
+        end_time = deadline + period;
+        if (end_time <= curr_time && period.count() > 0)
+          end_time += period * ((curr_time - end_time) / period + 1);
       }
 
-      if (brunonce) {
+      // the callback may restart or stop the timer
+      lk.unlock();
+      (cbarg->*cbfunc)();
+      lk.lock();
+
+      if (brunonce && end_time == deadline)
         brun = false;
-      } else {
-        end_time = std::chrono::system_clock::now() +
-                   std::chrono::milliseconds(timeset);
-      }
-    } while (brun);
+    }
+    bthread = false;
+    lk.unlock();
+    token->remove_waker(waker);
   }
 
  protected:
   //! true for the duration of timer activity
   bool        brun;
+  //! true while the timer thread runs
+  bool        bthread;
   //! true if timer is to fire only once
   bool        brunonce;
   //! timer interval (ms)
   int         timeset;
+  //! timer interval
+  std::chrono::nanoseconds period;
   //! call back function
   timerfunc_t cbfunc;
   //! ptr to instance of a class to be called-back through cbfunc.
   T*          cbarg;
   //! time when timer will expire
-  std::chrono::time_point<std::chrono::system_clock> end_time;
+  std::chrono::steady_clock::time_point end_time;
+  //! guards the timer state
+  std::mutex mtx;
+  //! wakes the timer thread on restart/stop
+  std::condition_variable cv;
 };
 
 }  // namespace rvs
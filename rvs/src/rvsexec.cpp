@@ -38,6 +38,7 @@
 #include "include/rvsliblogger.h"
 #include "include/rvsoptions.h"
 #include "include/rvstrace.h"
+#include "include/rvs_cancel.h"
 
 #define MODULE_NAME_CAPS "CLI"
 
@@ -124,6 +125,12 @@ int rvs::exec::run() {
     logger::to_json(true);
   }
 
+  // check --tsFile option
+  std::string s_ts_file;
+  if (rvs::options::has_option("-ts", &s_ts_file)) {
+    logger::set_ts_file(s_ts_file);
+  }
+
   string config_file;
   if (rvs::options::has_option("-c", &val)) {
     config_file = val;
@@ -171,6 +178,14 @@ int rvs::exec::run() {
     return -1;
   }
 
+  if (logger::init_ts_file()) {
+    char buff[1024];
+    snprintf(buff, sizeof(buff),
+              "could not create time-series file: %s", s_ts_file.c_str());
+    rvs::logger::Err(buff, MODULE_NAME_CAPS);
+    return -1;
+  }
+
   if (rvs::options::has_option("-g")) {
     int sts = do_gpu_list();
     rvs::module::terminate();
@@ -192,7 +207,20 @@ int rvs::exec::run() {
     rvs::logger::Err(buff, MODULE_NAME_CAPS);
   }
 
+  // time from the stop request (if any) to the end of the running action
+  uint64_t actions_ns = rvs::cancel_token::process()->get_latency_ns();
+
   rvs::module::terminate();
+
+  if (rvs::cancel_token::process()->cancelled()) {
+    // ... and to the end of the module workers (e.g.: gm monitoring)
+    uint64_t modules_ns = rvs::cancel_token::process()->get_latency_ns();
+    char buff[256];
+    snprintf(buff, sizeof(buff),
+             "[RVS] stop latency: actions %.3f ms, modules %.3f ms",
+             actions_ns / 1e6, modules_ns / 1e6);
+    rvs::logger::Log(buff, rvs::loginfo);
+  }
   logger::terminate();
 
   DTRACE_
@@ -247,6 +275,10 @@ void rvs::exec::do_help() {
                               "This will produce a log\n";
   cout << "                   file intended for post-run analysis after "
                               "an error.\n";
+  cout << "   --tsFile        Record the samples of the monitoring and "
+                              "stress modules (gm, iet,\n";
+  cout << "                   gst) in a compact time-series file. "
+                              "Use rvsts to query it.\n";
   cout << "   --quiet         No console output given. See logs and return "
                               "code for errors.\n";
   cout << "-m --modulepath    Specify a custom path for the RVS modules.\n";
@@ -239,9 +239,12 @@ int rvs::module::initialize() {
   d.cbCreateNode      = rvs::logger::CreateNode;
   d.cbAddString       = rvs::logger::AddString;
   d.cbAddInt          = rvs::logger::AddInt;
+  d.cbAddDouble       = rvs::logger::AddDouble;
   d.cbAddNode         = rvs::logger::AddNode;
+  d.cbSample          = rvs::logger::Sample;
   d.cbStop            = rvs::logger::Stop;
   d.cbStopping        = rvs::logger::Stopping;
+  d.cbCancelToken     = rvs::logger::CancelToken;
   d.cbErr             = rvs::logger::Err;
 
   return (*rvs_module_init)(reinterpret_cast<void*>(&d));
@@ -0,0 +1,160 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+
+/**
+ * @file rvsts.cpp
+ * @ingroup Launcher
+ *
+ * @brief Time-series file reader
+ *
+ * Lists the series of a file written with "rvs --tsFile" or prints the
+ * samples of a GPU/metric/time range as CSV (time,gpu_id,metric,value), e.g.
+ * for plotting. Times are in seconds since system start, like the time stamps
+ * of the rvs log, unless -w is given.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "include/rvs_tsdb.h"
+
+//! prints usage information
+static void usage(void) {
+  printf("\nUsage: rvsts [options] <file>\n");
+  printf("\nOptions:\n\n");
+  printf("-l             List the series (GPU ID, metric, samples, time range) "
+         "and exit.\n");
+  printf("-g <gpu_id>    Print only the samples of this GPU.\n");
+  printf("-m <metric>    Print only the samples of this metric (e.g. "
+         "gm.temp).\n");
+  printf("-f <seconds>   Print only the samples taken at or after this "
+         "time.\n");
+  printf("-t <seconds>   Print only the samples taken at or before this "
+         "time.\n");
+  printf("-w             Times are wall clock (seconds since the epoch) "
+         "instead of\n");
+  printf("               seconds since system start.\n");
+  printf("-h             Display usage information and exit.\n");
+}
+
+/**
+ * @brief Main method
+ *
+ * @param argc standard C argc parameter to main()
+ * @param argv standard C argv parameter to main()
+ * @return 0 - all OK, non-zero error
+ */
+int main(int argc, char** argv) {
+  bool list = false, wall = false;
+  int32_t gpu_id = -1;
+  std::string metric;
+  double from_s = -1, to_s = -1;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "lg:m:f:t:wh")) != -1) {
+    switch (opt) {
+    case 'l':
+      list = true;
+      break;
+    case 'g':
+      gpu_id = atoi(optarg);
+      break;
+    case 'm':
+      metric = optarg;
+      break;
+    case 'f':
+      from_s = atof(optarg);
+      break;
+    case 't':
+      to_s = atof(optarg);
+      break;
+    case 'w':
+      wall = true;
+      break;
+    case 'h':
+      usage();
+      return 0;
+    default:
+      usage();
+      return 1;
+    }
+  }
+  if (optind != argc - 1) {
+    usage();
+    return 1;
+  }
+
+  rvs::ts_reader reader;
+  if (!reader.open(argv[optind])) {
+    fprintf(stderr, "rvsts: could not read time-series file: %s\n",
+            argv[optind]);
+    return 1;
+  }
+
+  // sample times are CLOCK_MONOTONIC; -w shifts them by the offset between
+  // CLOCK_REALTIME and CLOCK_MONOTONIC when the file was created
+  double offset_s = wall ? (static_cast<double>(reader.get_start_real_ns()) -
+                            reader.get_start_mono_ns()) / 1e9 : 0;
+  uint64_t from_ns = 0, to_ns = UINT64_MAX;
+  if (from_s >= 0 && from_s - offset_s > 0)
+    from_ns = (from_s - offset_s) * 1e9;
+  if (to_s >= 0)
+    to_ns = to_s - offset_s > 0 ? (to_s - offset_s) * 1e9 : 0;
+
+  std::vector<rvs::ts_reader::series_info> series = reader.get_series();
+  if (list) {
+    printf("gpu_id,metric,samples,first,last\n");
+    for (auto it = series.begin(); it != series.end(); it++) {
+      printf("%d,%s,%lu,%.6f,%.6f\n", it->gpu_id, it->metric.c_str(),
+             static_cast<unsigned long>(it->count),
+             it->first_ns / 1e9 + offset_s, it->last_ns / 1e9 + offset_s);
+    }
+    return 0;
+  }
+
+  std::vector<rvs::ts_sample> samples;
+  printf("time,gpu_id,metric,value\n");
+  for (auto it = series.begin(); it != series.end(); it++) {
+    if ((gpu_id >= 0 && it->gpu_id != gpu_id) ||
+        (!metric.empty() && it->metric != metric))
+      continue;
+    if (!reader.query(it->gpu_id, it->metric, from_ns, to_ns, &samples)) {
+      fprintf(stderr, "rvsts: corrupt block in series %d %s\n",
+              it->gpu_id, it->metric.c_str());
+      return 1;
+    }
+    for (auto s = samples.begin(); s != samples.end(); s++) {
+      printf("%.6f,%d,%s,%.10g\n", s->t_ns / 1e9 + offset_s, it->gpu_id,
+             it->metric.c_str(), s->value);
+    }
+  }
+
+  return 0;
+}
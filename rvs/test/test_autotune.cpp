@@ -0,0 +1,149 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_autotune.h"
+
+class autotune : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char tmpl[] = "/tmp/rvs_autotune_XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    dir = tmpl;
+  }
+  void TearDown() override {
+    std::string cmd = "rm -rf " + dir;
+    ASSERT_EQ(system(cmd.c_str()), 0);
+  }
+  std::string dir;
+};
+
+TEST_F(autotune, key) {
+  std::string key = rvs::autotune_cache::make_key("sgemm", 26273,
+                                                  "113-D163 01", "");
+  EXPECT_EQ(key, "sgemm/26273/113-D163_01/unknown");
+}
+
+TEST_F(autotune, store_and_lookup) {
+  rvs::autotune_cache cache(dir + "/cache");
+  rvs::gemm_shape shape;
+  EXPECT_FALSE(cache.lookup("sgemm/1/a/b", &shape));
+
+  rvs::gemm_shape s1 = {8640, 8640, 4320, 12345.5};
+  rvs::gemm_shape s2 = {5760, 5760, 5760, 100};
+  EXPECT_TRUE(cache.store("sgemm/1/a/b", s1));
+  EXPECT_TRUE(cache.store("dgemm/1/a/b", s2));
+  ASSERT_TRUE(cache.lookup("sgemm/1/a/b", &shape));
+  EXPECT_EQ(shape.m, 8640u);
+  EXPECT_EQ(shape.k, 4320u);
+  EXPECT_DOUBLE_EQ(shape.gflops, 12345.5);
+
+  // a new result replaces the old one, other keys are kept
+  s1.k = 8640;
+  EXPECT_TRUE(cache.store("sgemm/1/a/b", s1));
+  ASSERT_TRUE(cache.lookup("sgemm/1/a/b", &shape));
+  EXPECT_EQ(shape.k, 8640u);
+  ASSERT_TRUE(cache.lookup("dgemm/1/a/b", &shape));
+  EXPECT_EQ(shape.m, 5760u);
+  EXPECT_FALSE(cache.lookup("sgemm/2/a/b", &shape));
+}
+
+TEST_F(autotune, malformed_lines) {
+  std::ofstream f(dir + "/cache");
+  f << "# comment\nsgemm/1/a/b 0 0 0 0\nsgemm/1/a/b 4096\n"
+       "sgemm/1/a/b 2880 2880 2880 1.5\n";
+  f.close();
+  rvs::autotune_cache cache(dir + "/cache");
+  rvs::gemm_shape shape;
+  ASSERT_TRUE(cache.lookup("sgemm/1/a/b", &shape));
+  EXPECT_EQ(shape.m, 2880u);
+}
+
+TEST_F(autotune, versions) {
+  ASSERT_EQ(mkdir((dir + "/.info").c_str(), 0755), 0);
+  std::ofstream(dir + "/.info/version") << "5.4.0-72\n";
+  EXPECT_EQ(rvs::autotune_cache::read_rocm_version(dir), "5.4.0-72");
+  EXPECT_EQ(rvs::autotune_cache::read_rocm_version(dir + "/none"), "unknown");
+
+  ASSERT_EQ(mkdir((dir + "/0000:c3:00.0").c_str(), 0755), 0);
+  std::ofstream(dir + "/0000:c3:00.0/vbios_version") << "113-D1631700-111\n";
+  EXPECT_EQ(rvs::autotune_cache::read_vbios_version(0, 0xc3, 0, dir),
+            "113-D1631700-111");
+}
+
+TEST_F(autotune, candidates) {
+  std::vector<rvs::gemm_shape> shapes = rvs::autotune_cache::candidates();
+  ASSERT_FALSE(shapes.empty());
+  for (const rvs::gemm_shape& s : shapes) {
+    EXPECT_EQ(s.m, s.n);
+    EXPECT_EQ(s.m, s.k);
+  }
+  rvs::gemm_shape best = {5760, 5760, 5760, 1};
+  shapes = rvs::autotune_cache::refine(best);
+  ASSERT_EQ(shapes.size(), 2u);
+  EXPECT_EQ(shapes[0].k, 2880u);
+  EXPECT_EQ(shapes[1].k, 11520u);
+}
+
+TEST_F(autotune, training_cache) {
+  rvs::training_cache cache(dir + "/training");
+  rvs::training_result r;
+  EXPECT_FALSE(cache.lookup("iet_sgemm/1/a/b/c/7", &r));
+
+  rvs::training_result r1 = {5760, 3.25, 287.5, 1700000000};
+  EXPECT_TRUE(cache.store("iet_sgemm/1/a/b/c/7", r1));
+  ASSERT_TRUE(cache.lookup("iet_sgemm/1/a/b/c/7", &r));
+  EXPECT_EQ(r.matrix_size, 5760u);
+  EXPECT_DOUBLE_EQ(r.ms_per_sgemm, 3.25);
+  EXPECT_DOUBLE_EQ(r.avg_power, 287.5);
+  EXPECT_EQ(r.timestamp, 1700000000u);
+
+  // a new result replaces the old one
+  r1.avg_power = 250;
+  EXPECT_TRUE(cache.store("iet_sgemm/1/a/b/c/7", r1));
+  ASSERT_TRUE(cache.lookup("iet_sgemm/1/a/b/c/7", &r));
+  EXPECT_DOUBLE_EQ(r.avg_power, 250);
+
+  // results without power or SGEMM time are ignored
+  std::ofstream(dir + "/training", std::ios::app)
+    << "iet_sgemm/1/a/b/c/8 5760 0 287.5 1\n"
+    << "iet_sgemm/1/a/b/c/8 5760 3.25 0 1\n";
+  EXPECT_FALSE(cache.lookup("iet_sgemm/1/a/b/c/8", &r));
+}
+
+TEST_F(autotune, driver_version) {
+  std::ofstream(dir + "/version") << "6.1.5\n";
+  EXPECT_EQ(rvs::autotune_cache::read_driver_version(dir), "6.1.5");
+  EXPECT_EQ(rvs::autotune_cache::read_driver_version(dir + "/none"),
+            "unknown");
+}
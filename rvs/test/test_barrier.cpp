@@ -0,0 +1,77 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_barrier.h"
+
+TEST(barrier, common_release_time) {
+  const int num_threads = 4, rounds = 50;
+  rvs::barrier sync(num_threads);
+  std::atomic<int> phase(0);
+  std::vector<std::vector<uint64_t> > times(num_threads);
+  std::vector<std::thread> threads;
+  std::atomic<bool> in_step(true);
+
+  for (int t = 0; t < num_threads; t++) {
+    threads.push_back(std::thread([&, t]() {
+      for (int r = 0; r < rounds; r++) {
+        times[t].push_back(sync.wait());
+        // nobody gets past round r before all reached it
+        if (phase.fetch_add(1) / num_threads != r)
+          in_step = false;
+        sync.wait();
+      }
+    }));
+  }
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+
+  EXPECT_TRUE(in_step);
+  for (int r = 0; r < rounds; r++) {
+    for (int t = 1; t < num_threads; t++)
+      EXPECT_EQ(times[t][r], times[0][r]);
+    if (r > 0) {
+      EXPECT_GE(times[0][r], times[0][r - 1]);
+    }
+  }
+}
+
+TEST(barrier, leave) {
+  rvs::barrier sync(2);
+  std::thread waiter([&sync]() { sync.wait(); });
+
+  // the second thread gives up: the first one is not stuck
+  sync.leave();
+  waiter.join();
+  EXPECT_EQ(sync.get_count(), 1u);
+  // a group of one never blocks
+  sync.wait();
+}
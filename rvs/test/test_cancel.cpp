@@ -0,0 +1,96 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_cancel.h"
+#include "include/rvstimer.h"
+
+TEST(cancel_token, wait_and_wakers) {
+  rvs::cancel_token token;
+  std::atomic<int> woken(0);
+
+  EXPECT_FALSE(token.cancelled());
+  EXPECT_FALSE(token.wait_for(1000000));
+  EXPECT_EQ(token.get_latency_ns(), 0u);
+
+  int id = token.add_waker([&woken]() { woken++; });
+  int gone = token.add_waker([&woken]() { woken += 100; });
+  token.remove_waker(gone);
+
+  // a long wait returns as soon as another thread cancels
+  auto t0 = std::chrono::steady_clock::now();
+  std::thread canceller([&token]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    token.cancel();
+    token.cancel();
+  });
+  EXPECT_TRUE(token.wait_for(10000000000ull));
+  canceller.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - t0,
+            std::chrono::milliseconds(1000));
+  EXPECT_TRUE(token.cancelled());
+  EXPECT_EQ(woken, 1);
+  EXPECT_GT(token.get_cancel_ns(), 0u);
+  EXPECT_GT(token.get_latency_ns(), 0u);
+
+  token.remove_waker(id);
+  token.reset();
+  EXPECT_FALSE(token.cancelled());
+  EXPECT_EQ(token.get_cancel_ns(), 0u);
+}
+
+class cancel_counter {
+ public:
+  cancel_counter() : ticks(0) {}
+  void tick(void) { ticks++; }
+  std::atomic<int> ticks;
+};
+
+TEST(cancel_token, ends_timers) {
+  rvs::cancel_token token;
+  cancel_counter cnt;
+
+  rvs::cancel_token::set_process(&token);
+  rvs::timer<cancel_counter> tmr(&cancel_counter::tick, &cnt);
+  tmr.start(10);
+  std::this_thread::sleep_for(std::chrono::milliseconds(55));
+  EXPECT_GE(cnt.ticks, 4);
+
+  // the timer thread wakes up and exits without another tick
+  token.cancel();
+  int ticks = cnt.ticks;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_LE(cnt.ticks, ticks + 1);
+  tmr.stop();
+
+  rvs::cancel_token::set_process(nullptr);
+}
@@ -0,0 +1,75 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_histogram.h"
+
+TEST(histogram, buckets_cover_the_range) {
+  // contiguous buckets, each value inside its own
+  int last = rvs::histogram::bucket(UINT64_MAX);
+  for (int idx = 0; idx <= last; idx++) {
+    uint64_t low = rvs::histogram::bucket_low(idx);
+    EXPECT_EQ(rvs::histogram::bucket(low), idx);
+    EXPECT_EQ(rvs::histogram::bucket(rvs::histogram::bucket_high(idx)), idx);
+    if (idx > 0) {
+      EXPECT_EQ(rvs::histogram::bucket_high(idx - 1) + 1, low);
+    }
+  }
+  EXPECT_EQ(rvs::histogram::bucket_high(rvs::histogram::bucket(UINT64_MAX)),
+            UINT64_MAX);
+}
+
+TEST(histogram, percentiles) {
+  rvs::histogram h;
+  EXPECT_EQ(h.percentile(50), 0u);
+  // 1..10000 us, in ns
+  for (uint64_t i = 1; i <= 10000; i++)
+    h.add(i * 1000);
+  EXPECT_EQ(h.count(), 10000u);
+  EXPECT_EQ(h.min(), 1000u);
+  EXPECT_EQ(h.max(), 10000000u);
+  EXPECT_NEAR(h.percentile(50), 5000000, 5000000 * 0.03);
+  EXPECT_NEAR(h.percentile(99), 9900000, 9900000 * 0.03);
+  EXPECT_EQ(h.percentile(100), 10000000u);
+  EXPECT_EQ(h.percentile(0), 1000u);
+}
+
+TEST(histogram, outliers_and_reset) {
+  rvs::histogram h;
+  for (int i = 0; i < 999; i++)
+    h.add(2000000);
+  h.add(50000000);
+  // a single stall moves the max, not the median nor the p99
+  EXPECT_NEAR(h.percentile(50), 2000000, 2000000 * 0.03);
+  EXPECT_NEAR(h.percentile(99), 2000000, 2000000 * 0.03);
+  EXPECT_EQ(h.max(), 50000000u);
+
+  h.reset();
+  EXPECT_EQ(h.count(), 0u);
+  EXPECT_EQ(h.max(), 0u);
+  EXPECT_EQ(h.min(), 0u);
+}
@@ -0,0 +1,69 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <math.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvslognodebase.h"
+#include "include/rvslognodedouble.h"
+
+class ext_lognodedouble : public rvs::LogNodeDouble {
+ public:
+  LogNodeBase* get_Parent() {
+    return const_cast<LogNodeBase*>(Parent);
+  }
+
+  rvs::eLN get_Type() {
+    return Type;
+  }
+
+  double get_Value() {
+    return Value;
+  }
+};
+
+TEST(LogNodeDoubleTest, log_node_double) {
+  rvs::LogNodeDouble parent("parent", 1.5, nullptr);
+  rvs::LogNodeDouble child("power", 254.25, &parent);
+  rvs::LogNodeDouble small("stddev", 1.0 / 3, nullptr);
+  rvs::LogNodeDouble inf("ratio", INFINITY, nullptr);
+  rvs::LogNodeDouble nan("mean", NAN, nullptr);
+  ext_lognodedouble* node;
+
+  node = static_cast<ext_lognodedouble*>(&child);
+  EXPECT_EQ(node->get_Type(), rvs::eLN::Double);
+  EXPECT_DOUBLE_EQ(node->get_Value(), 254.25);
+  EXPECT_EQ(node->get_Parent(), &parent);
+
+  EXPECT_STREQ(parent.ToJson().c_str(), "\n\"parent\" : 1.5");
+  EXPECT_STREQ(child.ToJson("Test ").c_str(), "\nTest \"power\" : 254.25");
+  EXPECT_STREQ(small.ToJson().c_str(), "\n\"stddev\" : 0.3333333333");
+
+  // no NaN or infinity in JSON
+  EXPECT_STREQ(inf.ToJson().c_str(), "\n\"ratio\" : null");
+  EXPECT_STREQ(nan.ToJson().c_str(), "\n\"mean\" : null");
+}
@@ -0,0 +1,105 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_pacer.h"
+
+TEST(pacer, pid_converges) {
+  // first order plant y' = (u - y) / tau, setpoint 0.5
+  rvs::pid ctrl(0.5, 2.0, 0, -1, 1);
+  double y = 0, dt = 0.01, tau = 0.1;
+  for (int i = 0; i < 1000; i++) {
+    double u = ctrl.update(0.5 - y, dt);
+    y += (u - y) * dt / tau;
+  }
+  EXPECT_NEAR(y, 0.5, 1e-3);
+}
+
+TEST(pacer, pid_limits_and_windup) {
+  rvs::pid ctrl(1.0, 10.0, 0, 0, 1);
+  // a long positive error saturates the output without winding up
+  for (int i = 0; i < 1000; i++)
+    EXPECT_LE(ctrl.update(5.0, 0.1), 1.0);
+  EXPECT_DOUBLE_EQ(ctrl.output(), 1.0);
+  // the output leaves the upper limit as soon as the error changes sign
+  EXPECT_LT(ctrl.update(-0.5, 0.1), 1.0);
+}
+
+TEST(pacer, pid_reset) {
+  rvs::pid ctrl(1.0, 1.0, 0, -1, 1);
+  ctrl.reset(0.25);
+  EXPECT_DOUBLE_EQ(ctrl.output(), 0.25);
+  EXPECT_DOUBLE_EQ(ctrl.update(0, 0.1), 0.25);
+  ctrl.reset(5);
+  EXPECT_DOUBLE_EQ(ctrl.output(), 1.0);
+}
+
+TEST(pacer, absolute_deadlines) {
+  rvs::pacer p;
+  uint64_t start = rvs::pacer::now_ns();
+  p.start();
+  for (int i = 0; i < 20; i++)
+    p.wait_next(5);
+  uint64_t elapsed = rvs::pacer::now_ns() - start;
+  // 20 periods of 5 ms; the wake-up latencies do not accumulate
+  EXPECT_GE(elapsed, 100000000ULL);
+  EXPECT_LT(elapsed, 130000000ULL);
+}
+
+TEST(pacer, late_restart) {
+  rvs::pacer p;
+  p.start();
+  rvs::pacer::sleep_until_ns(rvs::pacer::now_ns() + 20000000ULL);
+  // 20 ms late for a 5 ms period: no burst of catch-up iterations
+  p.wait_next(5);
+  EXPECT_EQ(p.get_late_count(), 1u);
+  uint64_t before = rvs::pacer::now_ns();
+  p.wait_next(5);
+  EXPECT_GE(rvs::pacer::now_ns() - before, 4000000ULL);
+}
+
+TEST(pacer, spin) {
+  rvs::pacer p;
+  p.set_spin(1000000ULL);
+  p.start();
+  uint64_t start = rvs::pacer::now_ns();
+  for (int i = 0; i < 20; i++) {
+    p.wait_next(5);
+    // the polling never returns before the deadline
+    EXPECT_GE(rvs::pacer::now_ns(), p.get_deadline());
+  }
+  uint64_t elapsed = rvs::pacer::now_ns() - start;
+  EXPECT_GE(elapsed, 100000000ULL);
+  EXPECT_LT(elapsed, 130000000ULL);
+
+  // a virtual clock cannot be polled: the spin is a plain sleep
+  rvs::virtual_clock vclk(1000);
+  rvs::pacer vp(&vclk);
+  vp.set_spin(1000000ULL);
+  vp.wait_next(5);
+  EXPECT_EQ(vclk.now_ns(), 5001000ULL);
+}
@@ -0,0 +1,111 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_rand.h"
+
+TEST(rand, reproducible) {
+  EXPECT_EQ(rvs::rand::counter_hash(1234, 0), rvs::rand::counter_hash(1234, 0));
+  EXPECT_NE(rvs::rand::counter_hash(1234, 0), rvs::rand::counter_hash(1234, 1));
+  EXPECT_NE(rvs::rand::counter_hash(1234, 0), rvs::rand::counter_hash(1235, 0));
+}
+
+TEST(rand, range) {
+  for (uint64_t i = 0; i < 100000; i++) {
+    float f = rvs::rand::uniform_float(42, i);
+    double d = rvs::rand::uniform_double(42, i);
+    EXPECT_GE(f, -1.0f);
+    EXPECT_LT(f, 1.0f);
+    EXPECT_GE(d, -1.0);
+    EXPECT_LT(d, 1.0);
+  }
+}
+
+TEST(rand, parallel_fill) {
+  const uint64_t count = 3 * RVS_RAND_MIN_ELEMS_PER_THREAD + 7;
+  std::vector<float> serial(count), parallel(count);
+  auto gen = [](uint64_t i) { return rvs::rand::uniform_float(7, i); };
+
+  // the output must not depend on the number of threads
+  rvs::rand::parallel_fill(serial.data(), count, gen, 1);
+  rvs::rand::parallel_fill(parallel.data(), count, gen, 4);
+  EXPECT_EQ(serial, parallel);
+  EXPECT_EQ(serial[count - 1], rvs::rand::uniform_float(7, count - 1));
+}
+
+TEST(rand, float_to_half) {
+  EXPECT_EQ(rvs::rand::float_to_half(0.0f), 0x0000);
+  EXPECT_EQ(rvs::rand::float_to_half(-0.0f), 0x8000);
+  EXPECT_EQ(rvs::rand::float_to_half(1.0f), 0x3C00);
+  EXPECT_EQ(rvs::rand::float_to_half(-1.0f), 0xBC00);
+  EXPECT_EQ(rvs::rand::float_to_half(0.5f), 0x3800);
+  EXPECT_EQ(rvs::rand::float_to_half(65504.0f), 0x7BFF);
+  EXPECT_EQ(rvs::rand::float_to_half(1e6f), 0x7C00);
+  // smallest half subnormal
+  EXPECT_EQ(rvs::rand::float_to_half(5.9604645e-8f), 0x0001);
+  // 1 + 2^-11 is a tie, rounds to even (1.0)
+  EXPECT_EQ(rvs::rand::float_to_half(1.00048828125f), 0x3C00);
+}
+
+TEST(rand, float_to_bfloat16) {
+  EXPECT_EQ(rvs::rand::float_to_bfloat16(0.0f), 0x0000);
+  EXPECT_EQ(rvs::rand::float_to_bfloat16(1.0f), 0x3F80);
+  EXPECT_EQ(rvs::rand::float_to_bfloat16(-2.0f), 0xC000);
+  // 1 + 2^-8 is a tie, rounds to even (1.0); 1 + 3 * 2^-8 rounds up
+  EXPECT_EQ(rvs::rand::float_to_bfloat16(1.00390625f), 0x3F80);
+  EXPECT_EQ(rvs::rand::float_to_bfloat16(1.01171875f), 0x3F82);
+}
+
+TEST(rand, uniform_int8) {
+  int lo = 0, hi = 0;
+  for (uint64_t i = 0; i < 100000; i++) {
+    int v = rvs::rand::uniform_int8(42, i);
+    EXPECT_GE(v, -64);
+    EXPECT_LE(v, 63);
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  }
+  EXPECT_EQ(lo, -64);
+  EXPECT_EQ(hi, 63);
+}
+
+TEST(rand, half_to_float) {
+  EXPECT_EQ(rvs::rand::half_to_float(0x3C00), 1.0f);
+  EXPECT_EQ(rvs::rand::half_to_float(0xC000), -2.0f);
+  EXPECT_EQ(rvs::rand::half_to_float(0x7BFF), 65504.0f);
+  EXPECT_EQ(rvs::rand::half_to_float(0x0001), 5.9604645e-8f);
+  // every finite half survives the round trip through float
+  for (uint32_t h = 0; h < 0x10000; h++) {
+    if ((h & 0x7C00) == 0x7C00)
+      continue;
+    EXPECT_EQ(rvs::rand::float_to_half(
+                rvs::rand::half_to_float(static_cast<uint16_t>(h))), h);
+  }
+  EXPECT_EQ(rvs::rand::bfloat16_to_float(0x3F80), 1.0f);
+}
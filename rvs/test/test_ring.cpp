@@ -0,0 +1,101 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_ring.h"
+#include "include/rvs_stats.h"
+
+TEST(spsc_ring, push_pop) {
+  rvs::spsc_ring<int> ring(5);
+  int value;
+
+  EXPECT_EQ(ring.capacity(), 8u);
+  EXPECT_FALSE(ring.pop(&value));
+  for (int i = 0; i < 8; i++)
+    EXPECT_TRUE(ring.push(i));
+  // full: the element is dropped
+  EXPECT_FALSE(ring.push(8));
+  EXPECT_EQ(ring.get_dropped(), 1u);
+  EXPECT_EQ(ring.size(), 8u);
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(ring.pop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(ring.pop(&value));
+}
+
+TEST(spsc_ring, threads) {
+  rvs::spsc_ring<uint64_t> ring(64);
+  const uint64_t count = 200000;
+
+  std::thread producer([&ring, count]() {
+    for (uint64_t i = 0; i < count; i++) {
+      while (!ring.push(i))
+        std::this_thread::yield();
+    }
+  });
+
+  // every element arrives once, in order
+  uint64_t next = 0, value;
+  while (next < count) {
+    if (ring.pop(&value)) {
+      ASSERT_EQ(value, next);
+      next++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(moving_average, window) {
+  // 1 s window, one sample every 10 ms
+  rvs::moving_average avg(1000000000ull);
+
+  EXPECT_EQ(avg.mean(), 0);
+  for (uint64_t i = 0; i < 100; i++)
+    avg.add(i * 10000000ull, 100);
+  EXPECT_EQ(avg.count(), 100u);
+  EXPECT_DOUBLE_EQ(avg.mean(), 100);
+
+  // after another full window only the new level is left
+  for (uint64_t i = 100; i < 200; i++)
+    avg.add(i * 10000000ull, 200);
+  EXPECT_EQ(avg.count(), 100u);
+  EXPECT_DOUBLE_EQ(avg.mean(), 200);
+
+  // half way through a step
+  for (uint64_t i = 200; i < 250; i++)
+    avg.add(i * 10000000ull, 300);
+  EXPECT_DOUBLE_EQ(avg.mean(), 250);
+
+  avg.reset();
+  EXPECT_EQ(avg.count(), 0u);
+}
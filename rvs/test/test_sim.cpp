@@ -0,0 +1,206 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_clock.h"
+#include "include/rvs_pacer.h"
+#include "include/rvs_sim.h"
+
+TEST(sim, virtual_clock) {
+  rvs::virtual_clock clk(1000);
+  EXPECT_EQ(clk.now_ns(), 1000u);
+  clk.sleep_until_ns(5000);
+  EXPECT_EQ(clk.now_ns(), 5000u);
+  // the time never goes back
+  clk.sleep_until_ns(2000);
+  EXPECT_EQ(clk.now_ns(), 5000u);
+  clk.sleep_for_ms(3);
+  EXPECT_EQ(clk.now_ns(), 3005000u);
+  EXPECT_EQ(clk.now_ms(), 3u);
+}
+
+TEST(sim, clock_wait_until) {
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::unique_lock<std::mutex> lk(mtx);
+
+  // simulated time: the wait moves the time to the deadline
+  rvs::virtual_clock vclk(1000);
+  vclk.wait_until_ns(&cv, &lk, 7000);
+  EXPECT_EQ(vclk.now_ns(), 7000u);
+  EXPECT_TRUE(lk.owns_lock());
+
+  // real time: a notification ends the wait long before the deadline
+  rvs::clock* clk = rvs::clock::real();
+  bool done = false;
+  std::thread t([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    {
+      std::lock_guard<std::mutex> g(mtx);
+      done = true;
+    }
+    cv.notify_all();
+  });
+  uint64_t start = clk->now_ns();
+  uint64_t deadline = start + 10000000000ULL;
+  while (!done && clk->now_ns() < deadline)
+    clk->wait_until_ns(&cv, &lk, deadline);
+  EXPECT_TRUE(done);
+  EXPECT_LT(clk->now_ns() - start, 5000000000ULL);
+  lk.unlock();
+  t.join();
+}
+
+TEST(sim, pacer_on_virtual_clock) {
+  rvs::virtual_clock clk;
+  rvs::pacer p(&clk);
+  p.start();
+  for (int i = 0; i < 1000; i++)
+    p.wait_next(5);
+  // 1000 periods of 5 ms, exactly, in no real time
+  EXPECT_EQ(clk.now_ns(), 5000000000ULL);
+  EXPECT_EQ(p.get_late_count(), 0u);
+}
+
+TEST(sim, device_gemm_timing) {
+  rvs::virtual_clock clk;
+  rvs::sim_model model;
+  model.peak_gflops = 1000;
+  model.launch_us = 0;
+  rvs::sim_device dev(model, &clk);
+
+  uint64_t start, end;
+  // 10 Gflop at 1000 Gflops: 10 ms
+  dev.submit(10, &start, &end);
+  EXPECT_EQ(start, 0u);
+  EXPECT_EQ(end, 10000000u);
+  // queued behind the first one
+  dev.submit(10, &start, &end);
+  EXPECT_EQ(start, 10000000u);
+  EXPECT_EQ(end, 20000000u);
+}
+
+TEST(sim, device_jitter_is_reproducible) {
+  rvs::sim_model model;
+  model.jitter = 0.1;
+  model.seed = 42;
+  std::vector<uint64_t> ends[2];
+  for (int r = 0; r < 2; r++) {
+    rvs::virtual_clock clk;
+    rvs::sim_device dev(model, &clk);
+    for (int i = 0; i < 16; i++) {
+      uint64_t start, end;
+      dev.submit(100, &start, &end);
+      ends[r].push_back(end - start);
+      // +/-10% around 10 ms + the launch cost
+      EXPECT_GE(end - start, 9000000u);
+      EXPECT_LE(end - start, 11100000u);
+    }
+  }
+  EXPECT_EQ(ends[0], ends[1]);
+}
+
+TEST(sim, device_power) {
+  rvs::virtual_clock clk;
+  rvs::sim_model model;
+  model.peak_gflops = 1000;
+  model.launch_us = 0;
+  model.idle_power = 50;
+  model.max_power = 250;
+  model.power_tau_ms = 10;
+  rvs::sim_device dev(model, &clk);
+
+  EXPECT_DOUBLE_EQ(dev.get_power(), 50);
+
+  // busy half of the time: the power settles at the middle
+  for (int i = 0; i < 200; i++) {
+    uint64_t start, end;
+    dev.submit(1, &start, &end);
+    clk.sleep_until_ns(end + 1000000);
+    dev.get_power();
+  }
+  EXPECT_NEAR(dev.get_power(), 150, 10);
+
+  // idle again
+  clk.sleep_for_ms(200);
+  uint64_t power_uw;
+  EXPECT_TRUE(dev.read_power_uw(0, &power_uw));
+  EXPECT_NEAR(power_uw / 1e6, 50, 1);
+}
+
+TEST(sim, blas_serial) {
+  rvs::virtual_clock clk;
+  rvs::sim_model model;
+  model.peak_gflops = 1000;
+  model.launch_us = 0;
+  rvs::sim_device dev(model, &clk);
+  rvs_blas_sim blas(&dev, 1000, 1000, 1000, "sgemm");
+
+  ASSERT_FALSE(blas.error());
+  // 2 Gflop per GEMM: 2 ms
+  ASSERT_TRUE(blas.run_blass_gemm());
+  EXPECT_FALSE(blas.is_gemm_op_complete());
+  ASSERT_TRUE(blas.wait_gemm_op_complete());
+  EXPECT_TRUE(blas.is_gemm_op_complete());
+  EXPECT_DOUBLE_EQ(blas.get_gemm_op_time_ms(), 2);
+  EXPECT_EQ(clk.now_ns(), 2000000u);
+  EXPECT_EQ(blas.get_perf_unit(), "flops");
+}
+
+TEST(sim, blas_pipelined) {
+  rvs::virtual_clock clk;
+  rvs::sim_model model;
+  model.peak_gflops = 1000;
+  model.launch_us = 0;
+  rvs::sim_device dev(model, &clk);
+  rvs_blas_sim blas(&dev, 1000, 1000, 1000, "i8gemm", 1, 2, 2);
+
+  ASSERT_TRUE(blas.start_gemm_timeline());
+  ASSERT_TRUE(blas.enqueue_gemm());
+  ASSERT_TRUE(blas.enqueue_gemm());
+  EXPECT_FALSE(blas.enqueue_gemm());
+  EXPECT_EQ(blas.get_gemms_in_flight(), 2);
+  ASSERT_TRUE(blas.wait_oldest_gemm());
+  EXPECT_DOUBLE_EQ(blas.get_last_completion_ms(), 2);
+  ASSERT_TRUE(blas.drain_gemms());
+  EXPECT_DOUBLE_EQ(blas.get_last_completion_ms(), 4);
+  EXPECT_EQ(blas.get_perf_unit(), "ops");
+}
+
+TEST(sim, blas_invalid_ops_type) {
+  rvs::virtual_clock clk;
+  rvs::sim_device dev(rvs::sim_model(), &clk);
+  rvs_blas_sim blas(&dev, 64, 64, 64, "zgemm");
+  EXPECT_TRUE(blas.error());
+  EXPECT_FALSE(blas.run_blass_gemm());
+}
@@ -0,0 +1,121 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "gtest/gtest.h"
+
+#include "include/rvs_stats.h"
+
+TEST(linear_rls, fit) {
+  rvs::linear_rls fit;
+  double x;
+
+  EXPECT_FALSE(fit.solve(100, &x));
+
+  // two samples are enough for an exact line
+  fit.add(1.0, 250);
+  EXPECT_FALSE(fit.solve(100, &x));
+  fit.add(0.5, 145);
+  EXPECT_NEAR(fit.get_offset(), 40, 0.01);
+  EXPECT_NEAR(fit.get_slope(), 210, 0.01);
+  ASSERT_TRUE(fit.solve(145, &x));
+  EXPECT_NEAR(x, 0.5, 1e-4);
+
+  // noisy samples average out
+  for (int i = 0; i < 1000; i++) {
+    double d = (i % 10) / 10.0;
+    fit.add(d, 40 + 210 * d + ((i % 2) ? 2 : -2));
+  }
+  EXPECT_NEAR(fit.predict(0.3), 103, 0.5);
+  EXPECT_EQ(fit.count(), 1002u);
+
+  fit.reset();
+  EXPECT_EQ(fit.count(), 0u);
+  EXPECT_FALSE(fit.solve(100, &x));
+}
+
+TEST(linear_rls, forgetting) {
+  rvs::linear_rls fit(0.8);
+
+  // the relation changes: a fit that forgets follows it
+  for (int i = 0; i < 20; i++)
+    fit.add((i % 4) / 4.0, 40 + 200 * (i % 4) / 4.0);
+  for (int i = 0; i < 40; i++)
+    fit.add((i % 4) / 4.0, 60 + 200 * (i % 4) / 4.0);
+  EXPECT_NEAR(fit.get_offset(), 60, 0.5);
+  EXPECT_NEAR(fit.get_slope(), 200, 0.5);
+
+  double x;
+  ASSERT_TRUE(fit.solve(160, &x));
+  EXPECT_NEAR(x, 0.5, 0.01);
+}
+
+TEST(running_stats, moments) {
+  rvs::running_stats a;
+  rvs::running_stats b;
+
+  EXPECT_EQ(a.count(), 0u);
+  EXPECT_DOUBLE_EQ(a.stddev(), 0);
+
+  // 2 4 4 4 5 5 7 9: mean 5, sample variance 32/7
+  double x[] = {2, 4, 4, 4, 5, 5, 7, 9};
+  for (int i = 0; i < 8; i++)
+    (i < 3 ? a : b).add(x[i] + 1e9);
+  a.merge(b);
+  EXPECT_EQ(a.count(), 8u);
+  EXPECT_NEAR(a.mean(), 5 + 1e9, 1e-6);
+  EXPECT_NEAR(a.variance(), 32.0 / 7, 1e-6);
+  EXPECT_DOUBLE_EQ(a.min(), 2 + 1e9);
+  EXPECT_DOUBLE_EQ(a.max(), 9 + 1e9);
+
+  rvs::ewma e(0.5);
+  e.add(10);
+  EXPECT_DOUBLE_EQ(e.value(), 10);
+  e.add(20);
+  EXPECT_DOUBLE_EQ(e.value(), 15);
+}
+
+TEST(tdigest, quantiles) {
+  rvs::tdigest a(100);
+  rvs::tdigest b(100);
+
+  // 0..99999 shuffled, half in each digest
+  for (int i = 0; i < 100000; i++) {
+    int v = (i * 7919) % 100000;
+    (i % 2 ? a : b).add(v);
+  }
+  a.merge(b);
+  EXPECT_DOUBLE_EQ(a.count(), 100000);
+  EXPECT_LE(a.size(), 200u);
+  EXPECT_DOUBLE_EQ(a.quantile(0), 0);
+  EXPECT_DOUBLE_EQ(a.quantile(1), 99999);
+  EXPECT_NEAR(a.quantile(0.5), 50000, 500);
+  EXPECT_NEAR(a.quantile(0.9), 90000, 300);
+  EXPECT_NEAR(a.quantile(0.99), 99000, 50);
+  EXPECT_NEAR(a.quantile(0.001), 100, 60);
+
+  a.reset();
+  EXPECT_DOUBLE_EQ(a.quantile(0.5), 0);
+  a.add(3);
+  EXPECT_DOUBLE_EQ(a.quantile(0.5), 3);
+}
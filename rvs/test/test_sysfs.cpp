@@ -0,0 +1,113 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_sysfs.h"
+
+namespace {
+
+void write_file(const std::string& path, const std::string& text) {
+  // truncates in place: the inode (and the fds open on it) stay
+  std::ofstream f(path.c_str(), std::ios::trunc);
+  f << text;
+}
+
+}  // namespace
+
+TEST(sysfs, parse) {
+  int64_t v;
+
+  EXPECT_TRUE(rvs::sysfs_parse_int("45000\n", &v));
+  EXPECT_EQ(v, 45000);
+  EXPECT_TRUE(rvs::sysfs_parse_int(" -12", &v));
+  EXPECT_EQ(v, -12);
+  EXPECT_FALSE(rvs::sysfs_parse_int("N/A\n", &v));
+
+  EXPECT_TRUE(rvs::sysfs_parse_dpm("0: 500Mhz \n1: 1300Mhz *\n2: 1700Mhz \n",
+                                   &v));
+  EXPECT_EQ(v, 1300);
+  EXPECT_FALSE(rvs::sysfs_parse_dpm("0: 500Mhz \n1: 1300Mhz \n", &v));
+
+  EXPECT_EQ(rvs::gpu_sysfs::pci_device_path(0x0000000100004308ull, "/s"),
+            "/s/bus/pci/devices/0001:43:01.0");
+}
+
+TEST(sysfs, fake_tree) {
+  char tmpl[] = "/tmp/rvs_sysfs_XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), nullptr);
+  std::string root(tmpl);
+  std::string dev = rvs::gpu_sysfs::pci_device_path(0x300, root);
+  std::string hwmon = dev + "/hwmon/hwmon3";
+
+  ASSERT_EQ(system(("mkdir -p " + hwmon).c_str()), 0);
+  write_file(dev + "/pp_dpm_sclk", "0: 500Mhz \n1: 1300Mhz *\n");
+  write_file(dev + "/pp_dpm_mclk", "0: 100Mhz *\n1: 1000Mhz \n");
+  write_file(hwmon + "/temp1_input", "45000\n");
+  write_file(hwmon + "/pwm1", "80\n");
+  write_file(hwmon + "/power1_average", "150000000\n");
+
+  rvs::gpu_sysfs gpu(dev);
+  ASSERT_TRUE(gpu.open());
+  int64_t v;
+  ASSERT_TRUE(gpu.read(rvs::gpu_sysfs::SYSFS_TEMP, &v));
+  EXPECT_EQ(v, 45000);
+  ASSERT_TRUE(gpu.read(rvs::gpu_sysfs::SYSFS_SCLK, &v));
+  EXPECT_EQ(v, 1300);
+  ASSERT_TRUE(gpu.read(rvs::gpu_sysfs::SYSFS_MCLK, &v));
+  EXPECT_EQ(v, 100);
+  ASSERT_TRUE(gpu.read(rvs::gpu_sysfs::SYSFS_FAN, &v));
+  EXPECT_EQ(v, 80);
+  ASSERT_TRUE(gpu.read(rvs::gpu_sysfs::SYSFS_POWER, &v));
+  EXPECT_EQ(v, 150000000);
+
+  // the open attributes see the new values
+  write_file(hwmon + "/temp1_input", "71000\n");
+  write_file(dev + "/pp_dpm_sclk", "0: 500Mhz *\n1: 1300Mhz \n");
+  ASSERT_TRUE(gpu.read(rvs::gpu_sysfs::SYSFS_TEMP, &v));
+  EXPECT_EQ(v, 71000);
+  ASSERT_TRUE(gpu.read(rvs::gpu_sysfs::SYSFS_SCLK, &v));
+  EXPECT_EQ(v, 500);
+
+  // a metric the GPU does not expose
+  unlink((hwmon + "/pwm1").c_str());
+  rvs::gpu_sysfs gpu2(dev);
+  ASSERT_TRUE(gpu2.open());
+  EXPECT_FALSE(gpu2.has(rvs::gpu_sysfs::SYSFS_FAN));
+  EXPECT_FALSE(gpu2.read(rvs::gpu_sysfs::SYSFS_FAN, &v));
+  EXPECT_TRUE(gpu2.has(rvs::gpu_sysfs::SYSFS_POWER));
+
+  rvs::gpu_sysfs none(root + "/bus/pci/devices/0000:04:00.0");
+  EXPECT_FALSE(none.open());
+
+  EXPECT_EQ(system(("rm -rf " + root).c_str()), 0);
+}
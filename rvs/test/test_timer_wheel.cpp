@@ -0,0 +1,146 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_timer_wheel.h"
+
+TEST(timer_wheel, periodic) {
+  rvs::timer_wheel wheel;
+  std::atomic<int> fast(0), slow(0), once(0);
+
+  auto t0 = std::chrono::steady_clock::now();
+  wheel.add(5000000, [&fast]() { fast++; });
+  uint64_t id = wheel.add(50000000, [&slow]() { slow++; });
+  wheel.add(20000000, [&once]() { once++; }, true);
+  EXPECT_EQ(wheel.size(), 3u);
+
+  std::this_thread::sleep_until(t0 + std::chrono::milliseconds(502));
+  // the deadlines do not drift: 100 and 10 periods (one tick of slack)
+  EXPECT_GE(fast, 98);
+  EXPECT_LE(fast, 100);
+  EXPECT_GE(slow, 9);
+  EXPECT_LE(slow, 10);
+  EXPECT_EQ(once, 1);
+  EXPECT_EQ(wheel.size(), 2u);
+
+  EXPECT_TRUE(wheel.cancel(id));
+  EXPECT_FALSE(wheel.cancel(id));
+  int slow_done = slow;
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  EXPECT_EQ(slow, slow_done);
+  EXPECT_EQ(wheel.size(), 1u);
+}
+
+TEST(timer_wheel, long_period_and_stop) {
+  // 1 ms ticks, 8 slots: the timer goes around the wheel several times
+  rvs::timer_wheel wheel(1000000, 8);
+  std::atomic<int> fired(0);
+
+  wheel.add(30000000, [&fired]() { fired++; }, true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(fired, 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(fired, 1);
+
+  // stop() does not wait for the next deadline
+  wheel.add(10000000000ull, [&fired]() { fired++; });
+  auto t0 = std::chrono::steady_clock::now();
+  wheel.stop();
+  EXPECT_LT(std::chrono::steady_clock::now() - t0,
+            std::chrono::milliseconds(100));
+  EXPECT_EQ(fired, 1);
+}
+
+TEST(timer_wheel, cancel_from_callback) {
+  rvs::timer_wheel wheel;
+  std::atomic<int> fired(0);
+  std::atomic<uint64_t> id(0);
+
+  id = wheel.add(2000000, [&]() {
+    if (++fired == 3)
+      wheel.cancel(id);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(fired, 3);
+  EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(timer_wheel, cancel_due_timer) {
+  // 50 ms ticks: both timers are due in the same tick, each callback cancels
+  // the other timer, so only the first one to fire keeps running
+  rvs::timer_wheel wheel(50000000);
+  std::atomic<int> fired_a(0), fired_b(0);
+  uint64_t id_a = 0, id_b = 0;
+  std::mutex mtx;
+
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    id_a = wheel.add(100000000, [&]() {
+      std::lock_guard<std::mutex> lk(mtx);
+      fired_a++;
+      wheel.cancel(id_b);
+    });
+    id_b = wheel.add(100000000, [&]() {
+      std::lock_guard<std::mutex> lk(mtx);
+      fired_b++;
+      wheel.cancel(id_a);
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(480));
+  EXPECT_TRUE(fired_a == 0 || fired_b == 0);
+  EXPECT_GE(fired_a + fired_b, 3);
+  EXPECT_EQ(wheel.size(), 1u);
+}
+
+TEST(timer_wheel, add_after_stop) {
+  // stop() comes while a slow callback runs; add() right after it restarts
+  // the wheel once that callback returned
+  rvs::timer_wheel wheel(1000000);
+  std::atomic<int> slow(0), fired(0);
+
+  wheel.add(2000000, [&slow]() {
+    slow++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }, true);
+  while (slow == 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  std::thread stopper([&wheel]() { wheel.stop(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  wheel.add(2000000, [&fired]() { fired++; }, true);
+  stopper.join();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  EXPECT_EQ(slow, 1);
+  EXPECT_EQ(fired, 1);
+  EXPECT_EQ(wheel.size(), 0u);
+}
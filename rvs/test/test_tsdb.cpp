@@ -0,0 +1,189 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_tsdb.h"
+
+class tsdb : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char tmpl[] = "/tmp/rvs_tsdb_XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    dir = tmpl;
+  }
+  void TearDown() override {
+    std::string cmd = "rm -rf " + dir;
+    ASSERT_EQ(system(cmd.c_str()), 0);
+  }
+  std::string dir;
+};
+
+TEST(ts_encoder, round_trip) {
+  rvs::ts_encoder enc(RVS_TS_BLOCK_SIZE - RVS_TS_BLOCK_HEADER);
+  std::vector<rvs::ts_sample> in;
+  rvs::ts_sample s;
+
+  // steady 100 ms rate with some jitter, a pause, repeated and odd values
+  const double odd[] = {-0.0, std::numeric_limits<double>::infinity(),
+                        -1e300, 1e-300, NAN};
+  uint64_t t = 1234567890123456ull;
+  for (int i = 0; i < 200; i++) {
+    t += 100000000ull + (i % 7 == 0 ? 35000 : 0);
+    if (i == 100)
+      t += 3600000000000ull;
+    s.t_ns = t / 1000 * 1000;
+    s.value = i < 20 ? 1700 : (i < 190 ? 45.125 + (i % 5) * 0.375 :
+                                         odd[i % 5]);
+    ASSERT_TRUE(enc.add(s.t_ns, s.value));
+    in.push_back(s);
+  }
+  EXPECT_EQ(enc.count(), 200u);
+  EXPECT_EQ(enc.first_ns(), in.front().t_ns);
+  EXPECT_EQ(enc.last_ns(), in.back().t_ns);
+  // 16 bytes for the first sample, a few bytes for the others
+  EXPECT_LT(enc.size(), 16u + 199 * 4);
+
+  rvs::ts_decoder dec(enc.data(), enc.size(), enc.count());
+  for (size_t i = 0; i < in.size(); i++) {
+    ASSERT_TRUE(dec.next(&s));
+    EXPECT_EQ(s.t_ns, in[i].t_ns);
+    if (isnan(in[i].value))
+      EXPECT_TRUE(isnan(s.value));
+    else
+      EXPECT_EQ(memcmp(&s.value, &in[i].value, sizeof(double)), 0);
+  }
+  EXPECT_FALSE(dec.next(&s));
+}
+
+TEST(ts_encoder, full) {
+  rvs::ts_encoder enc(64);
+  int n = 0;
+
+  // random bits do not compress: the block fills up, and never overflows
+  srand(1);
+  while (enc.add(n * 1000000ull + rand() % 100000, rand() * 1e-3 * rand()))
+    n++;
+  EXPECT_GT(n, 2);
+  EXPECT_LE(enc.size(), 64u);
+  EXPECT_EQ(enc.count(), static_cast<uint32_t>(n));
+
+  enc.reset();
+  EXPECT_EQ(enc.count(), 0u);
+  EXPECT_EQ(enc.size(), 0u);
+}
+
+TEST_F(tsdb, write_and_query) {
+  std::string path = dir + "/gm.rvsts";
+  rvs::ts_writer w;
+  std::vector<rvs::ts_sample> samples;
+
+  EXPECT_FALSE(w.append(1, "gm.temp", 0, 1));
+  ASSERT_TRUE(w.open(path));
+  // enough samples for several blocks per series
+  const uint64_t t0 = 5000000000ull, dt = 10000000ull;
+  for (uint64_t i = 0; i < 20000; i++) {
+    ASSERT_TRUE(w.append(3, "gm.temp", t0 + i * dt, 40 + (i / 100) % 30));
+    ASSERT_TRUE(w.append(3, "gm.power", t0 + i * dt, 100 + (i * 7919) % 150));
+    if (i % 4 == 0) {
+      ASSERT_TRUE(w.append(5, "gm.temp", t0 + i * dt, 55));
+    }
+  }
+  ASSERT_TRUE(w.close());
+  EXPECT_FALSE(w.is_open());
+
+  struct stat st;
+  ASSERT_EQ(stat(path.c_str(), &st), 0);
+  // far smaller than the 16 bytes of a raw sample
+  EXPECT_LT(st.st_size, 45000 * 4);
+
+  rvs::ts_reader r;
+  ASSERT_TRUE(r.open(path));
+  EXPECT_TRUE(r.has_index());
+  std::vector<rvs::ts_reader::series_info> series = r.get_series();
+  ASSERT_EQ(series.size(), 3u);
+  EXPECT_EQ(series[0].gpu_id, 3);
+  EXPECT_EQ(series[0].metric, "gm.power");
+  EXPECT_EQ(series[1].metric, "gm.temp");
+  EXPECT_EQ(series[1].count, 20000u);
+  EXPECT_EQ(series[1].first_ns, t0);
+  EXPECT_EQ(series[1].last_ns, t0 + 19999 * dt);
+  EXPECT_EQ(series[2].gpu_id, 5);
+  EXPECT_EQ(series[2].count, 5000u);
+
+  // a range spanning block boundaries
+  ASSERT_TRUE(r.query(3, "gm.power", t0 + 1234 * dt, t0 + 15678 * dt,
+                      &samples));
+  ASSERT_EQ(samples.size(), 15678u - 1234 + 1);
+  for (size_t k = 0; k < samples.size(); k++) {
+    uint64_t i = 1234 + k;
+    ASSERT_EQ(samples[k].t_ns, t0 + i * dt);
+    ASSERT_EQ(samples[k].value, 100 + (i * 7919) % 150);
+  }
+
+  ASSERT_TRUE(r.query(5, "gm.temp", 0, UINT64_MAX, &samples));
+  EXPECT_EQ(samples.size(), 5000u);
+  ASSERT_TRUE(r.query(4, "gm.temp", 0, UINT64_MAX, &samples));
+  EXPECT_TRUE(samples.empty());
+}
+
+TEST_F(tsdb, not_closed) {
+  std::string path = dir + "/iet.rvsts";
+  rvs::ts_writer w;
+  std::vector<rvs::ts_sample> samples;
+
+  ASSERT_TRUE(w.open(path));
+  for (uint64_t i = 0; i < 3000; i++)
+    ASSERT_TRUE(w.append(7, "iet.power", i * 1000000ull, 150 + i % 3));
+  ASSERT_TRUE(w.sync());
+
+  // the blocks are found from their headers
+  rvs::ts_reader r;
+  ASSERT_TRUE(r.open(path));
+  EXPECT_FALSE(r.has_index());
+  ASSERT_TRUE(r.query(7, "iet.power", 0, UINT64_MAX, &samples));
+  ASSERT_EQ(samples.size(), 3000u);
+  EXPECT_EQ(samples[2999].t_ns, 2999000000ull);
+  EXPECT_EQ(samples[2999].value, 152);
+
+  // the block being filled is rewritten in place
+  ASSERT_TRUE(w.append(7, "iet.power", 3000000000ull, 149));
+  ASSERT_TRUE(w.close());
+  ASSERT_TRUE(r.open(path));
+  EXPECT_TRUE(r.has_index());
+  ASSERT_TRUE(r.query(7, "iet.power", 2999000000ull, UINT64_MAX, &samples));
+  ASSERT_EQ(samples.size(), 2u);
+  EXPECT_EQ(samples[1].value, 149);
+}
@@ -0,0 +1,372 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_autotune.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hip/hip_runtime.h"
+#include "include/gpu_util.h"
+
+//! square GEMM sizes tried by the sweep (multiples of 64 plus the sizes the
+//! per-product configurations settled on)
+static const uint64_t autotune_sizes[] = {
+  1920, 2880, 4096, 5760, 8192, 8640, 11520
+};
+
+/**
+ * @brief replaces the characters that would break the cache line format
+ * @param s string to clean
+ * @return s with white space replaced by '_' ("unknown" if empty)
+ */
+static std::string key_token(const std::string& s) {
+  std::string token;
+  for (char c : s) {
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+      token += '_';
+    else
+      token += c;
+  }
+  return token.empty() ? "unknown" : token;
+}
+
+/**
+ * @brief reads the first line of a small text file
+ * @param file_name file path
+ * @return the line (empty if the file cannot be read)
+ */
+static std::string read_first_line(const std::string& file_name) {
+  std::ifstream f(file_name);
+  std::string line;
+  if (f)
+    std::getline(f, line);
+  return line;
+}
+
+/**
+ * @brief class constructor
+ * @param _path cache file path
+ */
+rvs::line_cache::line_cache(const std::string& _path) : path(_path) {
+}
+
+/**
+ * @brief class constructor
+ * @param _path cache file path
+ */
+rvs::autotune_cache::autotune_cache(const std::string& _path)
+    : line_cache(_path) {
+}
+
+/**
+ * @brief class constructor
+ * @param _path cache file path
+ */
+rvs::training_cache::training_cache(const std::string& _path)
+    : line_cache(_path) {
+}
+
+/**
+ * @brief builds the cache key of a GEMM type on a given device
+ * @param ops_type GEMM type (e.g.: sgemm)
+ * @param device_id PCI device ID
+ * @param vbios VBIOS version
+ * @param rocm_version ROCm version
+ * @return cache key
+ */
+std::string rvs::autotune_cache::make_key(const std::string& ops_type,
+                                          uint16_t device_id,
+                                          const std::string& vbios,
+                                          const std::string& rocm_version) {
+  return key_token(ops_type) + "/" + std::to_string(device_id) + "/" +
+         key_token(vbios) + "/" + key_token(rocm_version);
+}
+
+/**
+ * @brief builds the cache key of a GEMM type on a given GPU
+ * @param ops_type GEMM type (e.g.: sgemm)
+ * @param gpu_id GPU ID (as exported by KFD)
+ * @param hip_device_index HIP index of the same GPU
+ * @return cache key
+ */
+std::string rvs::autotune_cache::device_key(const std::string& ops_type,
+                                            uint16_t gpu_id,
+                                            int hip_device_index) {
+  hipDeviceProp_t props;
+  uint16_t device_id = 0;
+  std::string vbios;
+
+  rvs::gpulist::gpu2device(gpu_id, &device_id);
+  if (hipGetDeviceProperties(&props, hip_device_index) == hipSuccess)
+    vbios = read_vbios_version(props.pciDomainID, props.pciBusID,
+                               props.pciDeviceID);
+  return make_key(ops_type, device_id, vbios, read_rocm_version());
+}
+
+/**
+ * @brief reads the ROCm version
+ * @param rocm_path ROCm install location
+ * @return version string ("unknown" if not available)
+ */
+std::string rvs::autotune_cache::read_rocm_version(
+                                            const std::string& rocm_path) {
+  return key_token(read_first_line(rocm_path + "/.info/version"));
+}
+
+/**
+ * @brief reads the VBIOS version of a GPU from sysfs
+ * @param pci_domain PCI domain
+ * @param pci_bus PCI bus
+ * @param pci_device PCI device
+ * @param sysfs sysfs PCI devices folder
+ * @return version string ("unknown" if not available)
+ */
+std::string rvs::autotune_cache::read_vbios_version(int pci_domain,
+                                                    int pci_bus,
+                                                    int pci_device,
+                                                    const std::string& sysfs) {
+  char bdf[32];
+  snprintf(bdf, sizeof(bdf), "%04x:%02x:%02x.0", pci_domain, pci_bus,
+           pci_device);
+  return key_token(read_first_line(sysfs + "/" + bdf + "/vbios_version"));
+}
+
+/**
+ * @brief reads the version of the amdgpu kernel driver
+ * @param sysfs sysfs folder of the amdgpu module
+ * @return version string ("unknown" if not available, e.g.: the driver that
+ * comes with the kernel)
+ */
+std::string rvs::autotune_cache::read_driver_version(
+                                                const std::string& sysfs) {
+  return key_token(read_first_line(sysfs + "/version"));
+}
+
+/**
+ * @brief returns the shapes the sweep starts with (square GEMMs)
+ * @return candidate shapes
+ */
+std::vector<rvs::gemm_shape> rvs::autotune_cache::candidates(void) {
+  std::vector<gemm_shape> shapes;
+  for (uint64_t size : autotune_sizes) {
+    gemm_shape shape = {size, size, size, 0};
+    shapes.push_back(shape);
+  }
+  return shapes;
+}
+
+/**
+ * @brief returns the shapes tried around the best square GEMM (half and
+ * double depth, which trades arithmetic intensity against the C footprint)
+ * @param best best shape of the first sweep
+ * @return candidate shapes
+ */
+std::vector<rvs::gemm_shape> rvs::autotune_cache::refine(
+                                                    const gemm_shape& best) {
+  std::vector<gemm_shape> shapes;
+  gemm_shape shape = best;
+  shape.gflops = 0;
+  if (best.k >= 128) {
+    shape.k = best.k / 2;
+    shapes.push_back(shape);
+  }
+  shape.k = best.k * 2;
+  shapes.push_back(shape);
+  return shapes;
+}
+
+/**
+ * @brief reads all cache lines
+ * @param lines receives the lines
+ * @return true if the cache file exists and could be read
+ */
+bool rvs::line_cache::read_lines(std::vector<std::string> *lines) {
+  std::ifstream f(path);
+  if (!f)
+    return false;
+  std::string line;
+  while (std::getline(f, line)) {
+    if (!line.empty())
+      lines->push_back(line);
+  }
+  return true;
+}
+
+/**
+ * @brief returns the values of all the lines of a key
+ * @param key cache key
+ * @param values receives the values (what follows the key), oldest first
+ * @return true if the key was found
+ */
+bool rvs::line_cache::lookup_values(const std::string& key,
+                                    std::vector<std::string> *values) {
+  std::vector<std::string> lines;
+  if (!read_lines(&lines))
+    return false;
+
+  for (const std::string& line : lines) {
+    std::istringstream ss(line);
+    std::string line_key, rest;
+    if (!(ss >> line_key) || line_key != key)
+      continue;
+    std::getline(ss, rest);
+    values->push_back(rest);
+  }
+  return !values->empty();
+}
+
+/**
+ * @brief looks up the best shape stored for a key
+ * @param key cache key (see make_key())
+ * @param shape receives the shape
+ * @return true if found
+ */
+bool rvs::autotune_cache::lookup(const std::string& key, gemm_shape *shape) {
+  std::vector<std::string> values;
+  if (!lookup_values(key, &values))
+    return false;
+
+  // the last entry wins
+  bool found = false;
+  for (const std::string& value : values) {
+    std::istringstream ss(value);
+    gemm_shape s;
+    if (!(ss >> s.m >> s.n >> s.k >> s.gflops))
+      continue;  // malformed line
+    if (!s.m || !s.n || !s.k)
+      continue;
+    *shape = s;
+    found = true;
+  }
+  return found;
+}
+
+/**
+ * @brief stores (or replaces) the best shape of a key
+ * @param key cache key (see make_key())
+ * @param shape shape to store
+ * @return true if the cache file was updated
+ */
+bool rvs::autotune_cache::store(const std::string& key,
+                                const gemm_shape& shape) {
+  std::ostringstream ss;
+  ss << shape.m << " " << shape.n << " " << shape.k << " " << shape.gflops;
+  return store_values(key, ss.str());
+}
+
+/**
+ * @brief looks up the training result stored for a key
+ * @param key cache key (see autotune_cache::make_key())
+ * @param result receives the result
+ * @return true if found
+ */
+bool rvs::training_cache::lookup(const std::string& key,
+                                 training_result *result) {
+  std::vector<std::string> values;
+  if (!lookup_values(key, &values))
+    return false;
+
+  // the last entry wins
+  bool found = false;
+  for (const std::string& value : values) {
+    std::istringstream ss(value);
+    training_result r;
+    if (!(ss >> r.matrix_size >> r.ms_per_sgemm >> r.avg_power >>
+          r.timestamp))
+      continue;  // malformed line
+    if (!r.matrix_size || r.ms_per_sgemm <= 0 || r.avg_power <= 0)
+      continue;
+    *result = r;
+    found = true;
+  }
+  return found;
+}
+
+/**
+ * @brief stores (or replaces) the training result of a key
+ * @param key cache key (see autotune_cache::make_key())
+ * @param result result to store
+ * @return true if the cache file was updated
+ */
+bool rvs::training_cache::store(const std::string& key,
+                                const training_result& result) {
+  std::ostringstream ss;
+  ss.precision(9);
+  ss << result.matrix_size << " " << result.ms_per_sgemm << " "
+     << result.avg_power << " " << result.timestamp;
+  return store_values(key, ss.str());
+}
+
+/**
+ * @brief stores (or replaces) the values of a key
+ * @param key cache key
+ * @param values values to store
+ * @return true if the cache file was updated
+ */
+bool rvs::line_cache::store_values(const std::string& key,
+                                   const std::string& values) {
+  std::string lock_name = path + ".lock";
+  int lock_fd = open(lock_name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+  if (lock_fd < 0)
+    return false;
+  if (flock(lock_fd, LOCK_EX)) {
+    close(lock_fd);
+    return false;
+  }
+
+  std::vector<std::string> lines;
+  read_lines(&lines);
+
+  std::string tmp_name = path + "." + std::to_string(getpid()) + ".tmp";
+  bool bsts;
+  {
+    std::ofstream f(tmp_name, std::ios::trunc);
+    for (const std::string& line : lines) {
+      std::istringstream ss(line);
+      std::string line_key;
+      ss >> line_key;
+      if (line_key != key)
+        f << line << "\n";
+    }
+    f << key << " " << values << "\n";
+    f.close();
+    bsts = !f.fail();
+  }
+  if (bsts)
+    bsts = rename(tmp_name.c_str(), path.c_str()) == 0;
+  if (!bsts)
+    unlink(tmp_name.c_str());
+
+  flock(lock_fd, LOCK_UN);
+  close(lock_fd);
+  return bsts;
+}
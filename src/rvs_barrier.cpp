@@ -0,0 +1,83 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_barrier.h"
+
+/**
+ * @brief class constructor
+ * @param _count number of threads in the group
+ * @param _clk time source of the release times
+ */
+rvs::barrier::barrier(unsigned int _count, clock* _clk)
+    : clk(_clk), count(_count), arrived(0), generation(0), release_ns(0) {
+}
+
+/**
+ * @brief releases the waiting threads (mtx must be held)
+ */
+void rvs::barrier::release(void) {
+  arrived = 0;
+  generation++;
+  release_ns = clk->now_ns();
+  cv.notify_all();
+}
+
+/**
+ * @brief blocks until all the threads of the group reached the barrier
+ * @return release time (ns, on the barrier clock), the same for all the
+ * threads of a generation
+ */
+uint64_t rvs::barrier::wait(void) {
+  std::unique_lock<std::mutex> lck(mtx);
+  uint64_t gen = generation;
+
+  if (++arrived >= count) {
+    release();
+    return release_ns;
+  }
+  while (gen == generation)
+    cv.wait(lck);
+  return release_ns;
+}
+
+/**
+ * @brief removes the calling thread from the group (for good); the others
+ * are released if they were only waiting for it
+ */
+void rvs::barrier::leave(void) {
+  std::lock_guard<std::mutex> lck(mtx);
+  if (count > 0)
+    count--;
+  if (arrived > 0 && arrived >= count)
+    release();
+}
+
+/**
+ * @brief returns the number of threads still in the group
+ * @return thread count
+ */
+unsigned int rvs::barrier::get_count(void) {
+  std::lock_guard<std::mutex> lck(mtx);
+  return count;
+}
@@ -24,55 +24,860 @@
  *******************************************************************************/
 #include "include/rvs_blas.h"
 
-#include <time.h>
+#include <sched.h>
+#include <math.h>
+#include <algorithm>
 #include <iostream>
+#include <chrono>
+#include <thread>
 
-#define RANDOM_CT               320000
-#define RANDOM_DIV_CT           0.1234
+#include "include/rvs_rand.h"
+#include "include/rvs_cancel.h"
+
+//! how long (in us) GEMM_WAIT_SPIN_YIELD polls before it starts yielding
+#define GEMM_WAIT_SPIN_US       50
+
+#define GEMM_WAIT_BLOCKING_SYNC_STR     "blocking-sync"
+#define GEMM_WAIT_SPIN_YIELD_STR        "spin-yield"
+
+//! unit roundoff of the GEMM element/accumulation types (result verification)
+#define VERIFY_EPS_F16          (1.0 / (1 << 11))
+#define VERIFY_EPS_BF16         (1.0 / (1 << 8))
+#define VERIFY_EPS_F32          (1.0 / (1 << 24))
+#define VERIFY_EPS_F64          (1.0 / 9007199254740992.0)
+//! spacing of the half precision subnormals
+#define VERIFY_MIN_F16          (1.0 / (1 << 24))
 
 rocblas_operation transa = rocblas_operation_none;
 rocblas_operation transb = rocblas_operation_transpose;
 
+/**
+ * @brief tolerance of one verified C element: rounding of the k-term
+ * accumulation (relative to sum |alpha * a * b|), rounding of the stored
+ * result and the subnormal spacing of the C type
+ * @param acc_eps unit roundoff of the accumulation type
+ * @param out_eps unit roundoff of the C type
+ * @param out_min subnormal spacing of the C type
+ * @param abs_sum sum of |alpha * a * b| over k
+ * @param ref host reference value
+ * @return max allowed |gpu - ref|
+ */
+static double verify_tolerance(double acc_eps, double out_eps,
+                               double out_min, double abs_sum, double ref) {
+    return 8 * acc_eps * abs_sum + 2 * out_eps * fabs(ref) + out_min;
+}
+
+//! converts a GEMM element to double (host reference)
+static inline double to_double(float v) { return v; }
+static inline double to_double(double v) { return v; }
+static inline double to_double(int8_t v) { return v; }
+static inline double to_double(int32_t v) { return v; }
+static inline double to_double(rocblas_half v) {
+    return rvs::rand::half_to_float(v.data);
+}
+static inline double to_double(rocblas_bfloat16 v) {
+    return rvs::rand::bfloat16_to_float(v.data);
+}
+
+//! SGEMM traits
+template <>
+struct gemm_traits<float> {
+    typedef float ab_type;
+    typedef float c_type;
+    typedef float scalar_type;
+    static const bool is_integer = false;
+
+    static float alpha(void) { return 1.1; }
+    static float beta(void) { return 0.9; }
+    static float random(uint64_t mseed, uint64_t i) {
+        return rvs::rand::uniform_float(mseed, i);
+    }
+    static float random_c(uint64_t mseed, uint64_t i) {
+        return random(mseed, i);
+    }
+    static double tolerance(double abs_sum, double ref) {
+        return verify_tolerance(VERIFY_EPS_F32, VERIFY_EPS_F32, 0,
+                                abs_sum, ref);
+    }
+    static rocblas_status gemm(rocblas_handle handle, rocblas_int m,
+                               rocblas_int n, rocblas_int k,
+                               const float* alpha, const float* a,
+                               const float* b, const float* beta, float* c) {
+        return rocblas_sgemm(handle, transa, transb, m, n, k,
+                             alpha, a, m, b, n, beta, c, m);
+    }
+    static rocblas_status gemm_strided_batched(rocblas_handle handle,
+                               rocblas_int m, rocblas_int n, rocblas_int k,
+                               const float* alpha,
+                               const float* a, rocblas_stride stride_a,
+                               const float* b, rocblas_stride stride_b,
+                               const float* beta,
+                               float* c, rocblas_stride stride_c,
+                               rocblas_int batch_count) {
+        return rocblas_sgemm_strided_batched(handle, transa, transb, m, n, k,
+                             alpha, a, m, stride_a, b, n, stride_b,
+                             beta, c, m, stride_c, batch_count);
+    }
+};
+
+//! DGEMM traits
+template <>
+struct gemm_traits<double> {
+    typedef double ab_type;
+    typedef double c_type;
+    typedef double scalar_type;
+    static const bool is_integer = false;
+
+    static double alpha(void) { return 1.1; }
+    static double beta(void) { return 0.9; }
+    static double random(uint64_t mseed, uint64_t i) {
+        return rvs::rand::uniform_double(mseed, i);
+    }
+    static double random_c(uint64_t mseed, uint64_t i) {
+        return random(mseed, i);
+    }
+    static double tolerance(double abs_sum, double ref) {
+        return verify_tolerance(VERIFY_EPS_F64, VERIFY_EPS_F64, 0,
+                                abs_sum, ref);
+    }
+    static rocblas_status gemm(rocblas_handle handle, rocblas_int m,
+                               rocblas_int n, rocblas_int k,
+                               const double* alpha, const double* a,
+                               const double* b, const double* beta,
+                               double* c) {
+        return rocblas_dgemm(handle, transa, transb, m, n, k,
+                             alpha, a, m, b, n, beta, c, m);
+    }
+    static rocblas_status gemm_strided_batched(rocblas_handle handle,
+                               rocblas_int m, rocblas_int n, rocblas_int k,
+                               const double* alpha,
+                               const double* a, rocblas_stride stride_a,
+                               const double* b, rocblas_stride stride_b,
+                               const double* beta,
+                               double* c, rocblas_stride stride_c,
+                               rocblas_int batch_count) {
+        return rocblas_dgemm_strided_batched(handle, transa, transb, m, n, k,
+                             alpha, a, m, stride_a, b, n, stride_b,
+                             beta, c, m, stride_c, batch_count);
+    }
+};
+
+//! HGEMM traits
+template <>
+struct gemm_traits<rocblas_half> {
+    typedef rocblas_half ab_type;
+    typedef rocblas_half c_type;
+    typedef rocblas_half scalar_type;
+    static const bool is_integer = false;
+
+    static rocblas_half alpha(void) {
+        rocblas_half h;
+        h.data = 11;
+        return h;
+    }
+    static rocblas_half beta(void) {
+        rocblas_half h;
+        h.data = 2;
+        return h;
+    }
+    static rocblas_half random(uint64_t mseed, uint64_t i) {
+        // converted from float, so the matrix never holds Inf/NaN patterns
+        rocblas_half h;
+        h.data = rvs::rand::float_to_half(rvs::rand::uniform_float(mseed, i));
+        return h;
+    }
+    static rocblas_half random_c(uint64_t mseed, uint64_t i) {
+        return random(mseed, i);
+    }
+    static double tolerance(double abs_sum, double ref) {
+        // the accumulation precision of hgemm is not specified: assume f16
+        return verify_tolerance(VERIFY_EPS_F16, VERIFY_EPS_F16,
+                                VERIFY_MIN_F16, abs_sum, ref);
+    }
+    static rocblas_status gemm(rocblas_handle handle, rocblas_int m,
+                               rocblas_int n, rocblas_int k,
+                               const rocblas_half* alpha,
+                               const rocblas_half* a, const rocblas_half* b,
+                               const rocblas_half* beta, rocblas_half* c) {
+        return rocblas_hgemm(handle, transa, transb, m, n, k,
+                             alpha, a, m, b, n, beta, c, m);
+    }
+    static rocblas_status gemm_strided_batched(rocblas_handle handle,
+                               rocblas_int m, rocblas_int n, rocblas_int k,
+                               const rocblas_half* alpha,
+                               const rocblas_half* a, rocblas_stride stride_a,
+                               const rocblas_half* b, rocblas_stride stride_b,
+                               const rocblas_half* beta,
+                               rocblas_half* c, rocblas_stride stride_c,
+                               rocblas_int batch_count) {
+        return rocblas_hgemm_strided_batched(handle, transa, transb, m, n, k,
+                             alpha, a, m, stride_a, b, n, stride_b,
+                             beta, c, m, stride_c, batch_count);
+    }
+};
+
+/**
+ * @brief rocblas_gemm_ex based GEMM routines for the given A/B, C and compute
+ * types (D is written in place of C)
+ */
+template <rocblas_datatype ab_dt, rocblas_datatype c_dt,
+          rocblas_datatype compute_dt>
+struct gemm_ex_call {
+    static rocblas_status gemm(rocblas_handle handle, rocblas_int m,
+                               rocblas_int n, rocblas_int k,
+                               const void* alpha, const void* a,
+                               const void* b, const void* beta, void* c) {
+        return rocblas_gemm_ex(handle, transa, transb, m, n, k,
+                               alpha, a, ab_dt, m, b, ab_dt, n,
+                               beta, c, c_dt, m, c, c_dt, m,
+                               compute_dt, rocblas_gemm_algo_standard, 0,
+                               rocblas_gemm_flags_none);
+    }
+    static rocblas_status gemm_strided_batched(rocblas_handle handle,
+                               rocblas_int m, rocblas_int n, rocblas_int k,
+                               const void* alpha,
+                               const void* a, rocblas_stride stride_a,
+                               const void* b, rocblas_stride stride_b,
+                               const void* beta,
+                               void* c, rocblas_stride stride_c,
+                               rocblas_int batch_count) {
+        return rocblas_gemm_strided_batched_ex(handle, transa, transb,
+                               m, n, k, alpha,
+                               a, ab_dt, m, stride_a, b, ab_dt, n, stride_b,
+                               beta, c, c_dt, m, stride_c,
+                               c, c_dt, m, stride_c, batch_count,
+                               compute_dt, rocblas_gemm_algo_standard, 0,
+                               rocblas_gemm_flags_none);
+    }
+};
+
+//! tag of the f16 GEMM with f32 accumulation
+struct gemm_f16_f32acc {};
+//! tag of the bf16 GEMM (f32 accumulation)
+struct gemm_bf16 {};
+//! tag of the int8 GEMM (int32 output and accumulation)
+struct gemm_i8 {};
+
+//! f16 in/out, f32 compute GEMM traits
+template <>
+struct gemm_traits<gemm_f16_f32acc> :
+        gemm_ex_call<rocblas_datatype_f16_r, rocblas_datatype_f16_r,
+                     rocblas_datatype_f32_r> {
+    typedef rocblas_half ab_type;
+    typedef rocblas_half c_type;
+    typedef float scalar_type;
+    static const bool is_integer = false;
+
+    static float alpha(void) { return 1.1; }
+    static float beta(void) { return 0.9; }
+    static rocblas_half random(uint64_t mseed, uint64_t i) {
+        return gemm_traits<rocblas_half>::random(mseed, i);
+    }
+    static rocblas_half random_c(uint64_t mseed, uint64_t i) {
+        return random(mseed, i);
+    }
+    static double tolerance(double abs_sum, double ref) {
+        return verify_tolerance(VERIFY_EPS_F32, VERIFY_EPS_F16,
+                                VERIFY_MIN_F16, abs_sum, ref);
+    }
+};
+
+//! bf16 in/out, f32 compute GEMM traits
+template <>
+struct gemm_traits<gemm_bf16> :
+        gemm_ex_call<rocblas_datatype_bf16_r, rocblas_datatype_bf16_r,
+                     rocblas_datatype_f32_r> {
+    typedef rocblas_bfloat16 ab_type;
+    typedef rocblas_bfloat16 c_type;
+    typedef float scalar_type;
+    static const bool is_integer = false;
+
+    static float alpha(void) { return 1.1; }
+    static float beta(void) { return 0.9; }
+    static rocblas_bfloat16 random(uint64_t mseed, uint64_t i) {
+        rocblas_bfloat16 b;
+        b.data = rvs::rand::float_to_bfloat16(
+                    rvs::rand::uniform_float(mseed, i));
+        return b;
+    }
+    static rocblas_bfloat16 random_c(uint64_t mseed, uint64_t i) {
+        return random(mseed, i);
+    }
+    static double tolerance(double abs_sum, double ref) {
+        return verify_tolerance(VERIFY_EPS_F32, VERIFY_EPS_BF16, 0,
+                                abs_sum, ref);
+    }
+};
+
+//! int8 in, int32 out/compute GEMM traits
+template <>
+struct gemm_traits<gemm_i8> :
+        gemm_ex_call<rocblas_datatype_i8_r, rocblas_datatype_i32_r,
+                     rocblas_datatype_i32_r> {
+    typedef int8_t ab_type;
+    typedef int32_t c_type;
+    typedef int32_t scalar_type;
+    static const bool is_integer = true;
+
+    // beta = 0: C is overwritten, so repeated GEMMs never overflow int32
+    static int32_t alpha(void) { return 1; }
+    static int32_t beta(void) { return 0; }
+    static int8_t random(uint64_t mseed, uint64_t i) {
+        return rvs::rand::uniform_int8(mseed, i);
+    }
+    static int32_t random_c(uint64_t mseed, uint64_t i) {
+        return random(mseed, i);
+    }
+    static double tolerance(double, double) {
+        // integer GEMM: exact
+        return 0;
+    }
+};
+
+/**
+ * @brief creates the GEMM engine for the given GEMM type
+ * @param ops_type GEMM type (sgemm, dgemm, hgemm, hgemm_f32acc, bf16gemm,
+ * i8gemm)
+ * @param size_a number of elements in A
+ * @param size_b number of elements in B
+ * @param size_c number of elements in C
+ * @param batch_count number of GEMMs per launch
+ * @param num_c_sets number of independent C sets
+ * @return engine instance or nullptr if the GEMM type is not supported
+ */
+rvs_gemm_engine* rvs_gemm_engine::create(const std::string& ops_type,
+                                         rocblas_int size_a,
+                                         rocblas_int size_b,
+                                         rocblas_int size_c,
+                                         int batch_count, int num_c_sets) {
+    if (ops_type == "sgemm")
+        return new rvs_gemm_engine_t<float>(size_a, size_b, size_c,
+                                            batch_count, num_c_sets);
+    if (ops_type == "dgemm")
+        return new rvs_gemm_engine_t<double>(size_a, size_b, size_c,
+                                             batch_count, num_c_sets);
+    if (ops_type == "hgemm")
+        return new rvs_gemm_engine_t<rocblas_half>(size_a, size_b, size_c,
+                                                   batch_count, num_c_sets);
+    if (ops_type == "hgemm_f32acc")
+        return new rvs_gemm_engine_t<gemm_f16_f32acc>(size_a, size_b, size_c,
+                                                      batch_count,
+                                                      num_c_sets);
+    if (ops_type == "bf16gemm")
+        return new rvs_gemm_engine_t<gemm_bf16>(size_a, size_b, size_c,
+                                                batch_count, num_c_sets);
+    if (ops_type == "i8gemm")
+        return new rvs_gemm_engine_t<gemm_i8>(size_a, size_b, size_c,
+                                              batch_count, num_c_sets);
+    return nullptr;
+}
+
+/**
+ * @brief class constructor
+ * @param _size_a number of elements in A
+ * @param _size_b number of elements in B
+ * @param _size_c number of elements in C
+ * @param _batch_count number of GEMMs per launch (A, B and each C set hold
+ * _batch_count matrices)
+ * @param _num_c_sets number of independent C sets
+ */
+template <typename T>
+rvs_gemm_engine_t<T>::rvs_gemm_engine_t(rocblas_int _size_a,
+                                        rocblas_int _size_b,
+                                        rocblas_int _size_c,
+                                        int _batch_count,
+                                        int _num_c_sets) :
+                                size_a(_size_a),
+                                size_b(_size_b),
+                                size_c(_size_c),
+                                batch_count(_batch_count),
+                                num_c_sets(_num_c_sets) {
+    num_bufs = 1;
+    host_pinned = false;
+    da = db = ha = hb = nullptr;
+    dc = hc = dv = hv = nullptr;
+    verify_tile = 0;
+}
+
+/**
+ * @brief class destructor, releases the host and device matrices
+ */
+template <typename T>
+rvs_gemm_engine_t<T>::~rvs_gemm_engine_t() {
+    if (da)
+        hipFree(da);
+    if (db)
+        hipFree(db);
+    if (dc)
+        hipFree(dc);
+    if (dv)
+        hipFree(dv);
+    if (hv)
+        hipHostFree(hv);
+
+    free_host();
+}
+
+/**
+ * @brief releases the host matrices
+ */
+template <typename T>
+void rvs_gemm_engine_t<T>::free_host(void) {
+    if (host_pinned) {
+        if (ha)
+            hipHostFree(ha);
+        if (hb)
+            hipHostFree(hb);
+        if (hc)
+            hipHostFree(hc);
+    } else {
+        delete []ha;
+        delete []hb;
+        delete []hc;
+    }
+    ha = hb = nullptr;
+    hc = nullptr;
+}
+
+/**
+ * @brief allocates the host matrices
+ * @return true if everything went fine, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::allocate_host(void) {
+    try {
+        ha = new ab_type[bytes_a() / sizeof(ab_type)];
+        hb = new ab_type[bytes_b() / sizeof(ab_type)];
+        hc = new c_type[bytes_c() / sizeof(c_type)];
+        return true;
+    } catch (std::bad_alloc&) {
+        return false;
+    }
+}
+
+/**
+ * @brief allocates the matrices on the current GPU
+ * @return true if everything went fine, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::allocate_gpu(void) {
+    if (hipMalloc(&da, bytes_a() * num_bufs) != hipSuccess)
+        return false;
+    if (hipMalloc(&db, bytes_b() * num_bufs) != hipSuccess)
+        return false;
+    if (hipMalloc(&dc, bytes_c() * num_bufs) != hipSuccess)
+        return false;
+    return true;
+}
+
+/**
+ * @brief moves the host matrices to pinned memory (so that the uploads are
+ * DMA transfers which overlap the GEMMs) and reallocates the device matrices
+ * with _num_bufs copies; must be called before the matrices are filled
+ * @param _num_bufs number of device copies of the matrices
+ * @return true if everything went fine, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::allocate_copy_buffers(int _num_bufs) {
+    free_host();
+    host_pinned = true;
+    if (hipHostMalloc(&ha, bytes_a(), hipHostMallocDefault) != hipSuccess)
+        return false;
+    if (hipHostMalloc(&hb, bytes_b(), hipHostMallocDefault) != hipSuccess)
+        return false;
+    if (hipHostMalloc(&hc, bytes_c(), hipHostMallocDefault) != hipSuccess)
+        return false;
+
+    if (da)
+        hipFree(da);
+    if (db)
+        hipFree(db);
+    if (dc)
+        hipFree(dc);
+    da = db = nullptr;
+    dc = nullptr;
+    num_bufs = _num_bufs;
+    return allocate_gpu();
+}
+
+/**
+ * @brief fills the host matrices with random data (in parallel)
+ * @param seed_a seed of the A sequence
+ * @param seed_b seed of the B sequence
+ * @param seed_c seed of the C sequence
+ */
+template <typename T>
+void rvs_gemm_engine_t<T>::fill_random(uint64_t seed_a, uint64_t seed_b,
+                                       uint64_t seed_c) {
+    rvs::rand::parallel_fill(ha, bytes_a() / sizeof(ab_type),
+                             [seed_a](uint64_t i) {
+        return gemm_traits<T>::random(seed_a, i);
+    });
+    rvs::rand::parallel_fill(hb, bytes_b() / sizeof(ab_type),
+                             [seed_b](uint64_t i) {
+        return gemm_traits<T>::random(seed_b, i);
+    });
+    rvs::rand::parallel_fill(hc, bytes_c() / sizeof(c_type),
+                             [seed_c](uint64_t i) {
+        return gemm_traits<T>::random_c(seed_c, i);
+    });
+}
+
+/**
+ * @brief copies the host matrices to the GPU
+ * @return true if everything went fine, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::copy_to_gpu(void) {
+    if (hipMemcpy(da, ha, bytes_a(), hipMemcpyHostToDevice) != hipSuccess)
+        return false;
+    if (hipMemcpy(db, hb, bytes_b(), hipMemcpyHostToDevice) != hipSuccess)
+        return false;
+    if (hipMemcpy(dc, hc, bytes_c(), hipMemcpyHostToDevice) != hipSuccess)
+        return false;
+    return true;
+}
+
+/**
+ * @brief enqueues the copy of the host matrices to one device copy
+ * @param buf index of the device copy
+ * @param stream HIP stream
+ * @return true if the copies were enqueued, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::copy_to_gpu_async(int buf, hipStream_t stream) {
+    if (hipMemcpyAsync(dev_a(buf), ha, bytes_a(), hipMemcpyHostToDevice,
+                       stream) != hipSuccess)
+        return false;
+    if (hipMemcpyAsync(dev_b(buf), hb, bytes_b(), hipMemcpyHostToDevice,
+                       stream) != hipSuccess)
+        return false;
+    if (hipMemcpyAsync(dev_c(buf), hc, bytes_c(), hipMemcpyHostToDevice,
+                       stream) != hipSuccess)
+        return false;
+    return true;
+}
+
+/**
+ * @brief enqueues the GEMM on the handle's stream
+ * @param handle rocBlas handle
+ * @param m matrix size
+ * @param n matrix size
+ * @param k matrix size
+ * @param c_set index of the C set the GEMM writes to
+ * @param buf index of the device copy of the matrices
+ * @return true if the GEMM was enqueued, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::run_gemm(rocblas_handle handle, rocblas_int m,
+                                    rocblas_int n, rocblas_int k, int c_set,
+                                    int buf) {
+    scalar_type alpha = gemm_traits<T>::alpha();
+    scalar_type beta = gemm_traits<T>::beta();
+    ab_type *a = dev_a(buf);
+    ab_type *b = dev_b(buf);
+    c_type *c = dev_c(buf) +
+                static_cast<uint64_t>(size_c) * batch_count * c_set;
+
+    if (batch_count == 1)
+        return gemm_traits<T>::gemm(handle, m, n, k, &alpha, a, b,
+                                    &beta, c) == rocblas_status_success;
+
+    return gemm_traits<T>::gemm_strided_batched(handle, m, n, k, &alpha,
+                                                a, size_a, b, size_b, &beta,
+                                                c, size_c, batch_count)
+            == rocblas_status_success;
+}
+
+/**
+ * @brief allocates the device C of the verification GEMM and the pinned host
+ * buffer of the sampled tiles
+ * @param tile_size edge of the sampled tiles
+ * @param num_tiles number of tiles sampled by one verification
+ * @return true if everything went fine, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::allocate_verify(int tile_size, int num_tiles) {
+    verify_tile = tile_size;
+    if (hipMalloc(&dv, sizeof(c_type) * static_cast<uint64_t>(size_c))
+            != hipSuccess)
+        return false;
+    if (hipHostMalloc(&hv, sizeof(c_type) * tile_size * tile_size * num_tiles,
+                      hipHostMallocDefault) != hipSuccess)
+        return false;
+    return true;
+}
+
+/**
+ * @brief enqueues the verification GEMM: same A, B and alpha as the stress
+ * GEMM but beta = 0, so that the result only depends on the matrix data
+ * @param handle rocBlas handle
+ * @param m matrix size
+ * @param n matrix size
+ * @param k matrix size
+ * @param batch batch entry (A, B) to multiply
+ * @param buf index of the device copy of the matrices
+ * @return true if the GEMM was enqueued, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::run_verify_gemm(rocblas_handle handle,
+                                           rocblas_int m, rocblas_int n,
+                                           rocblas_int k, int batch,
+                                           int buf) {
+    scalar_type alpha = gemm_traits<T>::alpha();
+    scalar_type beta = scalar_type();  // zero for all the scalar types
+
+    return gemm_traits<T>::gemm(handle, m, n, k, &alpha,
+                            dev_a(buf) + static_cast<uint64_t>(size_a) * batch,
+                            dev_b(buf) + static_cast<uint64_t>(size_b) * batch,
+                            &beta, dv) == rocblas_status_success;
+}
+
+/**
+ * @brief enqueues the copy of one sampled tile of the verification C to the
+ * pinned host buffer (column major, verify_tile x verify_tile)
+ * @param idx tile index in the host buffer
+ * @param tile tile position
+ * @param m matrix size (leading dimension of C)
+ * @param stream HIP stream
+ * @return true if the copy was enqueued, otherwise false
+ */
+template <typename T>
+bool rvs_gemm_engine_t<T>::copy_verify_tile(int idx, const rvs_gemm_tile& tile,
+                                            rocblas_int m,
+                                            hipStream_t stream) {
+    size_t width = sizeof(c_type) * verify_tile;
+
+    return hipMemcpy2DAsync(hv + static_cast<uint64_t>(idx) * verify_tile *
+                                verify_tile, width,
+                            dv + tile.row + static_cast<uint64_t>(tile.col) * m,
+                            sizeof(c_type) * m, width, verify_tile,
+                            hipMemcpyDeviceToHost, stream) == hipSuccess;
+}
+
+/**
+ * @brief recomputes one sampled tile on the host (in double) and collects
+ * the elements which are out of tolerance
+ *
+ * The tile rows of A and the tile rows of B are first gathered into
+ * contiguous double vectors so the k-term dot products are unit stride; each
+ * dot product is split over four accumulators so the compiler can vectorize
+ * it without reassociating a single sum.
+ *
+ * @param m matrix size
+ * @param n matrix size
+ * @param k matrix size
+ * @param batch batch entry (A, B) of the verification GEMM
+ * @param idx tile index in the host buffer
+ * @param tile tile position
+ * @param mm [out] out of tolerance elements
+ */
+template <typename T>
+void rvs_gemm_engine_t<T>::check_tile(rocblas_int m, rocblas_int n,
+                                      rocblas_int k, int batch, int idx,
+                                      const rvs_gemm_tile& tile,
+                                      std::vector<rvs_gemm_mismatch>* mm) {
+    const int t = verify_tile;
+    const ab_type *a = ha + static_cast<uint64_t>(size_a) * batch;
+    const ab_type *b = hb + static_cast<uint64_t>(size_b) * batch;
+    const c_type *gpu = hv + static_cast<uint64_t>(idx) * t * t;
+    const double alpha = to_double(gemm_traits<T>::alpha());
+    std::vector<double> at(static_cast<size_t>(t) * k);
+    std::vector<double> bt(static_cast<size_t>(t) * k);
+
+    // A is m x k and B is n x k (column major), C = alpha * A * B^T
+    for (rocblas_int l = 0; l < k; l++) {
+        for (int i = 0; i < t; i++) {
+            at[static_cast<size_t>(i) * k + l] =
+                to_double(a[tile.row + i + static_cast<uint64_t>(l) * m]);
+            bt[static_cast<size_t>(i) * k + l] =
+                to_double(b[tile.col + i + static_cast<uint64_t>(l) * n]);
+        }
+    }
+
+    for (int j = 0; j < t; j++) {
+        const double *y = &bt[static_cast<size_t>(j) * k];
+        for (int i = 0; i < t; i++) {
+            const double *x = &at[static_cast<size_t>(i) * k];
+            double sum[4] = {0, 0, 0, 0}, abs_sum[4] = {0, 0, 0, 0};
+            rocblas_int l = 0;
+            for (; l + 4 <= k; l += 4) {
+                for (int u = 0; u < 4; u++) {
+                    double p = x[l + u] * y[l + u];
+                    sum[u] += p;
+                    abs_sum[u] += fabs(p);
+                }
+            }
+            for (; l < k; l++) {
+                sum[0] += x[l] * y[l];
+                abs_sum[0] += fabs(x[l] * y[l]);
+            }
+
+            double ref = alpha * ((sum[0] + sum[1]) + (sum[2] + sum[3]));
+            double mag = fabs(alpha) *
+                ((abs_sum[0] + abs_sum[1]) + (abs_sum[2] + abs_sum[3]));
+            double value = to_double(gpu[i + j * t]);
+            // written so that a NaN result fails the check
+            if (!(fabs(value - ref) <= gemm_traits<T>::tolerance(mag, ref))) {
+                rvs_gemm_mismatch mismatch;
+                mismatch.batch = batch;
+                mismatch.row = tile.row + i;
+                mismatch.col = tile.col + j;
+                mismatch.gpu = value;
+                mismatch.ref = ref;
+                mm->push_back(mismatch);
+            }
+        }
+    }
+}
+
+/**
+ * @brief recomputes the sampled tiles on the host, spread over up to
+ * hardware concurrency threads
+ * @param m matrix size
+ * @param n matrix size
+ * @param k matrix size
+ * @param batch batch entry (A, B) of the verification GEMM
+ * @param tiles sampled tiles
+ * @param mm [out] out of tolerance elements
+ */
+template <typename T>
+void rvs_gemm_engine_t<T>::check_verify_tiles(rocblas_int m, rocblas_int n,
+                                    rocblas_int k, int batch,
+                                    const std::vector<rvs_gemm_tile>& tiles,
+                                    std::vector<rvs_gemm_mismatch>* mm) {
+    size_t nthreads = std::min<size_t>(tiles.size(),
+                            std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::vector<rvs_gemm_mismatch>> found(nthreads);
+    std::vector<std::thread> threads;
+
+    auto check_slice = [&](size_t slice) {
+        for (size_t i = slice; i < tiles.size(); i += nthreads)
+            check_tile(m, n, k, batch, static_cast<int>(i), tiles[i],
+                       &found[slice]);
+    };
+    for (size_t t = 1; t < nthreads; t++)
+        threads.push_back(std::thread(check_slice, t));
+    if (nthreads)
+        check_slice(0);
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    mm->clear();
+    for (size_t t = 0; t < nthreads; t++)
+        mm->insert(mm->end(), found[t].begin(), found[t].end());
+}
+
+template class rvs_gemm_engine_t<float>;
+template class rvs_gemm_engine_t<double>;
+template class rvs_gemm_engine_t<rocblas_half>;
+template class rvs_gemm_engine_t<gemm_f16_f32acc>;
+template class rvs_gemm_engine_t<gemm_bf16>;
+template class rvs_gemm_engine_t<gemm_i8>;
+
 /**
  * @brief class constructor
  * @param _gpu_device_index the gpu that will run the GEMM
  * @param _m matrix size
  * @param _n matrix size
  * @param _k matrix size
+ * @param _ops_type GEMM type (sgemm, dgemm, hgemm, hgemm_f32acc, bf16gemm,
+ * i8gemm); only the host and device
+ * matrices of this precision are allocated
+ * @param _batch_count number of GEMMs per launch (> 1 selects the
+ * strided-batched GEMM)
+ * @param _num_streams number of streams used by enqueue_gemm()
+ * @param _num_inflight max number of launches enqueue_gemm() keeps in flight
  */
-rvs_blas::rvs_blas(int _gpu_device_index, int _m, int _n, int _k) :
-                             gpu_device_index(_gpu_device_index),
+rvs_blas::rvs_blas(int _gpu_device_index, int _m, int _n, int _k,
+                   const std::string& _ops_type, int _batch_count,
+                   int _num_streams, int _num_inflight) :
+                             rvs_blas(_m, _n, _k, _ops_type, _batch_count,
+                                      _num_streams, _num_inflight) {
+    gpu_device_index = _gpu_device_index;
+    if (is_error)
+        return;
+
+    // the GEMM type is resolved here, once; each stream gets its own C set
+    engine.reset(rvs_gemm_engine::create(ops_type, size_a, size_b, size_c,
+                                         batch_count, num_streams));
+    if (!engine) {
+        is_error = true;
+        return;
+    }
+
+    if (engine->allocate_host()) {
+        if (!init_gpu_device())
+            is_error = true;
+    } else {
+        is_error = true;
+    }
+}
+
+/**
+ * @brief initializes the GEMM parameters and state only (no GPU or host
+ * resources); used by the simulated devices
+ * @param _m matrix size
+ * @param _n matrix size
+ * @param _k matrix size
+ * @param _ops_type GEMM type
+ * @param _batch_count number of GEMMs per launch
+ * @param _num_streams number of streams used by enqueue_gemm()
+ * @param _num_inflight max number of launches enqueue_gemm() keeps in flight
+ */
+rvs_blas::rvs_blas(int _m, int _n, int _k, const std::string& _ops_type,
+                   int _batch_count, int _num_streams, int _num_inflight) :
+                             gpu_device_index(-1),
                              m(_m),
                              n(_n),
-                             k(_k) {
+                             k(_k),
+                             ops_type(_ops_type),
+                             batch_count(_batch_count),
+                             num_streams(_num_streams),
+                             num_inflight(_num_inflight) {
     is_handle_init = false;
+    is_event_init = false;
     is_error = false;
-    da = db = dc = NULL;
-    ha = hb = hc = nullptr;
+    gemm_wait = GEMM_WAIT_BLOCKING_SYNC;
+    notifier = std::make_shared<rvs_gemm_notifier>();
+    seed = 0;
+    is_timeline_init = false;
+    num_submitted = num_completed = 0;
+    last_completion_ms = 0;
+    is_verify_init = false;
+    verify_num_tiles = 0;
+    num_verify = 0;
+    verify_batch = 0;
+    is_copy_init = false;
+    num_copies = 0;
+    gemm_buf = 0;
 
     size_a = k * m;
     size_b = k * n;
     size_c = n * m;
 
-    if (alocate_host_matrix_mem()) {
-        if (!init_gpu_device())
-            is_error = true;
-    } else {
+    if (batch_count < 1 || num_streams < 1 || num_inflight < 1)
         is_error = true;
-    }
 }
 
 /**
  * @brief class destructor
  */
 rvs_blas::~rvs_blas() {
-    release_host_matrix_mem();
-    release_gpu_matrix_mem();
+    // the host side of a verification may still use the engine
+    if (verify_result.valid())
+        verify_result.wait();
+    // uploads may still read the pinned host matrices
+    if (is_copy_init)
+        hipStreamSynchronize(copy_stream);
+    engine.reset();
+    release_gpu_resources();
 }
 
 /**
  * @brief selects GPU device, allocates GPU memory, creates a rocBlas
- * handle and get a reference to the rocBlas's stream
+ * handle, gets a reference to the rocBlas's stream and creates the events
+ * used to track GEMM completion
  * @return true if everything went fine, otherwise false
  */
 bool rvs_blas::init_gpu_device(void) {
@@ -81,353 +886,704 @@ bool rvs_blas::init_gpu_device(void) {
         // cannot select the given GPU device
         return false;
     } else {
-        if (!allocate_gpu_matrix_mem())
+        if (!engine->allocate_gpu())
             return false;
         if (rocblas_create_handle(&blas_handle) == rocblas_status_success) {
             is_handle_init = true;
             if (rocblas_get_stream(blas_handle, &hip_stream)
                  != rocblas_status_success)
                 return false;
+            cur_stream = hip_stream;
         } else {
             return false;
         }
+
+        // blocking-sync events let hipEventSynchronize() put the calling
+        // thread to sleep instead of spinning on the completion signal
+        // (wait_event() sleeps on the notifier instead)
+        if (hipEventCreateWithFlags(&gemm_start_event, hipEventBlockingSync)
+                != hipSuccess)
+            return false;
+        if (hipEventCreateWithFlags(&gemm_stop_event, hipEventBlockingSync)
+                != hipSuccess) {
+            hipEventDestroy(gemm_start_event);
+            return false;
+        }
+        is_event_init = true;
+
+        if (!init_gemm_streams())
+            return false;
     }
     return true;
 }
 
+/**
+ * @brief creates the streams and the per slot events used by the pipelined
+ * submission (enqueue_gemm())
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::init_gemm_streams(void) {
+    hipStream_t stream;
+    hipEvent_t event;
+
+    if (hipEventCreate(&timeline_event) != hipSuccess)
+        return false;
+    is_timeline_init = true;
+
+    for (int i = 0; i < num_streams; i++) {
+        if (hipStreamCreateWithFlags(&stream, hipStreamNonBlocking)
+                != hipSuccess)
+            return false;
+        gemm_streams.push_back(stream);
+    }
+
+    for (int i = 0; i < num_inflight; i++) {
+        if (hipEventCreateWithFlags(&event, hipEventBlockingSync)
+                != hipSuccess)
+            return false;
+        slot_stop_events.push_back(event);
+    }
+
+    return true;
+}
+
+/**
+ * @brief sets up the asynchronous upload used by copy_data_to_gpu(): pinned
+ * host matrices, RVS_BLAS_COPY_BUFS device copies of the matrices and a
+ * dedicated copy stream; must be called before
+ * generate_random_matrix_data()
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::init_async_copy(void) {
+    if (is_error || is_copy_init)
+        return false;
+
+    if (!engine->allocate_copy_buffers(RVS_BLAS_COPY_BUFS))
+        return false;
+    if (hipStreamCreateWithFlags(&copy_stream, hipStreamNonBlocking)
+            != hipSuccess)
+        return false;
+    is_copy_init = true;
+
+    // the events only order the streams, they are never timed
+    for (int i = 0; i < RVS_BLAS_COPY_BUFS; i++) {
+        if (hipEventCreateWithFlags(&copy_done_events[i],
+                                    hipEventDisableTiming) != hipSuccess)
+            return false;
+        if (hipEventCreateWithFlags(&buf_free_events[i],
+                                    hipEventDisableTiming) != hipSuccess)
+            return false;
+    }
+    num_copies = 0;
+    gemm_buf = 0;
+    return true;
+}
+
 /**
  * @brief copy data matrix from host to gpu
+ *
+ * Once init_async_copy() was called the upload does not block: it goes to
+ * the next device copy of the matrices, on the copy stream, after the GEMMs
+ * which read that copy completed. The next GEMM waits (on the GPU) for the
+ * upload, so an upload issued right after a GEMM runs over PCIe while that
+ * GEMM computes.
+ *
  * @return true if everything went fine, otherwise false
  */
-bool rvs_blas::copy_data_to_gpu(std::string ops_type) {
-    if (!is_error) {
+bool rvs_blas::copy_data_to_gpu(void) {
+    if (is_error)
+        return false;
 
-      if(ops_type == "sgemm") {
+    if (!is_copy_init) {
+        if (!engine->copy_to_gpu()) {
+            is_error = true;
+            return false;
+        }
+        return true;
+    }
 
-            if (da) {
-                 if (hipMemcpy(da, ha, sizeof(float) * size_a, hipMemcpyHostToDevice)
-                                 != hipSuccess) {
-                      is_error = true;
-                      return false;
-                  }
-            }
+    int buf = static_cast<int>(num_copies % RVS_BLAS_COPY_BUFS);
+    if (hipStreamWaitEvent(copy_stream, buf_free_events[buf], 0)
+            != hipSuccess ||
+        !engine->copy_to_gpu_async(buf, copy_stream) ||
+        hipEventRecord(copy_done_events[buf], copy_stream) != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+    num_copies++;
+    gemm_buf = buf;
+    return true;
+}
 
-            if (db) {
-                if (hipMemcpy(db, hb, sizeof(float) * size_b, hipMemcpyHostToDevice)
-                                != hipSuccess) {
-                      is_error = true;
-                      return false;
-                  }
-            }
+/**
+ * @brief makes a stream wait for the upload of the matrices the next GEMM
+ * reads (no-op without asynchronous upload)
+ * @param stream HIP stream the GEMM is enqueued on
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::acquire_gemm_buf(hipStream_t stream) {
+    if (!is_copy_init)
+        return true;
+    if (hipStreamWaitEvent(stream, copy_done_events[gemm_buf], 0)
+            != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+    return true;
+}
 
-            if (dc) {
-                  if (hipMemcpy(dc, hc, sizeof(float) * size_c, hipMemcpyHostToDevice)
-                          != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-             }
-      }
+/**
+ * @brief marks the matrices of the GEMM just enqueued on a stream as free
+ * for the next upload once that GEMM completes (no-op without asynchronous
+ * upload)
+ * @param stream HIP stream the GEMM was enqueued on
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::release_gemm_buf(hipStream_t stream) {
+    if (!is_copy_init)
+        return true;
+    return record_gemm_event(buf_free_events[gemm_buf], stream);
+}
 
+/**
+ * @brief checks whether the GEMM type is one rvs_blas can run
+ * @param _ops_type GEMM type as given in .conf
+ * @return true if ops_type is sgemm, dgemm, hgemm, hgemm_f32acc, bf16gemm
+ * or i8gemm, false otherwise
+ */
+bool rvs_blas::is_ops_type_valid(const std::string& _ops_type) {
+    return _ops_type == "sgemm" || _ops_type == "dgemm" ||
+           _ops_type == "hgemm" || _ops_type == "hgemm_f32acc" ||
+           _ops_type == "bf16gemm" || _ops_type == "i8gemm";
+}
 
-      if(ops_type == "dgemm") {
+/**
+ * @brief destroys the GEMM events, the submission streams & the rocBlas
+ * handle
+ */
+void rvs_blas::release_gpu_resources(void) {
+    if (is_event_init) {
+        hipEventDestroy(gemm_start_event);
+        hipEventDestroy(gemm_stop_event);
+    }
 
-            if (ddbla) {
-                  if (hipMemcpy(ddbla, hdbla, sizeof(double) * size_a, hipMemcpyHostToDevice)
-                                     != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    if (is_timeline_init)
+        hipEventDestroy(timeline_event);
+    if (is_verify_init)
+        hipEventDestroy(verify_event);
+    if (is_copy_init) {
+        for (int i = 0; i < RVS_BLAS_COPY_BUFS; i++) {
+            hipEventDestroy(copy_done_events[i]);
+            hipEventDestroy(buf_free_events[i]);
+        }
+        hipStreamDestroy(copy_stream);
+    }
+    for (size_t i = 0; i < slot_stop_events.size(); i++)
+        hipEventDestroy(slot_stop_events[i]);
+    for (size_t i = 0; i < gemm_streams.size(); i++)
+        hipStreamDestroy(gemm_streams[i]);
 
-            if (ddblb) {
-                  if (hipMemcpy(ddblb, hdblb, sizeof(double) * size_b, hipMemcpyHostToDevice)
-                                    != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    if (is_handle_init)
+        rocblas_destroy_handle(blas_handle);
+}
 
-            if (ddblc) {
-                  if (hipMemcpy(ddblc, hdblc, sizeof(double) * size_c, hipMemcpyHostToDevice)
-                                  != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-            }
+/**
+ * @brief checks whether the matrix multiplication completed
+ * @return true if GPU finished with matrix multiplication, otherwise false
+ */
+bool rvs_blas::is_gemm_op_complete(void) {
+    if (is_error)
+        return true;  // avoid blocking the calling thread
+    if (hipStreamQuery(hip_stream) != hipSuccess)
+        return false;
+    return true;
+}
 
-      }
+/**
+ * @brief performs the GEMM matrix multiplication
+ * @return true if GPU was able to enqueue the GEMM operation, otherwise false
+ */
+bool rvs_blas::run_blass_gemm(void) {
+    if (is_error)
+        return false;
 
-      if(ops_type == "hgemm") {
+    if (!select_stream(hip_stream))
+        return false;
 
-            if (dhlfa) {
-                  if (hipMemcpy(dhlfa, hhlfa, sizeof(rocblas_half) * size_a, hipMemcpyHostToDevice)
-                                     != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    // the start event follows the wait for the upload, so the GEMM time
+    // does not include the PCIe transfer
+    if (!acquire_gemm_buf(hip_stream))
+        return false;
 
-            if (dhlfb) {
-                  if (hipMemcpy(dhlfb, hhlfb, sizeof(rocblas_half) * size_b, hipMemcpyHostToDevice)
-                                    != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    if (!record_gemm_event(gemm_start_event, hip_stream))
+        return false;
 
-            if (dhlfc) {
-                  if (hipMemcpy(dhlfc, hhlfc, sizeof(rocblas_half) * size_c, hipMemcpyHostToDevice)
-                                  != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-            }
+    if (!engine->run_gemm(blas_handle, m, n, k, 0, gemm_buf)) {
+        is_error = true;  // GPU cannot enqueue the gemm
+        return false;
+    }
 
-      }
+    if (!release_gemm_buf(hip_stream))
+        return false;
 
+    return record_gemm_event(gemm_stop_event, hip_stream, true);
+}
 
-     return true;
-    } else {
+/**
+ * @brief makes the rocBlas handle submit to the given stream
+ * @param stream HIP stream
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::select_stream(hipStream_t stream) {
+    if (stream == cur_stream)
+        return true;
+    if (rocblas_set_stream(blas_handle, stream) != rocblas_status_success) {
+        is_error = true;
         return false;
     }
+    cur_stream = stream;
+    return true;
 }
 
 /**
- * @brief allocates memory (for matrix multiplication) on the selected GPU
+ * @brief resets the pipelined submission: GEMM completion times reported
+ * by get_last_completion_ms() are relative to this point
+ *
+ * Must be called with no GEMM in flight.
+ *
  * @return true if everything went fine, otherwise false
  */
-bool rvs_blas::allocate_gpu_matrix_mem(void) {
-    if (hipMalloc(&da, size_a * sizeof(float)) != hipSuccess)
+bool rvs_blas::start_gemm_timeline(void) {
+    if (is_error || get_gemms_in_flight() != 0)
         return false;
-    if (hipMalloc(&db, size_b * sizeof(float)) != hipSuccess)
+
+    num_submitted = num_completed = 0;
+    last_completion_ms = 0;
+    if (!record_gemm_event(timeline_event, gemm_streams[0]))
         return false;
-    if (hipMalloc(&dc, size_c * sizeof(float)) != hipSuccess)
+    // nothing is in flight: the event completes right away
+    if (hipEventSynchronize(timeline_event) != hipSuccess) {
+        is_error = true;
         return false;
+    }
+    return true;
+}
 
-    if (hipMalloc(&ddbla, size_a * sizeof(double)) != hipSuccess)
+/**
+ * @brief enqueues the next GEMM launch of the pipelined submission
+ *
+ * Launches go round-robin over num_streams streams, each stream writing its
+ * own C set, so the GPU always has queued work and does not drain between
+ * GEMMs. At most num_inflight launches may be in flight.
+ *
+ * @return true if the GEMM was enqueued, false on error or if num_inflight
+ * launches are already in flight
+ */
+bool rvs_blas::enqueue_gemm(void) {
+    if (is_error || get_gemms_in_flight() >= num_inflight)
         return false;
-    if (hipMalloc(&ddblb, size_b * sizeof(double)) != hipSuccess)
+
+    int stream_ix = num_submitted % num_streams;
+    hipStream_t stream = gemm_streams[stream_ix];
+
+    if (!select_stream(stream))
         return false;
-    if (hipMalloc(&ddblc, size_c * sizeof(double)) != hipSuccess)
+
+    if (!acquire_gemm_buf(stream))
         return false;
 
-    if (hipMalloc(&dhlfa, size_a * sizeof(rocblas_half)) != hipSuccess)
+    if (!engine->run_gemm(blas_handle, m, n, k, stream_ix, gemm_buf)) {
+        is_error = true;  // GPU cannot enqueue the gemm
         return false;
-    if (hipMalloc(&dhlfb, size_b * sizeof(rocblas_half)) != hipSuccess)
+    }
+
+    if (!release_gemm_buf(stream))
         return false;
-    if (hipMalloc(&dhlfc, size_c * sizeof(rocblas_half)) != hipSuccess)
+
+    if (!record_gemm_event(slot_stop_events[num_submitted % num_inflight],
+                           stream, true))
         return false;
 
+    num_submitted++;
     return true;
 }
 
 /**
- * @brief releases GPU mem & destroys the rocBlas handle
+ * @brief waits for the oldest in-flight GEMM launch and records its
+ * completion time (see get_last_completion_ms())
+ * @return true if the GEMM completed, false on error or if nothing is in
+ * flight
  */
-void rvs_blas::release_gpu_matrix_mem(void) {
-    if (da)
-        hipFree(da);
-    if (db)
-        hipFree(db);
-    if (dc)
-        hipFree(dc);
+bool rvs_blas::wait_oldest_gemm(void) {
+    float completion_ms = 0;
 
-    if (ddbla)
-        hipFree(ddbla);
-    if (ddblb)
-        hipFree(ddblb);
-    if (ddblc)
-        hipFree(ddblc);
+    if (is_error || get_gemms_in_flight() == 0)
+        return false;
 
-    if (dhlfa)
-        hipFree(dhlfa);
-    if (dhlfb)
-        hipFree(dhlfb);
-    if (dhlfc)
-        hipFree(dhlfc);
+    hipEvent_t event = slot_stop_events[num_completed % num_inflight];
+    if (!wait_event(event))
+        return false;
 
-    if (is_handle_init)
-        rocblas_destroy_handle(blas_handle);
+    if (hipEventElapsedTime(&completion_ms, timeline_event, event)
+            != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+
+    last_completion_ms = static_cast<double>(completion_ms);
+    num_completed++;
+    return true;
 }
 
 /**
- * @brief allocate host matrix memory
+ * @brief waits for all in-flight GEMM launches
  * @return true if everything went fine, otherwise false
  */
-bool rvs_blas::alocate_host_matrix_mem(void) {
-
-    try {
-        ha = new float[size_a];
-        hb = new float[size_b];
-        hc = new float[size_c];
-
-        hdbla = new double[size_a];
-        hdblb = new double[size_b];
-        hdblc = new double[size_c];
-
-        hhlfa = new rocblas_half[size_a];
-        hhlfb = new rocblas_half[size_b];
-        hhlfc = new rocblas_half[size_c];
+bool rvs_blas::drain_gemms(void) {
+    while (get_gemms_in_flight() > 0) {
+        if (!wait_oldest_gemm())
+            return false;
+    }
+    return true;
+}
 
+/**
+ * @brief records one of the GEMM events on the given stream
+ *
+ * A host function holds its stream until it ran, so only the completion
+ * events a thread waits for (wait_event()) get one: the start events and
+ * the ones the GPU alone waits for do not delay the next GEMM.
+ *
+ * @param event event to record
+ * @param stream HIP stream
+ * @param waited true if wait_event() will wait for the event
+ * @return true if the event was enqueued, otherwise false
+ */
+bool rvs_blas::record_gemm_event(hipEvent_t event, hipStream_t stream,
+                                 bool waited) {
+    if (hipEventRecord(event, stream) != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+    if (!waited || gemm_wait != GEMM_WAIT_BLOCKING_SYNC)
         return true;
-    } catch (std::bad_alloc&) {
+
+    // the host function runs once the event completed and wakes up
+    // wait_event(); it owns (and deletes) its reference to the notifier
+    std::shared_ptr<rvs_gemm_notifier>* ref =
+                            new std::shared_ptr<rvs_gemm_notifier>(notifier);
+    if (hipLaunchHostFunc(stream, notify_gemm_event, ref) != hipSuccess) {
+        delete ref;
+        is_error = true;
         return false;
     }
+    return true;
 }
 
 /**
- * @brief releases the host matrix memory
+ * @brief stream host function enqueued after a waited for GEMM event: wakes
+ * up the threads waiting in wait_event()
+ * @param data reference to the notifier (deleted here)
  */
-void rvs_blas::release_host_matrix_mem(void) {
-    if (ha)
-        delete []ha;
-    if (hb)
-        delete []hb;
-    if (hc)
-        delete []hc;
+void rvs_blas::notify_gemm_event(void* data) {
+    std::shared_ptr<rvs_gemm_notifier>* ref =
+                            static_cast<std::shared_ptr<rvs_gemm_notifier>*>(data);
+    {
+        std::lock_guard<std::mutex> lk((*ref)->mtx);
+        (*ref)->num_signals++;
+    }
+    (*ref)->cv.notify_all();
+    delete ref;
+}
 
-    if (hdbla)
-        delete []hdbla;
-    if (hdblb)
-        delete []hdblb;
-    if (hdblc)
-        delete []hdblc;
+/**
+ * @brief waits for the last enqueued GEMM to complete
+ *
+ * Depending on gemm_wait the calling thread either sleeps until the GPU
+ * signals the completion event, or polls the event for GEMM_WAIT_SPIN_US
+ * and then yields the CPU between polls. In neither case is a host core kept
+ * busy for the whole GEMM duration.
+ *
+ * @return true if the GEMM completed, false on error
+ */
+bool rvs_blas::wait_gemm_op_complete(void) {
+    if (is_error)
+        return false;  // avoid blocking the calling thread
 
-    if (hhlfa)
-        delete []hhlfa;
-    if (hhlfb)
-        delete []hhlfb;
-    if (hhlfc)
-        delete []hhlfc;
+    return wait_event(gemm_stop_event);
 }
 
 /**
- * @brief checks whether the matrix multiplication completed
- * @return true if GPU finished with matrix multiplication, otherwise false
+ * @brief waits for an event, as selected by gemm_wait
+ *
+ * A blocking-sync wait sleeps on the notifier, which the host function
+ * enqueued after the event (see record_gemm_event()) and the stop request
+ * both signal. Once RVS is asked to stop (rvs::cancel_token) either wait
+ * returns right away without the result: the GEMMs still in flight complete
+ * on their own and the buffers are released by hipFree(), which
+ * synchronizes.
+ *
+ * @param event event to wait for (recorded by record_gemm_event() with
+ * waited set)
+ * @return true if the event completed, false on error or stop request
  */
-bool rvs_blas::is_gemm_op_complete(void) {
-    if (is_error)
-        return true;  // avoid blocking the calling thread
-    if (hipStreamQuery(hip_stream) != hipSuccess)
+bool rvs_blas::wait_event(hipEvent_t event) {
+    rvs::cancel_token* token = rvs::cancel_token::process();
+
+    if (token->cancelled())
         return false;
-    return true;
+
+    if (gemm_wait == GEMM_WAIT_BLOCKING_SYNC)
+        return wait_event_notified(event);
+
+    std::chrono::time_point<std::chrono::steady_clock> spin_start =
+                                            std::chrono::steady_clock::now();
+    for (;;) {
+        hipError_t status = hipEventQuery(event);
+        if (status == hipSuccess)
+            return true;
+        if (status != hipErrorNotReady) {
+            is_error = true;
+            return false;
+        }
+        if (token->cancelled())
+            return false;
+        if (std::chrono::steady_clock::now() - spin_start >
+                std::chrono::microseconds(GEMM_WAIT_SPIN_US))
+            sched_yield();
+    }
 }
 
 /**
- * @brief performs the SGEMM matrix multiplication
- * @return true if GPU was able to enqueue the GEMM operation, otherwise false
+ * @brief sleeps until an event completes or RVS is asked to stop
+ *
+ * The host functions signal the notifier in stream order, so each wake-up
+ * is followed by one more query of the event; nothing is polled.
+ *
+ * @param event event to wait for (recorded by record_gemm_event() with
+ * waited set)
+ * @return true if the event completed, false on error or stop request
  */
-bool rvs_blas::run_blass_gemm(std::string ops_type) {
-    if (!is_error) {
-      
-        if(ops_type == "sgemm") {
-
-                 float alpha = 1.1, beta = 0.9;
-
-                 if (rocblas_sgemm(blas_handle, transa, transb,
-                         rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                         &alpha, da, rvs_blas::m,
-                         db, rvs_blas::n, &beta,
-                         dc, rvs_blas::m) != rocblas_status_success) {
-                 is_error = true;  // GPU cannot enqueue the gemm
-                 return false;
-                 } else {
-                      return true;
-                 }
+bool rvs_blas::wait_event_notified(hipEvent_t event) {
+    rvs::cancel_token* token = rvs::cancel_token::process();
+    std::shared_ptr<rvs_gemm_notifier> notify = notifier;
+    bool completed = false;
+
+    int waker = token->add_waker([notify] {
+        { std::lock_guard<std::mutex> lk(notify->mtx); }
+        notify->cv.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lk(notify->mtx);
+    while (!token->cancelled()) {
+        uint64_t num_signals = notify->num_signals;
+        lk.unlock();
+        hipError_t status = hipEventQuery(event);
+        lk.lock();
+        if (status == hipSuccess) {
+            completed = true;
+            break;
         }
+        if (status != hipErrorNotReady) {
+            is_error = true;
+            break;
+        }
+        notify->cv.wait(lk, [notify, num_signals, token] {
+            return notify->num_signals != num_signals || token->cancelled();
+        });
+    }
+    lk.unlock();
 
-       if(ops_type == "dgemm") {
-                  double alpha = 1.1, beta = 0.9;
-
-                  if (rocblas_dgemm(blas_handle, transa, transb,
-                          rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                          &alpha, ddbla, rvs_blas::m,
-                          ddblb, rvs_blas::n, &beta,
-                          ddblc, rvs_blas::m) != rocblas_status_success) {
-                  is_error = true;  // GPU cannot enqueue the gemm
-                  return false;
-                  } else {
-                       return true;
-                  }
-       }
-
-      if(ops_type == "hgemm") {
-                  rocblas_half alpha;
-                  rocblas_half beta;
-
-                  alpha.data = 11;
-                  beta.data = 2;
-
-                  if (rocblas_hgemm(blas_handle, transa, transb,
-                          rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                          &alpha, dhlfa, rvs_blas::m,
-                          dhlfb, rvs_blas::n, &beta,
-                          dhlfc, rvs_blas::m) != rocblas_status_success) {
-                  is_error = true;  // GPU cannot enqueue the gemm
-                  return false;
-                  } else {
-                       return true;
-                  }
-       }
+    // the waker takes the notifier lock, which must not be held here
+    token->remove_waker(waker);
+    return completed;
+}
+
+/**
+ * @brief returns the GPU execution time of the last completed GEMM
+ * @return time (in milliseconds) between the GEMM start/stop events or 0
+ * if the events are not available
+ */
+double rvs_blas::get_gemm_op_time_ms(void) {
+    float gemm_ms = 0;
 
+    if (is_error)
+        return 0;
+    if (hipEventElapsedTime(&gemm_ms, gemm_start_event, gemm_stop_event)
+            != hipSuccess)
+        return 0;
+    return static_cast<double>(gemm_ms);
+}
 
+/**
+ * @brief converts GEMM wait mode string (as given in .conf) to gemm_wait_t
+ * @param str wait mode string (blocking-sync, spin-yield)
+ * @param pwait [out] resulting wait mode
+ * @return 0 on success, -1 if the string is not recognized
+ */
+int rvs_blas::str2gemm_wait(const std::string& str, gemm_wait_t* pwait) {
+    if (str == GEMM_WAIT_BLOCKING_SYNC_STR) {
+        *pwait = GEMM_WAIT_BLOCKING_SYNC;
+    } else if (str == GEMM_WAIT_SPIN_YIELD_STR) {
+        *pwait = GEMM_WAIT_SPIN_YIELD;
     } else {
-        return false;
+        return -1;
     }
+    return 0;
 }
 
 /**
- * @brief generate matrix random data
- * it should be called before rocBlas GEMM
+ * @brief converts gemm_wait_t to the string used in .conf files
+ * @param wait GEMM wait mode
+ * @return wait mode string
  */
-void rvs_blas::generate_random_matrix_data(void) {
-    int i;
-    if (!is_error) {
-        uint64_t nextr = time(NULL);
-
-        //SGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            ha[i] = fast_pseudo_rand(&nextr);
-
-        for (i = 0; i < size_b; ++i)
-            hb[i] = fast_pseudo_rand(&nextr);
+std::string rvs_blas::gemm_wait2str(gemm_wait_t wait) {
+    if (wait == GEMM_WAIT_SPIN_YIELD)
+        return GEMM_WAIT_SPIN_YIELD_STR;
+    return GEMM_WAIT_BLOCKING_SYNC_STR;
+}
 
-        for (int i = 0; i < size_c; ++i)
-            hc[i] = fast_pseudo_rand(&nextr);
+/**
+ * @brief generates random data (uniform in [-1, 1)) for the matrices of the
+ * selected GEMM type; it should be called before rocBlas GEMM
+ *
+ * The data is produced by a counter based generator, in parallel, and only
+ * depends on the seed: the same seed gives the same matrices.
+ *
+ * @param _seed seed of the random data
+ */
+void rvs_blas::generate_random_matrix_data(uint64_t _seed) {
+    seed = _seed;
+    if (is_error)
+        return;
 
-        //DGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            hdbla[i] = (double)fast_pseudo_rand(&nextr);
+    // each matrix gets its own sequence derived from the run seed
+    engine->fill_random(rvs::rand::counter_hash(seed, 0),
+                        rvs::rand::counter_hash(seed, 1),
+                        rvs::rand::counter_hash(seed, 2));
+}
 
-        for (i = 0; i < size_b; ++i)
-            hdblb[i] = (double)fast_pseudo_rand(&nextr);
+/**
+ * @brief sets up the sampled result verification
+ * @param _num_tiles number of C tiles checked by each verification
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::init_verify(int _num_tiles) {
+    if (is_error || is_verify_init || _num_tiles < 1)
+        return false;
 
-        for (int i = 0; i < size_c; ++i)
-            hdblc[i] = (double)fast_pseudo_rand(&nextr);
+    verify_num_tiles = _num_tiles;
+    int tile = std::min<int>(RVS_BLAS_VERIFY_TILE, std::min(m, n));
+    if (!engine->allocate_verify(tile, verify_num_tiles))
+        return false;
+    if (hipEventCreateWithFlags(&verify_event, hipEventBlockingSync)
+            != hipSuccess)
+        return false;
 
-        //DGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            hhlfa[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+    verify_tiles.resize(verify_num_tiles);
+    is_verify_init = true;
+    return true;
+}
 
-        for (i = 0; i < size_b; ++i)
-            hhlfb[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+/**
+ * @brief starts a sampled verification of the GEMM results
+ *
+ * Enqueues a beta = 0 GEMM on a random batch entry, copies verify_num_tiles
+ * random C tiles of it to pinned host memory and hands the comparison with
+ * the host reference to a separate thread, so the calling thread can keep
+ * submitting stress GEMMs meanwhile. The tile positions only depend on the
+ * matrix seed and the verification index, so a failing check can be
+ * reproduced from the logged seed.
+ *
+ * @return true if the verification was started, false on error or if the
+ * previous one was not collected by finish_verify()
+ */
+bool rvs_blas::start_verify(void) {
+    if (is_error || !is_verify_init || verify_result.valid())
+        return false;
 
-        for (int i = 0; i < size_c; ++i)
-            hhlfc[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+    // sequences 0..2 of the seed are used by the matrix data
+    uint64_t vseed = rvs::rand::counter_hash(seed, 3 + num_verify);
+    int tile = std::min<int>(RVS_BLAS_VERIFY_TILE, std::min(m, n));
+
+    verify_batch = static_cast<int>(rvs::rand::counter_hash(vseed, 0) %
+                                    batch_count);
+    for (int i = 0; i < verify_num_tiles; i++) {
+        verify_tiles[i].row = static_cast<rocblas_int>(
+            rvs::rand::counter_hash(vseed, 2 * i + 1) % (m - tile + 1));
+        verify_tiles[i].col = static_cast<rocblas_int>(
+            rvs::rand::counter_hash(vseed, 2 * i + 2) % (n - tile + 1));
+    }
 
+    if (!select_stream(hip_stream))
+        return false;
+    // every device copy holds the same matrices, the verification reads the
+    // one of the last GEMM
+    if (!acquire_gemm_buf(hip_stream))
+        return false;
+    if (!engine->run_verify_gemm(blas_handle, m, n, k, verify_batch,
+                                 gemm_buf)) {
+        is_error = true;
+        return false;
+    }
+    if (!release_gemm_buf(hip_stream))
+        return false;
+    for (int i = 0; i < verify_num_tiles; i++) {
+        if (!engine->copy_verify_tile(i, verify_tiles[i], m, hip_stream)) {
+            is_error = true;
+            return false;
+        }
     }
+    if (!record_gemm_event(verify_event, hip_stream))
+        return false;
+
+    num_verify++;
+    verify_result = std::async(std::launch::async,
+                               &rvs_blas::check_verify, this);
+    return true;
 }
 
+/**
+ * @brief host side of the verification (runs on its own thread): waits for
+ * the sampled tiles and compares them with the host reference
+ * @return true if everything went fine, false on HIP error
+ */
+bool rvs_blas::check_verify(void) {
+    // is_error belongs to the submitting thread, it is not touched here
+    if (hipEventSynchronize(verify_event) != hipSuccess)
+        return false;
 
+    engine->check_verify_tiles(m, n, k, verify_batch, verify_tiles,
+                               &verify_mismatches);
+    return true;
+}
 
 /**
- * @brief fast pseudo random generator 
- * @return floating point random number
+ * @brief checks whether the host is still comparing the sampled tiles
+ * @return true if a started verification was not finished yet
  */
-float rvs_blas::fast_pseudo_rand(u_long *nextr) {
-    *nextr = *nextr * 1103515245 + 12345;
-    return static_cast<float>(static_cast<uint32_t>
-                    ((*nextr / 65536) % RANDOM_CT)) / RANDOM_DIV_CT;
+bool rvs_blas::is_verify_running(void) {
+    return verify_result.valid() &&
+           verify_result.wait_for(std::chrono::seconds(0)) !=
+                std::future_status::ready;
 }
 
+/**
+ * @brief collects the result of the last started verification (waits for it
+ * if it is still running)
+ * @param mismatches [out] out of tolerance elements (empty if no
+ * verification was pending)
+ * @return true if everything went fine, false on HIP error
+ */
+bool rvs_blas::finish_verify(std::vector<rvs_gemm_mismatch>* mismatches) {
+    mismatches->clear();
+    if (!verify_result.valid())
+        return true;
+
+    if (!verify_result.get()) {
+        is_error = true;
+        return false;
+    }
+    mismatches->swap(verify_mismatches);
+    return true;
+}
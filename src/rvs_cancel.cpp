@@ -0,0 +1,136 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_cancel.h"
+
+#include <chrono>
+
+rvs::cancel_token* rvs::cancel_token::current = nullptr;
+
+/**
+ * @brief class constructor
+ */
+rvs::cancel_token::cancel_token() : flag(false), cancel_ns(0) {
+  next_id = 1;
+}
+
+/**
+ * @brief requests a stop: sets the flag and wakes all the waiters
+ *
+ * Only the first call after a reset() records the cancel time and runs the
+ * wakers.
+ */
+void rvs::cancel_token::cancel(void) {
+  std::lock_guard<std::mutex> lk(mtx);
+  if (flag.load())
+    return;
+  cancel_ns = now_ns();
+  flag.store(true, std::memory_order_release);
+  cv.notify_all();
+  // wakers run under mtx so that remove_waker() does not return while its
+  // waker is still running
+  for (auto it = wakers.begin(); it != wakers.end(); it++)
+    it->second();
+}
+
+/**
+ * @brief clears a stop request
+ */
+void rvs::cancel_token::reset(void) {
+  std::lock_guard<std::mutex> lk(mtx);
+  flag = false;
+  cancel_ns = 0;
+}
+
+/**
+ * @brief sleeps until the given time has elapsed or cancel() is called
+ * @param ns time to sleep (ns)
+ * @return true if cancelled
+ */
+bool rvs::cancel_token::wait_for(uint64_t ns) {
+  std::unique_lock<std::mutex> lk(mtx);
+  cv.wait_for(lk, std::chrono::nanoseconds(ns),
+              [this] { return flag.load(); });
+  return flag.load();
+}
+
+/**
+ * @brief returns the time elapsed since cancel() was called
+ * @return time (ns, 0 if not cancelled)
+ */
+uint64_t rvs::cancel_token::get_latency_ns(void) const {
+  uint64_t t = cancel_ns.load();
+  return t ? now_ns() - t : 0;
+}
+
+/**
+ * @brief registers a callback to run (once) when cancel() is called
+ *
+ * The waker runs on the thread calling cancel() and must not block nor
+ * call back into the token.
+ *
+ * @param cb callback
+ * @return waker id, to be passed to remove_waker()
+ */
+int rvs::cancel_token::add_waker(const waker_t& cb) {
+  std::lock_guard<std::mutex> lk(mtx);
+  int id = next_id++;
+  wakers[id] = cb;
+  return id;
+}
+
+/**
+ * @brief unregisters a waker; it is not running when this returns
+ * @param id waker id
+ */
+void rvs::cancel_token::remove_waker(int id) {
+  std::lock_guard<std::mutex> lk(mtx);
+  wakers.erase(id);
+}
+
+/**
+ * @brief returns the token of the process
+ * @return token
+ */
+rvs::cancel_token* rvs::cancel_token::process(void) {
+  static cancel_token token;
+  return current ? current : &token;
+}
+
+/**
+ * @brief sets the token process() returns (in a module: the launcher token)
+ * @param token token (nullptr for the one of this copy of rvslib)
+ */
+void rvs::cancel_token::set_process(cancel_token* token) {
+  current = token;
+}
+
+/**
+ * @brief returns the steady clock time
+ * @return time (ns)
+ */
+uint64_t rvs::cancel_token::now_ns(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
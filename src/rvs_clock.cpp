@@ -0,0 +1,119 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_clock.h"
+
+#include <errno.h>
+#include <time.h>
+
+/**
+ * @brief returns the process wide real time clock
+ * @return pointer to a mono_clock
+ */
+rvs::clock* rvs::clock::real(void) {
+  static mono_clock real_clock;
+  return &real_clock;
+}
+
+/**
+ * @brief sleeps until the given time, or less if the condition variable is
+ * notified meanwhile
+ *
+ * The default gives up the lock and sleeps through sleep_until_ns(): on a
+ * simulated clock nothing happens while waiting, so the notifications are
+ * of no use there.
+ *
+ * @param cv condition variable the caller waits for
+ * @param lk lock of the mutex guarding the condition (held by the caller)
+ * @param deadline_ns absolute wake-up time (ns)
+ */
+void rvs::clock::wait_until_ns(std::condition_variable* cv,
+                               std::unique_lock<std::mutex>* lk,
+                               uint64_t deadline_ns) {
+  (void)cv;
+  lk->unlock();
+  sleep_until_ns(deadline_ns);
+  lk->lock();
+}
+
+/**
+ * @brief returns the current CLOCK_MONOTONIC time
+ * @return time in ns
+ */
+uint64_t rvs::mono_clock::now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief sleeps until the given CLOCK_MONOTONIC time (restarts if
+ * interrupted by a signal)
+ * @param deadline_ns absolute wake-up time (ns)
+ */
+void rvs::mono_clock::sleep_until_ns(uint64_t deadline_ns) {
+  struct timespec ts;
+  ts.tv_sec = deadline_ns / 1000000000ULL;
+  ts.tv_nsec = deadline_ns % 1000000000ULL;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+         EINTR) {
+  }
+}
+
+/**
+ * @brief polls CLOCK_MONOTONIC until the given time (no scheduler wake-up
+ * latency, but keeps the core busy)
+ * @param deadline_ns absolute time (ns)
+ */
+void rvs::mono_clock::spin_until_ns(uint64_t deadline_ns) {
+  while (now_ns() < deadline_ns) {
+  }
+}
+
+/**
+ * @brief waits on the condition variable until the given CLOCK_MONOTONIC
+ * time or until it is notified
+ * @param cv condition variable the caller waits for
+ * @param lk lock of the mutex guarding the condition (held by the caller)
+ * @param deadline_ns absolute wake-up time (ns)
+ */
+void rvs::mono_clock::wait_until_ns(std::condition_variable* cv,
+                                    std::unique_lock<std::mutex>* lk,
+                                    uint64_t deadline_ns) {
+  uint64_t now = now_ns();
+  if (now < deadline_ns)
+    cv->wait_for(*lk, std::chrono::nanoseconds(deadline_ns - now));
+}
+
+/**
+ * @brief moves the time forward to the deadline (no-op if it is already
+ * past)
+ * @param deadline_ns absolute wake-up time (ns)
+ */
+void rvs::virtual_clock::sleep_until_ns(uint64_t deadline_ns) {
+  uint64_t now = time_ns.load();
+  while (now < deadline_ns &&
+         !time_ns.compare_exchange_weak(now, deadline_ns)) {
+  }
+}
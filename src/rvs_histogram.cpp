@@ -0,0 +1,149 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_histogram.h"
+
+#include <stddef.h>
+
+//! log2 of the number of linear buckets per power of two
+#define RVS_HISTOGRAM_SUB_BITS          5
+//! number of linear buckets per power of two
+#define RVS_HISTOGRAM_SUB_BUCKETS       (1 << RVS_HISTOGRAM_SUB_BITS)
+//! number of buckets covering the whole uint64_t range
+#define RVS_HISTOGRAM_NUM_BUCKETS       \
+  ((64 - RVS_HISTOGRAM_SUB_BITS + 1) * RVS_HISTOGRAM_SUB_BUCKETS)
+
+/**
+ * @brief class constructor
+ */
+rvs::histogram::histogram() : buckets(RVS_HISTOGRAM_NUM_BUCKETS, 0) {
+  num_samples = 0;
+  min_value = UINT64_MAX;
+  max_value = 0;
+}
+
+/**
+ * @brief returns the bucket of a value
+ *
+ * Values below 2 * RVS_HISTOGRAM_SUB_BUCKETS have a bucket each; above, the
+ * bucket is given by the position of the highest set bit and the next
+ * RVS_HISTOGRAM_SUB_BITS bits.
+ *
+ * @param value sample
+ * @return bucket index
+ */
+int rvs::histogram::bucket(uint64_t value) {
+  if (value < 2 * RVS_HISTOGRAM_SUB_BUCKETS)
+    return static_cast<int>(value);
+
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - RVS_HISTOGRAM_SUB_BITS;
+  int sub = static_cast<int>(value >> shift) - RVS_HISTOGRAM_SUB_BUCKETS;
+  return (shift + 1) * RVS_HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+/**
+ * @brief returns the smallest value of a bucket
+ * @param idx bucket index
+ * @return lower bound (inclusive)
+ */
+uint64_t rvs::histogram::bucket_low(int idx) {
+  if (idx < 2 * RVS_HISTOGRAM_SUB_BUCKETS)
+    return static_cast<uint64_t>(idx);
+
+  int shift = idx / RVS_HISTOGRAM_SUB_BUCKETS - 1;
+  uint64_t mantissa = idx % RVS_HISTOGRAM_SUB_BUCKETS +
+                      RVS_HISTOGRAM_SUB_BUCKETS;
+  return mantissa << shift;
+}
+
+/**
+ * @brief returns the largest value of a bucket
+ * @param idx bucket index
+ * @return upper bound (inclusive)
+ */
+uint64_t rvs::histogram::bucket_high(int idx) {
+  if (idx < 2 * RVS_HISTOGRAM_SUB_BUCKETS)
+    return static_cast<uint64_t>(idx);
+
+  int shift = idx / RVS_HISTOGRAM_SUB_BUCKETS - 1;
+  return bucket_low(idx) + ((1ULL << shift) - 1);
+}
+
+/**
+ * @brief adds a sample
+ * @param value sample
+ */
+void rvs::histogram::add(uint64_t value) {
+  buckets[bucket(value)]++;
+  num_samples++;
+  if (value < min_value)
+    min_value = value;
+  if (value > max_value)
+    max_value = value;
+}
+
+/**
+ * @brief drops all the samples
+ */
+void rvs::histogram::reset(void) {
+  buckets.assign(buckets.size(), 0);
+  num_samples = 0;
+  min_value = UINT64_MAX;
+  max_value = 0;
+}
+
+/**
+ * @brief returns a percentile of the samples
+ * @param p percentile (0..100)
+ * @return middle of the bucket holding the percentile, clamped to the
+ * smallest and largest samples (0 if empty)
+ */
+uint64_t rvs::histogram::percentile(double p) const {
+  if (num_samples == 0)
+    return 0;
+
+  // rank of the sample, 1..num_samples
+  uint64_t rank = static_cast<uint64_t>(p / 100 * num_samples + 0.5);
+  if (rank < 1)
+    rank = 1;
+  if (rank > num_samples)
+    rank = num_samples;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      int idx = static_cast<int>(i);
+      uint64_t low = bucket_low(idx);
+      uint64_t value = low + (bucket_high(idx) - low) / 2;
+      if (value < min_value)
+        value = min_value;
+      if (value > max_value)
+        value = max_value;
+      return value;
+    }
+  }
+  return max_value;
+}
@@ -0,0 +1,132 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_pacer.h"
+
+#include <algorithm>
+
+/**
+ * @brief class constructor
+ * @param _kp proportional gain
+ * @param _ki integral gain (1/s)
+ * @param _kd derivative gain (s)
+ * @param _out_min lowest output
+ * @param _out_max highest output
+ */
+rvs::pid::pid(double _kp, double _ki, double _kd, double _out_min,
+              double _out_max) : kp(_kp), ki(_ki), kd(_kd),
+                                 out_min(_out_min), out_max(_out_max) {
+  reset(0);
+}
+
+/**
+ * @brief changes the output limits
+ * @param _out_min lowest output
+ * @param _out_max highest output
+ */
+void rvs::pid::set_limits(double _out_min, double _out_max) {
+  out_min = _out_min;
+  out_max = _out_max;
+  integral = std::min(std::max(integral, out_min), out_max);
+}
+
+/**
+ * @brief resets the controller so that it starts from the given output
+ * (bumpless start: the integral term is preset to the output)
+ * @param _output initial output
+ */
+void rvs::pid::reset(double _output) {
+  out = std::min(std::max(_output, out_min), out_max);
+  integral = out;
+  prev_error = 0;
+  has_prev = false;
+}
+
+/**
+ * @brief computes the new controller output
+ * @param error setpoint - measurement
+ * @param dt time (in seconds) since the previous update
+ * @return new output, within [out_min, out_max]
+ */
+double rvs::pid::update(double error, double dt) {
+  double derivative = 0;
+  if (has_prev && dt > 0)
+    derivative = (error - prev_error) / dt;
+  prev_error = error;
+  has_prev = true;
+
+  double candidate = integral + ki * error * dt;
+  double raw = kp * error + candidate + kd * derivative;
+
+  // integrate only if that does not push a saturated output further out
+  if (!((raw > out_max && error > 0) || (raw < out_min && error < 0)))
+    integral = std::min(std::max(candidate, out_min), out_max);
+
+  out = std::min(std::max(kp * error + integral + kd * derivative, out_min),
+                 out_max);
+  return out;
+}
+
+/**
+ * @brief class constructor
+ * @param _clk time source (the real clock by default)
+ */
+rvs::pacer::pacer(clock* _clk) : clk(_clk) {
+  deadline = clk->now_ns();
+  late_count = 0;
+  spin_ns = 0;
+}
+
+/**
+ * @brief restarts the schedule: the next deadline is one period from now
+ */
+void rvs::pacer::start(void) {
+  deadline = clk->now_ns();
+  late_count = 0;
+}
+
+/**
+ * @brief sleeps until the next deadline (previous deadline + period)
+ * @param period_ms period (in ms)
+ */
+void rvs::pacer::wait_next(double period_ms) {
+  uint64_t period = period_ms > 0 ? static_cast<uint64_t>(period_ms * 1e6) : 0;
+  uint64_t now = clk->now_ns();
+
+  deadline += period;
+  if (deadline <= now) {
+    late_count++;
+    // more than one period behind: restart the schedule from now
+    if (now - deadline > period)
+      deadline = now;
+    return;
+  }
+  if (spin_ns == 0) {
+    clk->sleep_until_ns(deadline);
+    return;
+  }
+  if (deadline - now > spin_ns)
+    clk->sleep_until_ns(deadline - spin_ns);
+  clk->spin_until_ns(deadline);
+}
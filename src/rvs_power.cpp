@@ -0,0 +1,46 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_power.h"
+
+#include "rocm_smi/rocm_smi.h"
+
+/**
+ * @brief returns the process wide ROCm SMI power reader
+ * @return pointer to a rsmi_power_reader
+ */
+rvs::power_reader* rvs::power_reader::rsmi(void) {
+  static rsmi_power_reader rsmi_reader;
+  return &rsmi_reader;
+}
+
+/**
+ * @brief reads the average power of a device
+ * @param dev_ix ROCm SMI device index
+ * @param power receives the power (in microwatts)
+ * @return true if the reading succeeded
+ */
+bool rvs::rsmi_power_reader::read_power_uw(uint32_t dev_ix, uint64_t *power) {
+  return rsmi_dev_power_ave_get(dev_ix, 0, power) == RSMI_STATUS_SUCCESS;
+}
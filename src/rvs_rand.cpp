@@ -0,0 +1,135 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_rand.h"
+
+#include <string.h>
+
+#include <chrono>
+#include <random>
+
+/**
+ * @brief converts a float to IEEE 754 half precision bits (round to
+ * nearest even)
+ * @param value float value
+ * @return half precision bits
+ */
+uint16_t rvs::rand::float_to_half(float value) {
+  uint32_t x;
+  memcpy(&x, &value, sizeof(x));
+
+  uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000);
+  uint32_t absx = x & 0x7FFFFFFF;
+
+  if (absx >= 0x7F800000) {
+    // Inf/NaN
+    return sign | 0x7C00 | (absx > 0x7F800000 ? 0x200 : 0);
+  }
+  if (absx >= 0x477FF000) {
+    // too large, rounds to Inf
+    return sign | 0x7C00;
+  }
+  if (absx < 0x38800000) {
+    // subnormal half (or zero)
+    if (absx < 0x33000000)
+      return sign;
+    uint32_t shift = 113 - (absx >> 23);
+    uint32_t mant = (absx & 0x7FFFFF) | 0x800000;
+    uint32_t half = mant >> (shift + 13);
+    uint32_t rem = mant & ((1u << (shift + 13)) - 1);
+    uint32_t mid = 1u << (shift + 12);
+    if (rem > mid || (rem == mid && (half & 1)))
+      half++;
+    return sign | static_cast<uint16_t>(half);
+  }
+
+  // normal half: rebias the exponent, round the mantissa to 10 bits
+  uint32_t half = (absx - 0x38000000) >> 13;
+  uint32_t rem = absx & 0x1FFF;
+  if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+    half++;
+  return sign | static_cast<uint16_t>(half);
+}
+
+/**
+ * @brief converts half precision bits to float (exact)
+ * @param value half precision bits
+ * @return float value
+ */
+float rvs::rand::half_to_float(uint16_t value) {
+  uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+  uint32_t exp = (value >> 10) & 0x1F;
+  uint32_t mant = value & 0x3FF;
+  uint32_t x;
+
+  if (exp == 0x1F) {
+    // Inf/NaN
+    x = sign | 0x7F800000 | (mant << 13);
+  } else if (exp) {
+    x = sign | ((exp + 112) << 23) | (mant << 13);
+  } else if (mant) {
+    // subnormal half: normalize the mantissa
+    exp = 113;
+    while (!(mant & 0x400)) {
+      mant <<= 1;
+      exp--;
+    }
+    x = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+  } else {
+    x = sign;
+  }
+
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+/**
+ * @brief converts a float to bfloat16 bits (round to nearest even)
+ * @param value float value
+ * @return bfloat16 bits
+ */
+uint16_t rvs::rand::float_to_bfloat16(float value) {
+  uint32_t x;
+  memcpy(&x, &value, sizeof(x));
+
+  if ((x & 0x7FFFFFFF) > 0x7F800000) {
+    // NaN: keep it quiet, truncation could turn it into Inf
+    return static_cast<uint16_t>((x >> 16) | 0x40);
+  }
+  x += 0x7FFF + ((x >> 16) & 1);
+  return static_cast<uint16_t>(x >> 16);
+}
+
+/**
+ * @brief makes a fresh seed for a run
+ * @return seed mixed from std::random_device and the current time
+ */
+uint64_t rvs::rand::new_seed(void) {
+  std::random_device rd;
+  uint64_t seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+  seed ^= static_cast<uint64_t>(
+    std::chrono::high_resolution_clock::now().time_since_epoch().count());
+  return counter_hash(seed, 0);
+}
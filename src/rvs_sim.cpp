@@ -0,0 +1,278 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_sim.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "include/rvs_rand.h"
+
+/**
+ * @brief class constructor
+ * @param _model performance/power model
+ * @param _clk clock the device runs on
+ */
+rvs::sim_device::sim_device(const sim_model& _model, clock* _clk) :
+  model(_model), clk(_clk) {
+  busy_until = 0;
+  power_ns = clk->now_ns();
+  power = model.idle_power;
+  num_gemms = 0;
+}
+
+/**
+ * @brief queues a GEMM on the device
+ * @param gflop amount of work (Gflop)
+ * @param start_ns [out] time the GEMM starts (after the queued GEMMs)
+ * @param end_ns [out] time the GEMM completes
+ */
+void rvs::sim_device::submit(double gflop, uint64_t *start_ns,
+                             uint64_t *end_ns) {
+  std::lock_guard<std::mutex> lk(mtx);
+
+  uint64_t start = std::max(clk->now_ns(), busy_until);
+  double dur = model.launch_us * 1e3;
+  if (model.peak_gflops > 0)
+    dur += gflop / model.peak_gflops * 1e9;
+  if (model.jitter > 0) {
+    // uniform in [-1, 1), reproducible from the seed
+    double u = static_cast<double>(
+      rvs::rand::counter_hash(model.seed, num_gemms) >> 11) / 9007199254740992.0;
+    dur *= 1 + model.jitter * (2 * u - 1);
+  }
+  num_gemms++;
+
+  busy_until = start + static_cast<uint64_t>(std::max(dur, 0.0));
+  busy.push_back(std::make_pair(start, busy_until));
+  *start_ns = start;
+  *end_ns = busy_until;
+}
+
+/**
+ * @brief moves the power model forward to the given time
+ *
+ * The target power over [power_ns, now] follows the fraction of it the
+ * device was busy; the filtered power approaches it with time constant
+ * power_tau_ms.
+ *
+ * @param now current time
+ */
+void rvs::sim_device::update_power(uint64_t now) {
+  if (now <= power_ns)
+    return;
+
+  uint64_t busy_ns = 0;
+  for (auto it = busy.begin(); it != busy.end(); ++it) {
+    uint64_t b = std::max(it->first, power_ns);
+    uint64_t e = std::min(it->second, now);
+    if (e > b)
+      busy_ns += e - b;
+  }
+  while (!busy.empty() && busy.front().second <= now)
+    busy.pop_front();
+
+  double dt = static_cast<double>(now - power_ns);
+  double target = model.idle_power + (model.max_power - model.idle_power) *
+                  static_cast<double>(busy_ns) / dt;
+  double a = 1.0;
+  if (model.power_tau_ms > 0)
+    a = 1.0 - exp(-dt / (model.power_tau_ms * 1e6));
+  power += (target - power) * a;
+  power_ns = now;
+}
+
+/**
+ * @brief returns the current power of the device
+ * @return power (W)
+ */
+double rvs::sim_device::get_power(void) {
+  std::lock_guard<std::mutex> lk(mtx);
+  update_power(clk->now_ns());
+  return power;
+}
+
+/**
+ * @brief power_reader interface (the device index is ignored)
+ * @param dev_ix device index
+ * @param power receives the power (in microwatts)
+ * @return always true
+ */
+bool rvs::sim_device::read_power_uw(uint32_t dev_ix, uint64_t *power) {
+  (void)dev_ix;
+  *power = static_cast<uint64_t>(get_power() * 1e6);
+  return true;
+}
+
+/**
+ * @brief class constructor
+ * @param _dev simulated device the GEMMs run on
+ * @param _m matrix size
+ * @param _n matrix size
+ * @param _k matrix size
+ * @param _ops_type GEMM type
+ * @param _batch_count number of GEMMs per launch
+ * @param _num_streams number of streams used by enqueue_gemm()
+ * @param _num_inflight max number of launches enqueue_gemm() keeps in flight
+ */
+rvs_blas_sim::rvs_blas_sim(rvs::sim_device* _dev, int _m, int _n, int _k,
+                           const std::string& _ops_type, int _batch_count,
+                           int _num_streams, int _num_inflight) :
+    rvs_blas(_m, _n, _k, _ops_type, _batch_count, _num_streams,
+             _num_inflight),
+    dev(_dev) {
+    gemm_start_ns = gemm_end_ns = 0;
+    timeline_ns = 0;
+    sim_verify_init = false;
+    if (dev == nullptr || !is_ops_type_valid(ops_type))
+        is_error = true;
+}
+
+/**
+ * @brief queues one GEMM launch on the simulated device
+ * @return true if the GEMM was queued, otherwise false
+ */
+bool rvs_blas_sim::run_blass_gemm(void) {
+    if (is_error)
+        return false;
+    dev->submit(gemm_gflop_count(), &gemm_start_ns, &gemm_end_ns);
+    return true;
+}
+
+/**
+ * @brief checks whether the last GEMM completed
+ * @return true if the simulated time passed its completion
+ */
+bool rvs_blas_sim::is_gemm_op_complete(void) {
+    if (is_error)
+        return true;
+    return dev->get_clock()->now_ns() >= gemm_end_ns;
+}
+
+/**
+ * @brief sleeps (on the device clock) until the last GEMM completes
+ * @return true if the GEMM completed, false on error
+ */
+bool rvs_blas_sim::wait_gemm_op_complete(void) {
+    if (is_error)
+        return false;
+    dev->get_clock()->sleep_until_ns(gemm_end_ns);
+    return true;
+}
+
+/**
+ * @brief returns the execution time of the last GEMM
+ * @return time (in milliseconds) from its start to its completion
+ */
+double rvs_blas_sim::get_gemm_op_time_ms(void) {
+    if (is_error)
+        return 0;
+    return static_cast<double>(gemm_end_ns - gemm_start_ns) / 1e6;
+}
+
+/**
+ * @brief starts the completion timeline of the pipelined submission
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas_sim::start_gemm_timeline(void) {
+    if (is_error || get_gemms_in_flight() != 0)
+        return false;
+
+    num_submitted = num_completed = 0;
+    last_completion_ms = 0;
+    inflight_end_ns.clear();
+    timeline_ns = dev->get_clock()->now_ns();
+    return true;
+}
+
+/**
+ * @brief queues the next GEMM launch of the pipelined submission
+ * @return true if the GEMM was queued, false on error or if num_inflight
+ * launches are already in flight
+ */
+bool rvs_blas_sim::enqueue_gemm(void) {
+    uint64_t start_ns, end_ns;
+
+    if (is_error || get_gemms_in_flight() >= num_inflight)
+        return false;
+
+    dev->submit(gemm_gflop_count(), &start_ns, &end_ns);
+    inflight_end_ns.push_back(end_ns);
+    num_submitted++;
+    return true;
+}
+
+/**
+ * @brief waits for the oldest in-flight GEMM launch and records its
+ * completion time (see get_last_completion_ms())
+ * @return true if the GEMM completed, false on error or if nothing is in
+ * flight
+ */
+bool rvs_blas_sim::wait_oldest_gemm(void) {
+    if (is_error || inflight_end_ns.empty())
+        return false;
+
+    uint64_t end_ns = inflight_end_ns.front();
+    inflight_end_ns.pop_front();
+    dev->get_clock()->sleep_until_ns(end_ns);
+
+    last_completion_ms = static_cast<double>(end_ns - timeline_ns) / 1e6;
+    num_completed++;
+    return true;
+}
+
+/**
+ * @param _num_tiles number of C tiles checked by each verification
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas_sim::init_verify(int _num_tiles) {
+    if (is_error || sim_verify_init || _num_tiles < 1)
+        return false;
+
+    verify_num_tiles = _num_tiles;
+    sim_verify_init = true;
+    return true;
+}
+
+/**
+ * @brief counts a verification (the simulated results are always correct)
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas_sim::start_verify(void) {
+    if (is_error || !sim_verify_init)
+        return false;
+    num_verify++;
+    return true;
+}
+
+/**
+ * @brief collects the result of the last started verification
+ * @param mismatches [out] always empty
+ * @return true
+ */
+bool rvs_blas_sim::finish_verify(std::vector<rvs_gemm_mismatch>* mismatches) {
+    mismatches->clear();
+    return true;
+}
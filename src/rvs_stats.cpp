@@ -0,0 +1,344 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_stats.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <utility>
+
+//! number of samples after which moving_average recomputes its sum
+#define RVS_MOVING_AVERAGE_RESUM        65536
+//! initial diagonal of the linear_rls inverse correlation matrix (a large
+//! value: the first samples set the fit, not the zero initial guess)
+#define RVS_RLS_INITIAL_P               1e6
+//! number of samples (times the compression) tdigest buffers before merging
+#define RVS_TDIGEST_BUFFER              5
+
+/**
+ * @brief class constructor
+ * @param _window_ns window length (ns)
+ */
+rvs::moving_average::moving_average(uint64_t _window_ns)
+    : window_ns(_window_ns) {
+  reset();
+}
+
+/**
+ * @brief drops all the samples
+ */
+void rvs::moving_average::reset(void) {
+  samples.clear();
+  sum = 0;
+  since_resum = 0;
+}
+
+/**
+ * @brief adds a sample and drops those that left the window
+ * @param t_ns time of the sample (ns, not decreasing from one call to the next)
+ * @param value sample value
+ */
+void rvs::moving_average::add(uint64_t t_ns, double value) {
+  samples.push_back(std::make_pair(t_ns, value));
+  sum += value;
+
+  while (t_ns - samples.front().first >= window_ns && samples.size() > 1) {
+    sum -= samples.front().second;
+    samples.pop_front();
+  }
+
+  if (++since_resum >= RVS_MOVING_AVERAGE_RESUM) {
+    sum = 0;
+    for (size_t i = 0; i < samples.size(); i++)
+      sum += samples[i].second;
+    since_resum = 0;
+  }
+}
+
+/**
+ * @brief class constructor
+ * @param _forgetting forgetting factor (0 < _forgetting <= 1)
+ */
+rvs::linear_rls::linear_rls(double _forgetting)
+    : forgetting(_forgetting) {
+  reset();
+}
+
+/**
+ * @brief drops the fit
+ */
+void rvs::linear_rls::reset(void) {
+  offset = 0;
+  slope = 0;
+  p00 = RVS_RLS_INITIAL_P;
+  p01 = 0;
+  p11 = RVS_RLS_INITIAL_P;
+  num_samples = 0;
+}
+
+/**
+ * @brief updates the fit with a sample
+ * @param x sample input
+ * @param y sample output
+ */
+void rvs::linear_rls::add(double x, double y) {
+  // gain k = P [1 x]' / (forgetting + [1 x] P [1 x]')
+  double px0 = p00 + p01 * x;
+  double px1 = p01 + p11 * x;
+  double den = forgetting + px0 + px1 * x;
+  double k0 = px0 / den;
+  double k1 = px1 / den;
+
+  double err = y - predict(x);
+  offset += k0 * err;
+  slope += k1 * err;
+
+  // P = (P - k [1 x] P) / forgetting
+  p00 = (p00 - k0 * px0) / forgetting;
+  p01 = (p01 - k0 * px1) / forgetting;
+  p11 = (p11 - k1 * px1) / forgetting;
+
+  num_samples++;
+}
+
+/**
+ * @brief finds the x for which the fit predicts the given y
+ * @param y wanted output
+ * @param x stores the input
+ * @return false if the fit is flat (or not made yet), true otherwise
+ */
+bool rvs::linear_rls::solve(double y, double *x) const {
+  if (num_samples < 2 || slope == 0)
+    return false;
+
+  *x = (y - offset) / slope;
+  return true;
+}
+
+/**
+ * @brief adds a sample
+ * @param x sample value
+ */
+void rvs::running_stats::add(double x) {
+  if (n == 0) {
+    lo = hi = x;
+  } else {
+    lo = std::min(lo, x);
+    hi = std::max(hi, x);
+  }
+  n++;
+  double d = x - avg;
+  avg += d / n;
+  m2 += d * (x - avg);
+}
+
+/**
+ * @brief adds the samples summarized by another instance
+ * @param other statistics to merge
+ */
+void rvs::running_stats::merge(const running_stats& other) {
+  if (other.n == 0)
+    return;
+  if (n == 0) {
+    *this = other;
+    return;
+  }
+  uint64_t total = n + other.n;
+  double d = other.avg - avg;
+  avg += d * other.n / total;
+  m2 += other.m2 + d * d * n * other.n / total;
+  n = total;
+  lo = std::min(lo, other.lo);
+  hi = std::max(hi, other.hi);
+}
+
+/**
+ * @brief drops all the samples
+ */
+void rvs::running_stats::reset(void) {
+  n = 0;
+  avg = 0;
+  m2 = 0;
+  lo = 0;
+  hi = 0;
+}
+
+/**
+ * @brief returns the sample standard deviation
+ * @return standard deviation (0 if fewer than 2 samples)
+ */
+double rvs::running_stats::stddev(void) const {
+  return sqrt(variance());
+}
+
+/**
+ * @brief adds a sample
+ * @param x sample value
+ */
+void rvs::ewma::add(double x) {
+  if (!has_value) {
+    avg = x;
+    has_value = true;
+    return;
+  }
+  avg += alpha * (x - avg);
+}
+
+/**
+ * @brief class constructor
+ * @param _compression compression (e.g.: 100)
+ */
+rvs::tdigest::tdigest(double _compression) : compression(_compression) {
+  reset();
+}
+
+/**
+ * @brief drops all the samples
+ */
+void rvs::tdigest::reset(void) {
+  centroids.clear();
+  buffer.clear();
+  total = 0;
+  lo = 0;
+  hi = 0;
+}
+
+/**
+ * @brief adds a sample
+ * @param x sample value
+ * @param w sample weight
+ */
+void rvs::tdigest::add(double x, double w) {
+  if (w <= 0)
+    return;
+  if (total == 0) {
+    lo = hi = x;
+  } else {
+    lo = std::min(lo, x);
+    hi = std::max(hi, x);
+  }
+  buffer.push_back(std::make_pair(x, w));
+  total += w;
+  if (buffer.size() >= RVS_TDIGEST_BUFFER * compression)
+    compress();
+}
+
+/**
+ * @brief adds the samples summarized by another digest
+ * @param other digest to merge
+ */
+void rvs::tdigest::merge(const tdigest& other) {
+  if (other.total == 0)
+    return;
+  if (total == 0) {
+    lo = other.lo;
+    hi = other.hi;
+  } else {
+    lo = std::min(lo, other.lo);
+    hi = std::max(hi, other.hi);
+  }
+  buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+  buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+  total += other.total;
+  compress();
+}
+
+/**
+ * @brief merges the buffered samples into the centroids
+ *
+ * Neighbouring centroids are merged as long as the result spans at most one
+ * unit of the scale function k(q) = compression / (2 pi) * asin(2q - 1),
+ * which is steep (small centroids) near q = 0 and q = 1.
+ */
+void rvs::tdigest::compress(void) {
+  if (buffer.empty())
+    return;
+
+  buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+  std::sort(buffer.begin(), buffer.end());
+  centroids.clear();
+
+  double norm = compression / (2 * M_PI);
+  double so_far = 0;
+  centroid cur = buffer[0];
+  double k_lo = norm * asin(-1.0);
+  for (size_t i = 1; i < buffer.size(); i++) {
+    double q = (so_far + cur.second + buffer[i].second) / total;
+    double k = norm * asin(std::min(1.0, 2 * q - 1));
+    if (k - k_lo <= 1) {
+      // merge into the current centroid
+      cur.second += buffer[i].second;
+      cur.first += (buffer[i].first - cur.first) * buffer[i].second /
+                   cur.second;
+    } else {
+      so_far += cur.second;
+      centroids.push_back(cur);
+      k_lo = norm * asin(std::min(1.0, 2 * so_far / total - 1));
+      cur = buffer[i];
+    }
+  }
+  centroids.push_back(cur);
+  buffer.clear();
+}
+
+/**
+ * @brief estimates a quantile
+ *
+ * Interpolates linearly between the centroid centers and, in the tails,
+ * towards the smallest and largest samples.
+ *
+ * @param q quantile (0..1, e.g.: 0.99)
+ * @return estimated value (0 if no sample was added)
+ */
+double rvs::tdigest::quantile(double q) {
+  compress();
+  if (centroids.empty())
+    return 0;
+  if (q <= 0)
+    return lo;
+  if (q >= 1)
+    return hi;
+
+  double t = q * total;
+  double cum = 0;
+  for (size_t i = 0; i < centroids.size(); i++) {
+    double mid = cum + centroids[i].second / 2;
+    if (t < mid) {
+      if (i == 0) {
+        // between the smallest sample and the first center
+        return lo + (centroids[0].first - lo) * t / mid;
+      }
+      double prev_mid = cum - centroids[i - 1].second / 2;
+      return centroids[i - 1].first +
+             (centroids[i].first - centroids[i - 1].first) *
+             (t - prev_mid) / (mid - prev_mid);
+    }
+    cum += centroids[i].second;
+  }
+  // between the last center and the largest sample
+  double last_mid = total - centroids.back().second / 2;
+  return centroids.back().first + (hi - centroids.back().first) *
+         (t - last_mid) / (total - last_mid);
+}
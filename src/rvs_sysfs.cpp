@@ -0,0 +1,208 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_sysfs.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+/**
+ * @brief parses a decimal integer (sysfs format: optional sign, digits,
+ * trailing newline)
+ * @param s text
+ * @param value stores the integer
+ * @return false if there are no digits, true otherwise
+ */
+bool rvs::sysfs_parse_int(const char* s, int64_t* value) {
+  bool negative = false;
+  int64_t v = 0;
+
+  while (*s == ' ' || *s == '\t')
+    s++;
+  if (*s == '-' || *s == '+')
+    negative = *s++ == '-';
+  if (*s < '0' || *s > '9')
+    return false;
+  while (*s >= '0' && *s <= '9')
+    v = v * 10 + (*s++ - '0');
+
+  *value = negative ? -v : v;
+  return true;
+}
+
+/**
+ * @brief finds the current level of a pp_dpm_sclk/pp_dpm_mclk table
+ * ("<level>: <freq>Mhz" lines, the current one ends with '*')
+ * @param s table text
+ * @param mhz stores the current frequency (MHz)
+ * @return false if no level is marked current, true otherwise
+ */
+bool rvs::sysfs_parse_dpm(const char* s, int64_t* mhz) {
+  while (*s) {
+    const char* eol = strchr(s, '\n');
+    if (eol == nullptr)
+      eol = s + strlen(s);
+    const char* star = static_cast<const char*>(memchr(s, '*', eol - s));
+    const char* colon = static_cast<const char*>(memchr(s, ':', eol - s));
+    if (star != nullptr && colon != nullptr)
+      return sysfs_parse_int(colon + 1, mhz);
+    s = *eol ? eol + 1 : eol;
+  }
+  return false;
+}
+
+//! class constructor
+rvs::sysfs_attr::sysfs_attr() : fd(-1) {
+  buf[0] = '\0';
+}
+
+//! class destructor
+rvs::sysfs_attr::~sysfs_attr() {
+  close();
+}
+
+/**
+ * @brief opens the attribute (closes the one open before if any)
+ * @param path attribute path
+ * @return false if the attribute could not be opened, true otherwise
+ */
+bool rvs::sysfs_attr::open(const std::string& path) {
+  close();
+  fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  return fd >= 0;
+}
+
+//! closes the attribute
+void rvs::sysfs_attr::close(void) {
+  if (fd >= 0)
+    ::close(fd);
+  fd = -1;
+}
+
+/**
+ * @brief reads the current attribute value
+ * @return the value (valid until the next read), nullptr on error
+ */
+const char* rvs::sysfs_attr::read(void) {
+  if (fd < 0)
+    return nullptr;
+
+  ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+  if (len < 0)
+    return nullptr;
+  buf[len] = '\0';
+  return buf;
+}
+
+/**
+ * @brief reads the current attribute value as an integer
+ * @param value stores the integer
+ * @return false on error, true otherwise
+ */
+bool rvs::sysfs_attr::read_int(int64_t* value) {
+  const char* s = read();
+  return s != nullptr && sysfs_parse_int(s, value);
+}
+
+/**
+ * @brief class constructor
+ * @param _device_path PCI device directory of the GPU
+ */
+rvs::gpu_sysfs::gpu_sysfs(const std::string& _device_path)
+    : device_path(_device_path) {
+}
+
+/**
+ * @brief returns the sysfs directory of a PCI device
+ * @param bdfid ROCm SMI PCI ID (domain << 32 | bus << 8 | device << 3 |
+ * function)
+ * @param sysfs sysfs mount point
+ * @return PCI device directory
+ */
+std::string rvs::gpu_sysfs::pci_device_path(uint64_t bdfid,
+                                            const std::string& sysfs) {
+  char bdf[32];
+  snprintf(bdf, sizeof(bdf), "%04x:%02x:%02x.%x",
+           static_cast<unsigned int>(bdfid >> 32),
+           static_cast<unsigned int>((bdfid >> 8) & 0xff),
+           static_cast<unsigned int>((bdfid >> 3) & 0x1f),
+           static_cast<unsigned int>(bdfid & 0x7));
+  return sysfs + "/bus/pci/devices/" + bdf;
+}
+
+/**
+ * @brief opens the attributes of the metrics the GPU exposes
+ * @return false if none could be opened, true otherwise
+ */
+bool rvs::gpu_sysfs::open(void) {
+  std::string hwmon;
+  std::string hwmon_dir = device_path + "/hwmon";
+
+  DIR* dir = opendir(hwmon_dir.c_str());
+  if (dir != nullptr) {
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+      if (strncmp(entry->d_name, "hwmon", 5) == 0) {
+        hwmon = hwmon_dir + "/" + entry->d_name;
+        break;
+      }
+    }
+    closedir(dir);
+  }
+
+  attrs[SYSFS_SCLK].open(device_path + "/pp_dpm_sclk");
+  attrs[SYSFS_MCLK].open(device_path + "/pp_dpm_mclk");
+  if (!hwmon.empty()) {
+    attrs[SYSFS_TEMP].open(hwmon + "/temp1_input");
+    attrs[SYSFS_FAN].open(hwmon + "/pwm1");
+    // newer kernels only have the instant power
+    if (!attrs[SYSFS_POWER].open(hwmon + "/power1_average"))
+      attrs[SYSFS_POWER].open(hwmon + "/power1_input");
+  }
+
+  for (int i = 0; i < SYSFS_NUM_METRICS; i++) {
+    if (attrs[i].is_open())
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief reads a metric
+ * @param metric metric
+ * @param value stores the value (unit: see metric_t)
+ * @return false if the metric is not available, true otherwise
+ */
+bool rvs::gpu_sysfs::read(metric_t metric, int64_t* value) {
+  if (metric == SYSFS_SCLK || metric == SYSFS_MCLK) {
+    const char* s = attrs[metric].read();
+    return s != nullptr && sysfs_parse_dpm(s, value);
+  }
+  return attrs[metric].read_int(value);
+}
@@ -0,0 +1,285 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_timer_wheel.h"
+
+#include <chrono>
+
+/**
+ * @brief class constructor
+ * @param _tick_ns tick length (ns): timers fire at most one tick late
+ * @param _num_slots number of wheel slots
+ */
+rvs::timer_wheel::timer_wheel(uint64_t _tick_ns, size_t _num_slots)
+    : tick_ns(_tick_ns > 0 ? _tick_ns : 1),
+      slots(_num_slots > 0 ? _num_slots : 1) {
+  cursor = now_ns() / tick_ns;
+  next_id = 1;
+  running_id = 0;
+  brun = false;
+  joining = false;
+}
+
+/**
+ * @brief class destructor, stops the wheel thread
+ */
+rvs::timer_wheel::~timer_wheel() {
+  stop();
+}
+
+/**
+ * @brief returns the wheel shared by the timers of the process
+ * @return the shared wheel
+ */
+rvs::timer_wheel& rvs::timer_wheel::shared(void) {
+  static timer_wheel wheel;
+  return wheel;
+}
+
+/**
+ * @brief returns the steady clock time
+ * @return time (ns)
+ */
+uint64_t rvs::timer_wheel::now_ns(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief puts a timer in the slot of its deadline tick (the next slot to be
+ * processed if that tick already went by); the caller holds mtx
+ * @param e timer
+ */
+void rvs::timer_wheel::insert(const entry& e) {
+  uint64_t tick = e.deadline_ns / tick_ns;
+  if (tick < cursor)
+    tick = cursor;
+  size_t slot = tick % slots.size();
+  slots[slot].push_back(e);
+  slot_of[e.id] = slot;
+}
+
+/**
+ * @brief adds a timer (and starts the wheel thread if needed)
+ * @param period_ns time to the first expiration and, unless once is set,
+ * between the next ones (ns)
+ * @param cb called on expiration, on the wheel thread
+ * @param once true if the timer fires only once
+ * @return timer ID (to be passed to cancel())
+ */
+uint64_t rvs::timer_wheel::add(uint64_t period_ns, const callback_t& cb,
+                               bool once) {
+  std::unique_lock<std::mutex> lk(mtx);
+  entry e;
+  e.id = next_id++;
+  e.deadline_ns = now_ns() + period_ns;
+  e.period_ns = period_ns;
+  // a zero period would fire on every tick
+  e.once = once || period_ns == 0;
+  e.cb = cb;
+  insert(e);
+
+  for (;;) {
+    if (brun) {
+      cv.notify_all();
+      return e.id;
+    }
+    if (joining) {
+      // stop() (or another add()) is joining the old thread
+      cv_done.wait(lk);
+      continue;
+    }
+    if (!t.joinable())
+      break;
+    if (t.get_id() == std::this_thread::get_id()) {
+      // stopped from a callback: the wheel thread goes on once it returns
+      brun = true;
+      return e.id;
+    }
+    // a thread left by an earlier stop() may still be finishing a callback
+    join_thread(&lk);
+  }
+
+  brun = true;
+  rvs::ThreadBase::start();
+  return e.id;
+}
+
+/**
+ * @brief joins the wheel thread without holding mtx (a callback it runs may
+ * need it to return); the caller holds mtx and it is held again on return
+ * @param lk caller's lock of mtx
+ */
+void rvs::timer_wheel::join_thread(std::unique_lock<std::mutex>* lk) {
+  std::thread old(std::move(t));
+  joining = true;
+  lk->unlock();
+  try {
+    old.join();
+  } catch(...) {
+  }
+  lk->lock();
+  joining = false;
+  cv_done.notify_all();
+}
+
+/**
+ * @brief removes a timer; once it returns, the callback does not run any
+ * more (unless cancel() is called from the callback itself)
+ * @param id timer ID
+ * @return false if there is no such timer (e.g.: a one shot timer that
+ * already fired), true otherwise
+ */
+bool rvs::timer_wheel::cancel(uint64_t id) {
+  std::unique_lock<std::mutex> lk(mtx);
+  bool found = false;
+
+  auto it = slot_of.find(id);
+  if (it != slot_of.end()) {
+    std::list<entry>& slot = slots[it->second];
+    for (auto e = slot.begin(); e != slot.end(); ++e) {
+      if (e->id == id) {
+        slot.erase(e);
+        break;
+      }
+    }
+    slot_of.erase(it);
+    found = true;
+  } else if (pending.erase(id)) {
+    // due in the tick being processed: the wheel thread skips it
+    found = true;
+  }
+
+  if (std::this_thread::get_id() != t.get_id()) {
+    while (running_id == id)
+      cv_done.wait(lk);
+  }
+  return found;
+}
+
+/**
+ * @brief stops the wheel thread (the timers stay and resume on the next
+ * add())
+ */
+void rvs::timer_wheel::stop(void) {
+  std::unique_lock<std::mutex> lk(mtx);
+  brun = false;
+  cv.notify_all();
+
+  // another stop() may be joining the thread already
+  while (joining)
+    cv_done.wait(lk);
+  if (t.joinable() && std::this_thread::get_id() != t.get_id())
+    join_thread(&lk);
+}
+
+/**
+ * @brief returns the number of timers
+ * @return number of timers
+ */
+size_t rvs::timer_wheel::size(void) {
+  std::lock_guard<std::mutex> lk(mtx);
+  return slot_of.size() + pending.size();
+}
+
+/**
+ * @brief wheel thread: fires the timers of the ticks that went by and sleeps
+ * until the end of the next tick with a non empty slot
+ */
+void rvs::timer_wheel::run(void) {
+  std::unique_lock<std::mutex> lk(mtx);
+  std::vector<entry> due;
+
+  while (brun) {
+    uint64_t now = now_ns();
+    uint64_t now_tick = now / tick_ns;
+
+    // a full turn visits every slot: no need to go around more than once
+    if (now_tick > cursor + slots.size())
+      cursor = now_tick - slots.size();
+
+    due.clear();
+    for (; cursor < now_tick; cursor++) {
+      std::list<entry>& slot = slots[cursor % slots.size()];
+      for (auto e = slot.begin(); e != slot.end(); ) {
+        if (e->deadline_ns / tick_ns > cursor) {
+          // a later turn of the wheel
+          ++e;
+          continue;
+        }
+        due.push_back(*e);
+        slot_of.erase(e->id);
+        pending.insert(e->id);
+        e = slot.erase(e);
+      }
+    }
+
+    for (size_t i = 0; i < due.size(); i++) {
+      entry& e = due[i];
+      // cancelled while an earlier callback of this tick ran
+      if (!pending.erase(e.id))
+        continue;
+      if (!brun) {
+        // stopped: the timer resumes on the next add()
+        insert(e);
+        continue;
+      }
+      // reinsert first, so that the callback (or another thread) can cancel
+      // the timer
+      if (!e.once) {
+        entry next = e;
+        next.deadline_ns += e.period_ns;
+        if (next.deadline_ns <= now)
+          next.deadline_ns +=
+            ((now - next.deadline_ns) / e.period_ns + 1) * e.period_ns;
+        insert(next);
+      }
+      running_id = e.id;
+      lk.unlock();
+      e.cb();
+      lk.lock();
+      running_id = 0;
+      cv_done.notify_all();
+    }
+
+    if (!brun)
+      break;
+
+    // sleep until the next non empty slot (or until a timer is added)
+    bool found = false;
+    uint64_t wake_tick = cursor;
+    for (size_t i = 0; i < slots.size() && !found; i++) {
+      if (!slots[(cursor + i) % slots.size()].empty()) {
+        wake_tick = cursor + i;
+        found = true;
+      }
+    }
+    if (!found) {
+      cv.wait(lk);
+    } else {
+      cv.wait_until(lk, std::chrono::steady_clock::time_point(
+        std::chrono::nanoseconds((wake_tick + 1) * tick_ns)));
+    }
+  }
+}
@@ -0,0 +1,706 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_tsdb.h"
+
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! file header magic
+#define RVS_TS_FILE_MAGIC               "RVSTSDB1"
+//! file format version
+#define RVS_TS_FILE_VERSION             1
+//! block header magic ("RSTB")
+#define RVS_TS_BLOCK_MAGIC              0x42545352u
+//! size of an index entry (bytes)
+#define RVS_TS_INDEX_ENTRY              64
+//! index trailer magic
+#define RVS_TS_INDEX_MAGIC              "RVSTSIX1"
+//! size of the index trailer: index offset, entry count, magic (bytes)
+#define RVS_TS_INDEX_TRAILER            24
+//! max number of bits a sample takes after the first one of a block
+//! (4 + 64 timestamp bits, 2 + 6 + 6 + 64 value bits)
+#define RVS_TS_MAX_SAMPLE_BITS          146
+
+namespace {
+
+//! stores an unsigned integer of the given size (little endian)
+void put_le(uint8_t* p, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+//! loads an unsigned integer of the given size (little endian)
+uint64_t get_le(const uint8_t* p, int bytes) {
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; i++)
+    v |= static_cast<uint64_t>(p[i]) << (8 * i);
+  return v;
+}
+
+//! returns the time of the given clock (ns)
+uint64_t clock_ns(clockid_t id) {
+  struct timespec ts;
+  clock_gettime(id, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+//! bits of a double
+uint64_t double_bits(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+//! double of the given bits
+double bits_double(uint64_t bits) {
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+//! stores the metric name of a series (0 padded)
+void put_metric(uint8_t* p, const std::string& metric) {
+  memset(p, 0, RVS_TS_METRIC_LEN);
+  memcpy(p, metric.c_str(),
+         std::min(metric.size(), static_cast<size_t>(RVS_TS_METRIC_LEN - 1)));
+}
+
+//! loads the metric name of a series
+std::string get_metric(const uint8_t* p) {
+  return std::string(reinterpret_cast<const char*>(p),
+                     strnlen(reinterpret_cast<const char*>(p),
+                             RVS_TS_METRIC_LEN - 1));
+}
+
+}  // namespace
+
+/**
+ * @brief class constructor
+ * @param _capacity block capacity (bytes)
+ */
+rvs::ts_encoder::ts_encoder(size_t _capacity) : buf(_capacity) {
+  reset();
+}
+
+/**
+ * @brief empties the block
+ */
+void rvs::ts_encoder::reset(void) {
+  std::fill(buf.begin(), buf.end(), 0);
+  num_bits = 0;
+  num_samples = 0;
+  first_us = prev_us = 0;
+  prev_delta = 0;
+  prev_bits = 0;
+  prev_lead = prev_trail = -1;
+}
+
+/**
+ * @brief appends bits to the block (most significant first)
+ * @param bits bits to append (right aligned)
+ * @param n number of bits (1..64)
+ */
+void rvs::ts_encoder::put_bits(uint64_t bits, int n) {
+  while (n > 0) {
+    int room = 8 - num_bits % 8;
+    int take = std::min(room, n);
+    uint8_t chunk = (bits >> (n - take)) & ((1u << take) - 1);
+    buf[num_bits / 8] |= chunk << (room - take);
+    num_bits += take;
+    n -= take;
+  }
+}
+
+/**
+ * @brief appends a sample to the block
+ * @param t_ns time of the sample (ns, not decreasing from one call to the
+ * next for a good compression)
+ * @param value sample value
+ * @return false if the block is full, true otherwise
+ */
+bool rvs::ts_encoder::add(uint64_t t_ns, double value) {
+  uint64_t t_us = t_ns / 1000;
+  uint64_t bits = double_bits(value);
+
+  if (num_samples == 0) {
+    if (buf.size() < 16)
+      return false;
+    put_bits(t_us, 64);
+    put_bits(bits, 64);
+    first_us = prev_us = t_us;
+    prev_bits = bits;
+    num_samples++;
+    return true;
+  }
+  if (num_bits + RVS_TS_MAX_SAMPLE_BITS > buf.size() * 8)
+    return false;
+
+  // delta-of-delta of the timestamps (zigzag encoded)
+  int64_t delta = static_cast<int64_t>(t_us - prev_us);
+  int64_t dod = delta - prev_delta;
+  uint64_t zz = (static_cast<uint64_t>(dod) << 1) ^
+                static_cast<uint64_t>(dod >> 63);
+  if (zz == 0) {
+    put_bits(0, 1);
+  } else if (zz < (1ull << 12)) {
+    put_bits(0x2, 2);
+    put_bits(zz, 12);
+  } else if (zz < (1ull << 24)) {
+    put_bits(0x6, 3);
+    put_bits(zz, 24);
+  } else if (zz < (1ull << 40)) {
+    put_bits(0xe, 4);
+    put_bits(zz, 40);
+  } else {
+    put_bits(0xf, 4);
+    put_bits(zz, 64);
+  }
+  prev_delta = delta;
+  prev_us = t_us;
+
+  // XOR with the previous value
+  uint64_t x = bits ^ prev_bits;
+  if (x == 0) {
+    put_bits(0, 1);
+  } else {
+    int lead = __builtin_clzll(x);
+    int trail = __builtin_ctzll(x);
+    if (prev_lead >= 0 && lead >= prev_lead && trail >= prev_trail) {
+      // the changed bits fit in the previous window
+      put_bits(0x2, 2);
+      put_bits(x >> prev_trail, 64 - prev_lead - prev_trail);
+    } else {
+      int len = 64 - lead - trail;
+      put_bits(0x3, 2);
+      put_bits(lead, 6);
+      put_bits(len - 1, 6);
+      put_bits(x >> trail, len);
+      prev_lead = lead;
+      prev_trail = trail;
+    }
+  }
+  prev_bits = bits;
+  num_samples++;
+  return true;
+}
+
+/**
+ * @brief class constructor
+ * @param _data encoded samples
+ * @param _size number of encoded bytes
+ * @param _count number of encoded samples
+ */
+rvs::ts_decoder::ts_decoder(const uint8_t* _data, size_t _size,
+                            uint32_t _count)
+    : data(_data), size_bits(_size * 8), pos(0), count(_count),
+      num_samples(0), prev_us(0), prev_delta(0), prev_bits(0),
+      prev_lead(-1), prev_trail(-1) {
+}
+
+/**
+ * @brief reads bits (most significant first)
+ * @param n number of bits (1..64)
+ * @param bits stores the bits (right aligned)
+ * @return false if there are fewer than n bits left, true otherwise
+ */
+bool rvs::ts_decoder::get_bits(int n, uint64_t* bits) {
+  if (pos + n > size_bits)
+    return false;
+  uint64_t v = 0;
+  while (n > 0) {
+    int room = 8 - pos % 8;
+    int take = std::min(room, n);
+    uint8_t chunk = (data[pos / 8] >> (room - take)) & ((1u << take) - 1);
+    v = (v << take) | chunk;
+    pos += take;
+    n -= take;
+  }
+  *bits = v;
+  return true;
+}
+
+/**
+ * @brief reads the next sample
+ * @param sample stores the sample
+ * @return false if all the samples were read or the data is corrupt, true
+ * otherwise
+ */
+bool rvs::ts_decoder::next(ts_sample* sample) {
+  uint64_t bits, v;
+
+  if (num_samples == count)
+    return false;
+
+  if (num_samples == 0) {
+    if (!get_bits(64, &prev_us) || !get_bits(64, &prev_bits))
+      return false;
+  } else {
+    // delta-of-delta: 0, 10, 110, 1110 or 1111 prefix
+    int ones = 0;
+    while (ones < 4) {
+      if (!get_bits(1, &v))
+        return false;
+      if (v == 0)
+        break;
+      ones++;
+    }
+    static const int width[] = {0, 12, 24, 40, 64};
+    uint64_t zz = 0;
+    if (ones > 0 && !get_bits(width[ones], &zz))
+      return false;
+    int64_t dod = static_cast<int64_t>(zz >> 1) ^ -static_cast<int64_t>(zz & 1);
+    prev_delta += dod;
+    prev_us += prev_delta;
+
+    // XOR with the previous value: 0, 10 or 11 prefix
+    if (!get_bits(1, &v))
+      return false;
+    if (v) {
+      if (!get_bits(1, &v))
+        return false;
+      if (v == 0) {
+        if (prev_lead < 0 ||
+            !get_bits(64 - prev_lead - prev_trail, &bits))
+          return false;
+        prev_bits ^= bits << prev_trail;
+      } else {
+        uint64_t lead, len;
+        if (!get_bits(6, &lead) || !get_bits(6, &len))
+          return false;
+        len++;
+        if (lead + len > 64 || !get_bits(len, &bits))
+          return false;
+        prev_lead = lead;
+        prev_trail = 64 - lead - len;
+        prev_bits ^= bits << prev_trail;
+      }
+    }
+  }
+
+  sample->t_ns = prev_us * 1000;
+  sample->value = bits_double(prev_bits);
+  num_samples++;
+  return true;
+}
+
+//! class constructor
+rvs::ts_writer::ts_writer()
+    : fp(nullptr), opened(false), num_blocks(0), last_sync_ns(0) {
+}
+
+//! class destructor
+rvs::ts_writer::~ts_writer() {
+  close();
+}
+
+/**
+ * @brief creates a time-series file (an existing one is overwritten)
+ * @param path file path
+ * @return false if the file could not be created, true otherwise
+ */
+bool rvs::ts_writer::open(const std::string& path) {
+  close();
+
+  std::lock_guard<std::mutex> lk(mtx);
+  fp = fopen(path.c_str(), "w+b");
+  if (fp == nullptr)
+    return false;
+
+  std::vector<uint8_t> header(RVS_TS_BLOCK_SIZE, 0);
+  memcpy(header.data(), RVS_TS_FILE_MAGIC, 8);
+  put_le(header.data() + 8, RVS_TS_FILE_VERSION, 4);
+  put_le(header.data() + 12, RVS_TS_BLOCK_SIZE, 4);
+  put_le(header.data() + 16, clock_ns(CLOCK_MONOTONIC), 8);
+  put_le(header.data() + 24, clock_ns(CLOCK_REALTIME), 8);
+  if (fwrite(header.data(), header.size(), 1, fp) != 1) {
+    fclose(fp);
+    fp = nullptr;
+    return false;
+  }
+
+  num_blocks = 0;
+  last_sync_ns = clock_ns(CLOCK_MONOTONIC);
+  opened = true;
+  return true;
+}
+
+/**
+ * @brief appends a sample to a series
+ * @param gpu_id GPU ID
+ * @param metric metric name (up to RVS_TS_METRIC_LEN - 1 characters)
+ * @param t_ns time of the sample (ns, CLOCK_MONOTONIC)
+ * @param value sample value
+ * @return false if no file is open or it could not be written, true otherwise
+ */
+bool rvs::ts_writer::append(int32_t gpu_id, const char* metric, uint64_t t_ns,
+                            double value) {
+  std::lock_guard<std::mutex> lk(mtx);
+  if (fp == nullptr)
+    return false;
+
+  series_key key(gpu_id, metric);
+  key.second.resize(std::min(key.second.size(),
+                             static_cast<size_t>(RVS_TS_METRIC_LEN - 1)));
+  std::unique_ptr<series>& s = open_series[key];
+  if (!s)
+    s.reset(new series);
+
+  bool ok = true;
+  if (!s->enc.add(t_ns, value)) {
+    // block full: it will not change anymore
+    ok = end_block(key, s.get());
+    s->enc.add(t_ns, value);
+  }
+
+  if (clock_ns(CLOCK_MONOTONIC) - last_sync_ns >= RVS_TS_SYNC_NS)
+    ok = write_open_blocks() && ok;
+  return ok;
+}
+
+/**
+ * @brief writes a block (in place if it was written before)
+ * @param key series of the block
+ * @param s series state
+ * @return false on write error, true otherwise
+ */
+bool rvs::ts_writer::write_block(const series_key& key, series* s) {
+  if (s->block < 0)
+    s->block = num_blocks++;
+
+  std::vector<uint8_t> block(RVS_TS_BLOCK_SIZE, 0);
+  uint8_t* p = block.data();
+  put_le(p, RVS_TS_BLOCK_MAGIC, 4);
+  put_le(p + 4, static_cast<uint32_t>(key.first), 4);
+  put_le(p + 8, s->enc.count(), 4);
+  put_le(p + 12, s->enc.size(), 4);
+  put_le(p + 16, s->enc.first_ns(), 8);
+  put_le(p + 24, s->enc.last_ns(), 8);
+  put_metric(p + 32, key.second);
+  memcpy(p + RVS_TS_BLOCK_HEADER, s->enc.data(), s->enc.size());
+
+  off_t offset = static_cast<off_t>(s->block + 1) * RVS_TS_BLOCK_SIZE;
+  if (fseeko(fp, offset, SEEK_SET))
+    return false;
+  return fwrite(p, block.size(), 1, fp) == 1;
+}
+
+/**
+ * @brief writes a complete block and adds it to the index
+ * @param key series of the block
+ * @param s series state (its block is emptied)
+ * @return false on write error, true otherwise
+ */
+bool rvs::ts_writer::end_block(const series_key& key, series* s) {
+  bool ok = write_block(key, s);
+
+  ts_block_info info;
+  info.gpu_id = key.first;
+  info.metric = key.second;
+  info.block = s->block;
+  info.count = s->enc.count();
+  info.first_ns = s->enc.first_ns();
+  info.last_ns = s->enc.last_ns();
+  index.push_back(info);
+
+  s->enc.reset();
+  s->block = -1;
+  return ok;
+}
+
+/**
+ * @brief writes the blocks still being filled (in place) and flushes the file
+ * @return false on write error, true otherwise
+ */
+bool rvs::ts_writer::write_open_blocks(void) {
+  bool ok = true;
+  for (auto it = open_series.begin(); it != open_series.end(); it++) {
+    if (it->second->enc.count() > 0)
+      ok = write_block(it->first, it->second.get()) && ok;
+  }
+  last_sync_ns = clock_ns(CLOCK_MONOTONIC);
+  return fflush(fp) == 0 && ok;
+}
+
+/**
+ * @brief writes all the samples appended so far to the file
+ * @return false if no file is open or it could not be written, true otherwise
+ */
+bool rvs::ts_writer::sync(void) {
+  std::lock_guard<std::mutex> lk(mtx);
+  if (fp == nullptr)
+    return false;
+  return write_open_blocks();
+}
+
+/**
+ * @brief writes the remaining samples and the index, then closes the file
+ * @return false on write error, true otherwise
+ */
+bool rvs::ts_writer::close(void) {
+  std::lock_guard<std::mutex> lk(mtx);
+  if (fp == nullptr)
+    return true;
+
+  bool ok = true;
+  for (auto it = open_series.begin(); it != open_series.end(); it++) {
+    if (it->second->enc.count() > 0)
+      ok = end_block(it->first, it->second.get()) && ok;
+  }
+
+  uint64_t offset = static_cast<uint64_t>(num_blocks + 1) * RVS_TS_BLOCK_SIZE;
+  std::vector<uint8_t> buf(index.size() * RVS_TS_INDEX_ENTRY +
+                           RVS_TS_INDEX_TRAILER, 0);
+  uint8_t* p = buf.data();
+  for (size_t i = 0; i < index.size(); i++, p += RVS_TS_INDEX_ENTRY) {
+    put_le(p, static_cast<uint32_t>(index[i].gpu_id), 4);
+    put_le(p + 4, index[i].block, 4);
+    put_le(p + 8, index[i].count, 4);
+    put_le(p + 16, index[i].first_ns, 8);
+    put_le(p + 24, index[i].last_ns, 8);
+    put_metric(p + 32, index[i].metric);
+  }
+  put_le(p, offset, 8);
+  put_le(p + 8, index.size(), 8);
+  memcpy(p + 16, RVS_TS_INDEX_MAGIC, 8);
+
+  if (fseeko(fp, static_cast<off_t>(offset), SEEK_SET) ||
+      fwrite(buf.data(), buf.size(), 1, fp) != 1)
+    ok = false;
+  if (fclose(fp))
+    ok = false;
+
+  fp = nullptr;
+  opened = false;
+  open_series.clear();
+  index.clear();
+  return ok;
+}
+
+//! class constructor
+rvs::ts_reader::ts_reader()
+    : fp(nullptr), indexed(false), start_mono_ns(0), start_real_ns(0) {
+}
+
+//! class destructor
+rvs::ts_reader::~ts_reader() {
+  close();
+}
+
+/**
+ * @brief opens a time-series file and lists its blocks
+ * @param path file path
+ * @return false if the file could not be read or is not a time-series file,
+ * true otherwise
+ */
+bool rvs::ts_reader::open(const std::string& path) {
+  uint8_t header[32];
+
+  close();
+  fp = fopen(path.c_str(), "rb");
+  if (fp == nullptr)
+    return false;
+
+  if (fread(header, sizeof(header), 1, fp) != 1 ||
+      memcmp(header, RVS_TS_FILE_MAGIC, 8) ||
+      get_le(header + 8, 4) != RVS_TS_FILE_VERSION ||
+      get_le(header + 12, 4) != RVS_TS_BLOCK_SIZE) {
+    close();
+    return false;
+  }
+  start_mono_ns = get_le(header + 16, 8);
+  start_real_ns = get_le(header + 24, 8);
+
+  // a file that was not closed has no index
+  indexed = read_index();
+  if (!indexed && !scan_blocks()) {
+    close();
+    return false;
+  }
+
+  std::stable_sort(blocks.begin(), blocks.end(),
+    [](const ts_block_info& a, const ts_block_info& b) {
+      return a.first_ns < b.first_ns;
+    });
+  return true;
+}
+
+//! closes the file
+void rvs::ts_reader::close(void) {
+  if (fp != nullptr)
+    fclose(fp);
+  fp = nullptr;
+  blocks.clear();
+  indexed = false;
+}
+
+/**
+ * @brief lists the blocks from the file index
+ * @return false if the file has no (valid) index, true otherwise
+ */
+bool rvs::ts_reader::read_index(void) {
+  uint8_t trailer[RVS_TS_INDEX_TRAILER];
+
+  if (fseeko(fp, -RVS_TS_INDEX_TRAILER, SEEK_END) ||
+      fread(trailer, sizeof(trailer), 1, fp) != 1 ||
+      memcmp(trailer + 16, RVS_TS_INDEX_MAGIC, 8))
+    return false;
+  off_t end = ftello(fp);
+  uint64_t offset = get_le(trailer, 8);
+  uint64_t entries = get_le(trailer + 8, 8);
+  if (offset + entries * RVS_TS_INDEX_ENTRY + RVS_TS_INDEX_TRAILER !=
+      static_cast<uint64_t>(end))
+    return false;
+
+  std::vector<uint8_t> buf(entries * RVS_TS_INDEX_ENTRY);
+  if (fseeko(fp, static_cast<off_t>(offset), SEEK_SET) ||
+      (entries && fread(buf.data(), buf.size(), 1, fp) != 1))
+    return false;
+
+  blocks.clear();
+  for (const uint8_t* p = buf.data(); p < buf.data() + buf.size();
+       p += RVS_TS_INDEX_ENTRY) {
+    ts_block_info info;
+    info.gpu_id = static_cast<int32_t>(get_le(p, 4));
+    info.block = get_le(p + 4, 4);
+    info.count = get_le(p + 8, 4);
+    info.first_ns = get_le(p + 16, 8);
+    info.last_ns = get_le(p + 24, 8);
+    info.metric = get_metric(p + 32);
+    blocks.push_back(info);
+  }
+  return true;
+}
+
+/**
+ * @brief lists the blocks from their headers (file with no index)
+ * @return false on read error, true otherwise
+ */
+bool rvs::ts_reader::scan_blocks(void) {
+  uint8_t p[RVS_TS_BLOCK_HEADER];
+
+  if (fseeko(fp, 0, SEEK_END))
+    return false;
+  off_t size = ftello(fp);
+  uint32_t num_blocks = size / RVS_TS_BLOCK_SIZE - 1;
+
+  blocks.clear();
+  for (uint32_t b = 0; b < num_blocks; b++) {
+    off_t offset = static_cast<off_t>(b + 1) * RVS_TS_BLOCK_SIZE;
+    if (fseeko(fp, offset, SEEK_SET) || fread(p, sizeof(p), 1, fp) != 1)
+      return false;
+    if (get_le(p, 4) != RVS_TS_BLOCK_MAGIC || get_le(p + 8, 4) == 0)
+      continue;
+    ts_block_info info;
+    info.gpu_id = static_cast<int32_t>(get_le(p + 4, 4));
+    info.block = b;
+    info.count = get_le(p + 8, 4);
+    info.first_ns = get_le(p + 16, 8);
+    info.last_ns = get_le(p + 24, 8);
+    info.metric = get_metric(p + 32);
+    blocks.push_back(info);
+  }
+  return true;
+}
+
+/**
+ * @brief lists the series of the file
+ * @return series sorted by GPU ID and metric name
+ */
+std::vector<rvs::ts_reader::series_info> rvs::ts_reader::get_series(void)
+    const {
+  std::map<std::pair<int32_t, std::string>, series_info> all;
+
+  for (auto it = blocks.begin(); it != blocks.end(); it++) {
+    std::pair<int32_t, std::string> key(it->gpu_id, it->metric);
+    auto s = all.find(key);
+    if (s == all.end()) {
+      series_info info = {it->gpu_id, it->metric, it->count,
+                          it->first_ns, it->last_ns};
+      all[key] = info;
+      continue;
+    }
+    s->second.count += it->count;
+    s->second.first_ns = std::min(s->second.first_ns, it->first_ns);
+    s->second.last_ns = std::max(s->second.last_ns, it->last_ns);
+  }
+
+  std::vector<series_info> series;
+  for (auto it = all.begin(); it != all.end(); it++)
+    series.push_back(it->second);
+  return series;
+}
+
+/**
+ * @brief reads the samples of a series within a time range; only the blocks
+ * overlapping the range are read
+ * @param gpu_id GPU ID
+ * @param metric metric name
+ * @param from_ns start of the range (ns, inclusive)
+ * @param to_ns end of the range (ns, inclusive)
+ * @param samples stores the samples, oldest first
+ * @return false on read error or corrupt block, true otherwise
+ */
+bool rvs::ts_reader::query(int32_t gpu_id, const std::string& metric,
+                           uint64_t from_ns, uint64_t to_ns,
+                           std::vector<ts_sample>* samples) {
+  std::vector<uint8_t> block(RVS_TS_BLOCK_SIZE);
+  ts_sample s;
+
+  samples->clear();
+  if (fp == nullptr)
+    return false;
+
+  for (auto it = blocks.begin(); it != blocks.end(); it++) {
+    if (it->gpu_id != gpu_id || it->metric != metric ||
+        it->last_ns < from_ns || it->first_ns > to_ns)
+      continue;
+
+    off_t offset = static_cast<off_t>(it->block + 1) * RVS_TS_BLOCK_SIZE;
+    if (fseeko(fp, offset, SEEK_SET) ||
+        fread(block.data(), block.size(), 1, fp) != 1)
+      return false;
+    const uint8_t* p = block.data();
+    uint32_t count = get_le(p + 8, 4);
+    size_t size = get_le(p + 12, 4);
+    if (get_le(p, 4) != RVS_TS_BLOCK_MAGIC ||
+        size > RVS_TS_BLOCK_SIZE - RVS_TS_BLOCK_HEADER)
+      return false;
+
+    ts_decoder dec(p + RVS_TS_BLOCK_HEADER, size, count);
+    for (uint32_t i = 0; i < count; i++) {
+      if (!dec.next(&s))
+        return false;
+      if (s.t_ns >= from_ns && s.t_ns <= to_ns)
+        samples->push_back(s);
+    }
+  }
+  return true;
+}
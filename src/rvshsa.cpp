@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -38,6 +39,10 @@
 
 #include "include/rvs_util.h"
 #include "include/rvsloglp.h"
+#include "include/rvs_cancel.h"
+
+//! how long (in ms) a copy wait spins before checking for a stop request
+#define RVS_HSA_WAIT_SLICE_MS   10
 
 // ptr to singletone instance
 rvs::hsa* rvs::hsa::pDsc;
@@ -269,6 +274,45 @@ bool rvs::hsa::check_link_type(
   return retval;
 }
 
+/**
+ * @brief Convert host memory type name into hostmem_t value
+ *
+ * @param Name host memory type name ("pool", "locked-user", "pageable-staged")
+ * @param pHostMem [out] host memory type
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::str2hostmem(const std::string& Name, hostmem_t* pHostMem) {
+  if (Name == "pool") {
+    *pHostMem = HOSTMEM_POOL;
+  } else if (Name == "locked-user") {
+    *pHostMem = HOSTMEM_LOCKED_USER;
+  } else if (Name == "pageable-staged") {
+    *pHostMem = HOSTMEM_PAGEABLE_STAGED;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Convert hostmem_t value into host memory type name
+ *
+ * @param HostMem host memory type
+ * @return host memory type name
+ *
+ * */
+std::string rvs::hsa::hostmem2str(hostmem_t HostMem) {
+  switch (HostMem) {
+    case HOSTMEM_LOCKED_USER:
+      return "locked-user";
+    case HOSTMEM_PAGEABLE_STAGED:
+      return "pageable-staged";
+    default:
+      return "pool";
+  }
+}
+
 
 /**
  * @brief Fetch all HSA agents
@@ -526,6 +570,36 @@ int rvs::hsa::FindAgent(const uint32_t Node) {
   return -1;
 }
 
+/**
+ * @brief Waits for a copy completion signal
+ *
+ * Spins (as the copy time is measured) in slices of RVS_HSA_WAIT_SLICE_MS
+ * and checks for a stop request in between. A DMA copy cannot be aborted
+ * and its buffers may only be released once it completes, so after a stop
+ * request the wait goes on without keeping a core busy.
+ *
+ * @param signal signal set to 0 by the copy
+ * @return true if the copy completed without a stop request meanwhile
+ *
+ * */
+bool rvs::hsa::WaitSignal(hsa_signal_t signal) {
+  rvs::cancel_token* token = rvs::cancel_token::process();
+  uint64_t freq = 0;
+
+  if (HSA_STATUS_SUCCESS != hsa_system_get_info(
+        HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &freq) || freq == 0)
+    freq = 1000000000;
+  uint64_t slice = freq / 1000 * RVS_HSA_WAIT_SLICE_MS;
+
+  hsa_wait_state_t state = HSA_WAIT_STATE_ACTIVE;
+  while (hsa_signal_wait_acquire(signal, HSA_SIGNAL_CONDITION_LT,
+    1, slice, state)) {
+    if (token->cancelled())
+      state = HSA_WAIT_STATE_BLOCKED;
+  }
+  return !token->cancelled();
+}
+
 /**
  * @brief Fetch time needed to copy data between two memory pools
  *
@@ -577,15 +651,22 @@ double rvs::hsa::GetCopyTime(bool bidirectional,
  * @param SrcBuff  [out] ptr to source buffer
  * @param pDstPool [out] ptr to destination memory pool
  * @param DstBuff  [out] ptr to destination buffer
+ * @param HostBuff 'false' to only select the pool of the CPU agent (its
+ * buffer is set to nullptr, e.g.: the caller locks a user buffer instead)
  * @return 0 - if successfull, non-zero otherwise
  *
  * */
 int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
                      hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
-                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff) {
+                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff,
+                     bool HostBuff) {
   hsa_status_t status;
   void* srcbuff = nullptr;
   void* dstbuff = nullptr;
+  bool alloc_src = HostBuff ||
+                   agent_list[SrcAgent].agent_device_type != "CPU";
+  bool alloc_dst = HostBuff ||
+                   agent_list[DstAgent].agent_device_type != "CPU";
 
   // iterate over src pools
   for (size_t i = 0; i < agent_list[SrcAgent].mem_pool_list.size(); i++) {
@@ -598,7 +679,8 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
 
     RVSHSATRACE_
     // try allocating source buffer
-    if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
+    if (alloc_src &&
+        HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
                 agent_list[SrcAgent].mem_pool_list[i], Size, 0, &srcbuff))) {
       print_hsa_status(__FILE__, __LINE__, __func__,
                    "hsa_amd_memory_pool_allocate()",
@@ -648,7 +730,8 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
       }
       RVSHSATRACE_
       // try allocating destination buffer
-      if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
+      if (alloc_dst &&
+          HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
         agent_list[DstAgent].mem_pool_list[j], Size, 0, &dstbuff))) {
         print_hsa_status(__FILE__, __LINE__, __func__,
                    "hsa_amd_memory_pool_allocate()",
@@ -662,18 +745,22 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
       RVSHSATRACE_
 
       // determine which one is a cpu and allow access on the other agent
+      // (nothing to do if the cpu buffer was not allocated)
+      status = HSA_STATUS_SUCCESS;
       if (agent_list[SrcAgent].agent_device_type == "CPU") {
         RVSHSATRACE_
-        status = hsa_amd_agents_allow_access(1,
-                                            &agent_list[DstAgent].agent,
-                                            NULL,
-                                            srcbuff);
+        if (srcbuff)
+          status = hsa_amd_agents_allow_access(1,
+                                              &agent_list[DstAgent].agent,
+                                              NULL,
+                                              srcbuff);
       } else {
         RVSHSATRACE_
-        status = hsa_amd_agents_allow_access(1,
-                                            &agent_list[SrcAgent].agent,
-                                            NULL,
-                                            dstbuff);
+        if (dstbuff)
+          status = hsa_amd_agents_allow_access(1,
+                                              &agent_list[SrcAgent].agent,
+                                              NULL,
+                                              dstbuff);
       }
       if (status != HSA_STATUS_SUCCESS) {
         RVSHSATRACE_
@@ -681,7 +768,8 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
                 "hsa_amd_agents_allow_access()",
                 status);
         // do cleanup
-        hsa_amd_memory_pool_free(dstbuff);
+        if (dstbuff)
+          hsa_amd_memory_pool_free(dstbuff);
         dstbuff = nullptr;
         continue;
       }
@@ -698,7 +786,9 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
 
     RVSHSATRACE_
     // suitable destination buffer not foud, deallocate src buff and exit
-    hsa_amd_memory_pool_free(srcbuff);
+    if (srcbuff)
+      hsa_amd_memory_pool_free(srcbuff);
+    srcbuff = nullptr;
   }  // end of src agent pool loop
 
   RVSHSATRACE_
@@ -713,12 +803,14 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
  * @param Size size of data to transfer
  * @param bidirectional 'true' for bidirectional transfer
  * @param Duration [out] duration of transfer in seconds
- * @return 0 - if successfull, non-zero otherwise
+ * @param HostMem type of memory used on the host side of the transfer
+ * @return 0 - if successfull, non-zero otherwise (also if RVS was asked to
+ * stop meanwhile)
  *
  * */
 int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
                               size_t Size, bool bidirectional,
-                              double* Duration) {
+                              double* Duration, hostmem_t HostMem) {
   hsa_status_t status;
   int sts;
 
@@ -740,6 +832,12 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
 
   RVSHSATRACE_
 
+  if (HostMem != HOSTMEM_POOL) {
+    RVSHSATRACE_
+    return SendTrafficHostMem(SrcNode, DstNode, Size, bidirectional,
+                              HostMem, Duration);
+  }
+
   // given NUMA nodes, find agent indexes
   src_ix_fwd = FindAgent(SrcNode);
   dst_ix_fwd = FindAgent(DstNode);
@@ -830,19 +928,20 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
 
   // wait for transfer to complete
   RVSHSATRACE_
-  while (hsa_signal_wait_acquire(signal_fwd, HSA_SIGNAL_CONDITION_LT,
-    1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE)) {}
+  bool completed = WaitSignal(signal_fwd);
 
   // if bidirectional, also wait for reverse transfer to complete
   if (bidirectional == true) {
     RVSHSATRACE_
-    while (hsa_signal_wait_acquire(signal_rev, HSA_SIGNAL_CONDITION_LT,
-    1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE)) {}
+    completed = WaitSignal(signal_rev) && completed;
   }
 
-  RVSHSATRACE_
-  // get transfer duration
-  *Duration = GetCopyTime(bidirectional, signal_fwd, signal_rev)/1000000000;
+  // after a stop request the copy time is not meaningful
+  if (completed) {
+    RVSHSATRACE_
+    // get transfer duration
+    *Duration = GetCopyTime(bidirectional, signal_fwd, signal_rev)/1000000000;
+  }
 
   hsa_amd_memory_pool_free(src_ptr_fwd);
   hsa_amd_memory_pool_free(dst_ptr_fwd);
@@ -856,9 +955,289 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
   }
   RVSHSATRACE_
 
+  return completed ? 0 : -1;
+}
+
+/**
+ * @brief Send traffic between host and device using user allocated host
+ * memory
+ *
+ * Host side of the transfer is either user buffer locked with
+ * hsa_amd_memory_lock() (HOSTMEM_LOCKED_USER) or pageable user buffer copied
+ * to/from pinned system pool buffer (HOSTMEM_PAGEABLE_STAGED). Duration
+ * includes host side work (locking/unlocking or staging copy), as seen by
+ * the application.
+ *
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @param Size size of data to transfer
+ * @param bidirectional 'true' for bidirectional transfer
+ * @param HostMem type of memory used on the host side of the transfer
+ * @param Duration [out] duration of transfer in seconds
+ * @return 0 - if successfull, non-zero otherwise (also if RVS was asked to
+ * stop meanwhile)
+ *
+ * */
+int rvs::hsa::SendTrafficHostMem(uint32_t SrcNode, uint32_t DstNode,
+                                 size_t Size, bool bidirectional,
+                                 hostmem_t HostMem, double* Duration) {
+  hostxfer_t ctx_fwd;
+  hostxfer_t ctx_rev;
+  int sts;
+
+  RVSHSATRACE_
+  int src_ix = FindAgent(SrcNode);
+  int dst_ix = FindAgent(DstNode);
+  if (src_ix < 0 || dst_ix < 0) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  // host memory type is meaningful only if one of the agents is CPU
+  if (agent_list[src_ix].agent_device_type != "CPU" &&
+      agent_list[dst_ix].agent_device_type != "CPU") {
+    RVSHSATRACE_
+    return SendTraffic(SrcNode, DstNode, Size, bidirectional, Duration);
+  }
+
+  if (HostXferInit(src_ix, dst_ix, Size, HostMem, &ctx_fwd)) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  if (bidirectional) {
+    RVSHSATRACE_
+    if (HostXferInit(dst_ix, src_ix, Size, HostMem, &ctx_rev)) {
+      RVSHSATRACE_
+      HostXferRelease(&ctx_fwd);
+      return -1;
+    }
+  }
+
+  auto start_time = std::chrono::steady_clock::now();
+
+  // initiate transfer(s)
+  int sts_fwd = HostXferStart(&ctx_fwd, Size, HostMem);
+  int sts_rev = 0;
+  if (sts_fwd == 0 && bidirectional) {
+    RVSHSATRACE_
+    sts_rev = HostXferStart(&ctx_rev, Size, HostMem);
+  }
+
+  // a started copy uses its buffers until it completes: wait for it even if
+  // the other one could not be started, before anything is released
+  // (a stop request meanwhile fails the transfer)
+  if (sts_fwd == 0) {
+    RVSHSATRACE_
+    if (!WaitSignal(ctx_fwd.Sig))
+      sts_fwd = -1;
+  }
+  if (sts_fwd == 0 && bidirectional && sts_rev == 0) {
+    RVSHSATRACE_
+    if (!WaitSignal(ctx_rev.Sig))
+      sts_rev = -1;
+  }
+
+  // finish host side work
+  sts = sts_fwd | sts_rev;
+  if (sts == 0) {
+    RVSHSATRACE_
+    sts = HostXferFinish(&ctx_fwd, Size, HostMem);
+    if (bidirectional) {
+      RVSHSATRACE_
+      sts |= HostXferFinish(&ctx_rev, Size, HostMem);
+    }
+  }
+
+  auto end_time = std::chrono::steady_clock::now();
+  *Duration = std::chrono::duration<double>(end_time - start_time).count();
+
+  HostXferRelease(&ctx_fwd);
+  if (bidirectional) {
+    RVSHSATRACE_
+    HostXferRelease(&ctx_rev);
+  }
+
+  RVSHSATRACE_
+  return sts;
+}
+
+/**
+ * @brief Allocate buffers and signal for one host-device transfer
+ *
+ * @param SrcIx source agent index in agent_list vector
+ * @param DstIx destination agent index in agent_list vector
+ * @param Size size of data to transfer
+ * @param HostMem type of memory used on the host side of the transfer
+ * @param pCtx [out] transfer context
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::HostXferInit(int SrcIx, int DstIx, size_t Size,
+                           hostmem_t HostMem, hostxfer_t* pCtx) {
+  hsa_status_t status;
+  hsa_amd_memory_pool_t src_pool;
+  hsa_amd_memory_pool_t dst_pool;
+
+  pCtx->SrcIx = SrcIx;
+  pCtx->DstIx = DstIx;
+  pCtx->bHostIsSrc = agent_list[SrcIx].agent_device_type == "CPU";
+  pCtx->pSrcPoolBuff = nullptr;
+  pCtx->pDstPoolBuff = nullptr;
+  pCtx->pUserBuff = nullptr;
+  pCtx->pLockedBuff = nullptr;
+  pCtx->Sig.handle = 0;
+
+  // host side pool buffer is used as staging buffer; a locked user buffer
+  // replaces it, so only the device side is allocated then
+  if (Allocate(SrcIx, DstIx, Size,
+               &src_pool, &pCtx->pSrcPoolBuff,
+               &dst_pool, &pCtx->pDstPoolBuff,
+               HostMem != HOSTMEM_LOCKED_USER)) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  if (posix_memalign(&pCtx->pUserBuff, getpagesize(), Size)) {
+    RVSHSATRACE_
+    pCtx->pUserBuff = nullptr;
+    HostXferRelease(pCtx);
+    return -1;
+  }
+  // make sure pages are actually mapped before the measurement
+  memset(pCtx->pUserBuff, 0, Size);
+
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_signal_create(1, 0, NULL, &pCtx->Sig))) {
+    print_hsa_status(__FILE__, __LINE__, __func__,
+              "hsa_signal_create()",
+              status);
+    pCtx->Sig.handle = 0;
+    HostXferRelease(pCtx);
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Prepare host side of the transfer and initiate DMA
+ *
+ * @param pCtx transfer context
+ * @param Size size of data to transfer
+ * @param HostMem type of memory used on the host side of the transfer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::HostXferStart(hostxfer_t* pCtx, size_t Size,
+                            hostmem_t HostMem) {
+  hsa_status_t status;
+  void* src_ptr = pCtx->pSrcPoolBuff;
+  void* dst_ptr = pCtx->pDstPoolBuff;
+
+  if (HostMem == HOSTMEM_LOCKED_USER) {
+    RVSHSATRACE_
+    // lock user buffer for the device agent
+    hsa_agent_t dev_agent = pCtx->bHostIsSrc ?
+                            agent_list[pCtx->DstIx].agent :
+                            agent_list[pCtx->SrcIx].agent;
+    if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_lock(
+        pCtx->pUserBuff, Size, &dev_agent, 1, &pCtx->pLockedBuff))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_amd_memory_lock()",
+                status);
+      pCtx->pLockedBuff = nullptr;
+      return -1;
+    }
+    if (pCtx->bHostIsSrc) {
+      src_ptr = pCtx->pLockedBuff;
+    } else {
+      dst_ptr = pCtx->pLockedBuff;
+    }
+  } else if (pCtx->bHostIsSrc) {
+    RVSHSATRACE_
+    // stage pageable data into pinned buffer
+    memcpy(pCtx->pSrcPoolBuff, pCtx->pUserBuff, Size);
+  }
+
+  hsa_signal_store_relaxed(pCtx->Sig, 1);
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_amd_memory_async_copy(
+                dst_ptr, agent_list[pCtx->DstIx].agent,
+                src_ptr, agent_list[pCtx->SrcIx].agent,
+                Size,
+                0, NULL, pCtx->Sig))) {
+    print_hsa_status(__FILE__, __LINE__, __func__,
+              "hsa_amd_memory_async_copy()",
+              status);
+    return -1;
+  }
+
   return 0;
 }
 
+/**
+ * @brief Complete host side of the transfer after DMA has finished
+ *
+ * @param pCtx transfer context
+ * @param Size size of data to transfer
+ * @param HostMem type of memory used on the host side of the transfer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::HostXferFinish(hostxfer_t* pCtx, size_t Size,
+                             hostmem_t HostMem) {
+  hsa_status_t status;
+
+  if (HostMem == HOSTMEM_LOCKED_USER) {
+    RVSHSATRACE_
+    pCtx->pLockedBuff = nullptr;
+    if (HSA_STATUS_SUCCESS !=
+       (status = hsa_amd_memory_unlock(pCtx->pUserBuff))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_amd_memory_unlock()",
+                status);
+      return -1;
+    }
+  } else if (!pCtx->bHostIsSrc) {
+    RVSHSATRACE_
+    // copy data from pinned buffer into pageable memory
+    memcpy(pCtx->pUserBuff, pCtx->pDstPoolBuff, Size);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Release all resources used by host-device transfer
+ *
+ * @param pCtx transfer context
+ *
+ * */
+void rvs::hsa::HostXferRelease(hostxfer_t* pCtx) {
+  RVSHSATRACE_
+  if (pCtx->pLockedBuff) {
+    hsa_amd_memory_unlock(pCtx->pUserBuff);
+    pCtx->pLockedBuff = nullptr;
+  }
+  if (pCtx->pUserBuff) {
+    free(pCtx->pUserBuff);
+    pCtx->pUserBuff = nullptr;
+  }
+  if (pCtx->pSrcPoolBuff) {
+    hsa_amd_memory_pool_free(pCtx->pSrcPoolBuff);
+    pCtx->pSrcPoolBuff = nullptr;
+  }
+  if (pCtx->pDstPoolBuff) {
+    hsa_amd_memory_pool_free(pCtx->pDstPoolBuff);
+    pCtx->pDstPoolBuff = nullptr;
+  }
+  if (pCtx->Sig.handle) {
+    hsa_signal_destroy(pCtx->Sig);
+    pCtx->Sig.handle = 0;
+  }
+}
+
 
 /**
  * @brief Get peer status between Src and Dst nodes
@@ -40,6 +40,8 @@
 #include "include/rvslognode.h"
 #include "include/rvslognodestring.h"
 #include "include/rvslognodeint.h"
+#include "include/rvslognodedouble.h"
+#include "include/rvs_cancel.h"
 #include "include/rvslognoderec.h"
 
 using std::cerr;
@@ -55,6 +57,8 @@ bool  rvs::logger::bStop(false);
 uint16_t rvs::logger::stop_flags(0u);
 bool rvs::logger::b_quiet(false);
 char rvs::logger::log_file[1024];
+char rvs::logger::ts_file[1024];
+rvs::ts_writer rvs::logger::ts_sink;
 
 const char*  rvs::logger::loglevelname[] = {
   "NONE  ", "RESULT", "ERROR ", "INFO  ", "DEBUG ", "TRACE " };
@@ -83,6 +87,10 @@ void rvs::logger::set_log_file(const std::string& fname) {
     strncpy(log_file, fname.c_str(), sizeof(log_file));
 }
 
+void rvs::logger::set_ts_file(const std::string& fname) {
+    strncpy(ts_file, fname.c_str(), sizeof(ts_file));
+}
+
 /**
  * @brief Set logging level
  *
@@ -458,6 +466,46 @@ void  rvs::logger::AddInt(void* Parent, const char* Key, const int Val) {
   pp->Add(p);
 }
 
+/**
+ * @brief Create and add child node of type double to the given parent node
+ *
+ * Note: this API is used to construct JSON output.
+ *
+ * @param Parent Parent node
+ * @param Key Key as C string
+ * @param Val Value as double
+ *
+ */
+void  rvs::logger::AddDouble(void* Parent, const char* Key, const double Val) {
+  rvs::LogNode* pp = static_cast<rvs::LogNode*>(Parent);
+  rvs::LogNodeDouble* p = new LogNodeDouble(Key, Val, pp);
+  pp->Add(p);
+}
+
+/**
+ * @brief Record a sample in the time-series file
+ *
+ * Samples are dropped if no time-series file was requested ("--tsFile"
+ * command line option) or after logging was stopped.
+ *
+ * @param Module Module from which the sample is originating
+ * @param GpuId GPU ID
+ * @param Metric Metric name (stored as "<module>.<metric>")
+ * @param Ns time of the sample (ns, CLOCK_MONOTONIC)
+ * @param Val Sample value
+ *
+ */
+void  rvs::logger::Sample(const char* Module, const int GpuId,
+                          const char* Metric, const uint64_t Ns,
+                          const double Val) {
+  if (!ts_sink.is_open())
+    return;
+
+  char name[RVS_TS_METRIC_LEN];
+  snprintf(name, sizeof(name), "%s.%s", Module, Metric);
+  ts_sink.append(GpuId, name, Ns, Val);
+}
+
 /**
  * @brief Add child node to parent
  *
@@ -486,6 +534,7 @@ int rvs::logger::init_log_file() {
   isfirstrecord_m = true;
   bStop = false;
   stop_flags = 0;
+  rvs::cancel_token::process()->reset();
 
   std::string row;
   std::string logfile(log_file);
@@ -525,6 +574,23 @@ int rvs::logger::init_log_file() {
   return 0;
 }
 
+/**
+ * @brief Creates the time-series file when "--tsFile" command line option is
+ * given
+ *
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::logger::init_ts_file() {
+  std::string tsfile(ts_file);
+
+  // if no time-series file requested, just return
+  if (tsfile == "")
+    return 0;
+
+  return ts_sink.open(tsfile) ? 0 : -1;
+}
+
 /**
  * @brief Performs proper termination of log file contents
  *
@@ -532,6 +598,9 @@ int rvs::logger::init_log_file() {
  *
  */
 int rvs::logger::terminate() {
+  // write the time-series index (no further samples are recorded)
+  ts_sink.close();
+
   // if no logg to file requested, just return
   std::string logfile(log_file);
   if (logfile == "")
@@ -558,15 +627,20 @@ int rvs::logger::terminate() {
  *
  */
 void rvs::logger::Stop(uint16_t flags) {
-  // lock cout_mutex for the duration of this block
-  std::lock_guard<std::mutex> lk(cout_mutex);
+  {
+    // lock cout_mutex for the duration of this block
+    std::lock_guard<std::mutex> lk(cout_mutex);
 
-  // signal no further logging to either screen or file
-  bStop = true;
-  stop_flags = flags;
+    // signal no further logging to either screen or file
+    bStop = true;
+    stop_flags = flags;
 
-  // properly terminate log file if needed
-  terminate();
+    // properly terminate log file if needed
+    terminate();
+  }
+
+  // wake up the workers waiting on the cancellation token
+  rvs::cancel_token::process()->cancel();
 }
 
 /**
@@ -583,6 +657,18 @@ bool rvs::logger::Stopping(void) {
   return bStop;
 }
 
+/**
+ * @brief Returns the cancellation token of the process
+ *
+ * Modules point their rvs::cancel_token::process() to it so that a stop
+ * request wakes them up.
+ *
+ * @return pointer to rvs::cancel_token
+ */
+void* rvs::logger::CancelToken(void) {
+  return rvs::cancel_token::process();
+}
+
 
 /**
  * @brief Output Error message
@@ -27,6 +27,8 @@
 #include <chrono>
 #include <string>
 
+#include "include/rvs_cancel.h"
+
 
 using std::string;
 
@@ -47,11 +49,18 @@ int   rvs::lp::Initialize(const T_MODULE_INIT* pMi) {
   mi.cbCreateNode      = pMi->cbCreateNode;
   mi.cbAddString       = pMi->cbAddString;
   mi.cbAddInt          = pMi->cbAddInt;
+  mi.cbAddDouble       = pMi->cbAddDouble;
   mi.cbAddNode         = pMi->cbAddNode;
+  mi.cbSample          = pMi->cbSample;
   mi.cbStop            = pMi->cbStop;
   mi.cbStopping        = pMi->cbStopping;
+  mi.cbCancelToken     = pMi->cbCancelToken;
   mi.cbErr             = pMi->cbErr;
 
+  // stop requests reach this module through the launcher token
+  rvs::cancel_token::set_process(
+    static_cast<rvs::cancel_token*>((*mi.cbCancelToken)()));
+
   return 0;
 }
 
@@ -184,6 +193,20 @@ void  rvs::lp::AddInt(void* Parent, const char* Key, const int Val) {
   (*mi.cbAddInt)(Parent, Key, Val);
 }
 
+/**
+ * @brief Create and add child node of type double to the given parent node
+ *
+ * Note: this API is used to construct JSON output.
+ *
+ * @param Parent Parent node
+ * @param Key Key as C string
+ * @param Val Value as double
+ *
+ */
+void  rvs::lp::AddDouble(void* Parent, const char* Key, const double Val) {
+  (*mi.cbAddDouble)(Parent, Key, Val);
+}
+
 /**
  * @brief Add child node to parent
  *
@@ -200,6 +223,45 @@ void  rvs::lp::AddNode(void* Parent, void* Child) {
   (*mi.cbAddNode)(Parent, Child);
 }
 
+/**
+ * @brief Record a sample in the time-series file (if any), taken now
+ *
+ * Note: samples are stored in binary form (no text formatting), see
+ * rvs::ts_writer.
+ *
+ * @param Module Module from which the sample is originating
+ * @param GpuId GPU ID
+ * @param Metric Metric name
+ * @param Val Sample value
+ *
+ */
+void  rvs::lp::Sample(const char* Module, const int GpuId, const char* Metric,
+                      const double Val) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  Sample(Module, GpuId, Metric,
+         static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec, Val);
+}
+
+/**
+ * @brief Record a sample in the time-series file (if any)
+ *
+ * Note: samples are stored in binary form (no text formatting), see
+ * rvs::ts_writer.
+ *
+ * @param Module Module from which the sample is originating
+ * @param GpuId GPU ID
+ * @param Metric Metric name
+ * @param Ns time of the sample (ns, CLOCK_MONOTONIC)
+ * @param Val Sample value
+ *
+ */
+void  rvs::lp::Sample(const char* Module, const int GpuId, const char* Metric,
+                      const uint64_t Ns, const double Val) {
+  (*mi.cbSample)(Module, GpuId, Metric, Ns, Val);
+}
+
 /**
  * @brief Fetches times since system start
  *
@@ -233,11 +295,13 @@ void  rvs::lp::Stop(uint16_t flags) {
 /**
  * @brief Returns stop flag
  *
- * Checks if a module requested RVS processing to stop
+ * Checks if a module requested RVS processing to stop. Reads the launcher
+ * cancellation token directly (no callback, no lock) so that it is cheap
+ * enough to be polled in tight loops.
  *
  */
 bool  rvs::lp::Stopping() {
-  return (*mi.cbStopping)();
+  return rvs::cancel_token::process()->cancelled();
 }
 
 /**